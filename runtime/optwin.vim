@@ -359,6 +359,10 @@ call append("$", "window\tnumber of lines to scroll for CTRL-F and CTRL-B")
 call append("$", " \tset window=" . &window)
 call append("$", "lazyredraw\tdon't redraw while executing macros")
 call <SID>BinOptionG("lz", &lz)
+if has("timers")
+  call append("$", "redrawrate\tmaximum number of redraws per second for callbacks")
+  call append("$", " \tset rdr=" . &rdr)
+endif
 if has("reltime")
   call append("$", "redrawtime\ttimeout for 'hlsearch' and :match highlighting in msec")
   call append("$", " \tset rdt=" . &rdt)
@@ -405,6 +409,10 @@ if has("syntax")
   call append("$", "synmaxcol\tmaximum column to look for syntax items")
   call append("$", "\t(local to buffer)")
   call <SID>OptionL("smc")
+  call append("$", "synidlemem\tKbyte of memory for parsing syntax while idle")
+  call <SID>OptionG("sim", &sim)
+  call append("$", "syncache\tremember syntax items for other buffers")
+  call <SID>BinOptionG("syc", &syc)
 endif
 call append("$", "highlight\twhich highlighting to use for various occasions")
 call <SID>OptionG("hl", &hl)
@@ -1148,6 +1156,10 @@ if has("quickfix")
   call <SID>OptionG("gp", &gp)
   call append("$", "grepformat\tlist of formats for output of 'grepprg'")
   call <SID>OptionG("gfm", &gfm)
+  if exists("&vgj")
+    call append("$", "vimgrepjobs\tnumber of threads that check files for \":vimgrep\"")
+    call <SID>OptionG("vgj", &vgj)
+  endif
   call append("$", "makeencoding\tencoding of the \":make\" and \":grep\" output")
   call append("$", "\t(global or local to buffer)")
   call <SID>OptionG("menc", &menc)
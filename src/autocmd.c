@@ -103,6 +103,7 @@ static struct event_name
     {"BufWritePost",	EVENT_BUFWRITEPOST},
     {"BufWritePre",	EVENT_BUFWRITEPRE},
     {"BufWriteCmd",	EVENT_BUFWRITECMD},
+    {"BufWriteSynced",	EVENT_BUFWRITESYNCED},
     {"CmdlineChanged",	EVENT_CMDLINECHANGED},
     {"CmdlineEnter",	EVENT_CMDLINEENTER},
     {"CmdlineLeave",	EVENT_CMDLINELEAVE},
@@ -693,7 +694,7 @@ find_end_event(
 /*
  * Return TRUE if "event" is included in 'eventignore'.
  */
-    static int
+    int
 event_ignored(event_T event)
 {
     char_u	*p = p_ei;
@@ -2380,6 +2381,28 @@ has_autocmd(event_T event, char_u *sfname, buf_T *buf)
     return retval;
 }
 
+#if defined(FEAT_QUICKFIX) || defined(PROTO)
+/*
+ * Return TRUE if there is an autocommand that is not ignored and is used when
+ * reading file "sfname" into a buffer.  It may change the text, thus the
+ * file contents can't be used directly.
+ */
+    int
+has_read_autocmd(char_u *sfname)
+{
+    static event_T events[] = {EVENT_BUFREADCMD, EVENT_BUFREADPRE,
+							   EVENT_BUFREADPOST};
+    int		    i;
+
+    for (i = 0; i < (int)(sizeof(events) / sizeof(events[0])); ++i)
+	if (first_autopat[(int)events[i]] != NULL
+		&& !event_ignored(events[i])
+		&& has_autocmd(events[i], sfname, NULL))
+	    return TRUE;
+    return FALSE;
+}
+#endif
+
 #if defined(FEAT_CMDL_COMPL) || defined(PROTO)
 /*
  * Function given to ExpandGeneric() to obtain the list of autocommand group
@@ -939,6 +939,9 @@ free_buffer_stuff(
     map_clear_int(buf, MAP_ALL_MODES, TRUE, TRUE);   /* clear local abbrevs */
 #endif
     VIM_CLEAR(buf->b_start_fenc);
+#ifdef USE_INOTIFY
+    buf_unwatch_file(buf);
+#endif
 }
 
 /*
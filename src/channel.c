@@ -2421,8 +2421,61 @@ invoke_one_time_callback(
     vim_free(item);
 }
 
+/*
+ * Get the message up to "nl" from the first buffer "node" of
+ * "channel"/"part", excluding the NL, and remove it from the buffer.
+ * When "nl" is NULL get the whole buffer.
+ * Returns the message in allocated memory, NULL when out of memory.
+ */
+    static char_u *
+channel_get_nl_msg(
+	channel_T   *channel,
+	ch_part_T   part,
+	readq_T	    *node,
+	char_u	    *nl)
+{
+    char_u  *buf = node->rq_buffer;
+    char_u  *msg;
+    char_u  *p;
+
+    // Convert NUL to NL, the internal representation.
+    for (p = buf; (nl == NULL || p < nl) && p < buf + node->rq_buflen; ++p)
+	if (*p == NUL)
+	    *p = NL;
+
+    if (nl == NULL)
+    {
+	// get the whole buffer, drop the NL
+	msg = channel_get(channel, part, NULL);
+    }
+    else if (nl + 1 == buf + node->rq_buflen)
+    {
+	// get the whole buffer
+	msg = channel_get(channel, part, NULL);
+	*nl = NUL;
+    }
+    else
+    {
+	/* Copy the message into allocated memory (excluding the NL)
+	 * and remove it from the buffer (including the NL). */
+	msg = vim_strnsave(buf, (int)(nl - buf));
+	channel_consume(channel, part, (int)(nl - buf) + 1);
+    }
+    return msg;
+}
+
+/*
+ * Append "msg" to "buffer".
+ * When "get_more" is TRUE the complete lines that follow in NL mode are
+ * appended as well, all at once.
+ */
     static void
-append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
+append_to_buffer(
+	buf_T	    *buffer,
+	char_u	    *msg,
+	channel_T   *channel,
+	ch_part_T   part,
+	int	    get_more)
 {
     bufref_T	save_curbuf = {NULL, 0, 0};
     win_T	*save_curwin = NULL;
@@ -2432,6 +2485,12 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
     chanpart_T  *ch_part = &channel->ch_part[part];
     int		save_p_ma = buffer->b_p_ma;
     int		empty = (buffer->b_ml.ml_flags & ML_EMPTY) ? 1 : 0;
+    garray_T	lines;
+    char_u	**line_array;
+    readq_T	*node;
+    char_u	*nl;
+    char_u	*p;
+    int		i;
 
     if (!buffer->b_p_ma && !ch_part->ch_nomodifiable)
     {
@@ -2443,6 +2502,21 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
 	return;
     }
 
+    ga_init2(&lines, (int)sizeof(char_u *), 50);
+    if (ga_grow(&lines, 1) == FAIL)
+	return;
+    ((char_u **)lines.ga_data)[lines.ga_len++] = msg;
+    if (get_more)
+	while ((node = channel_peek(channel, part)) != NULL
+		&& (nl = channel_first_nl(node)) != NULL
+		&& ga_grow(&lines, 1) == OK)
+	{
+	    if ((p = channel_get_nl_msg(channel, part, node, nl)) == NULL)
+		break;
+	    ((char_u **)lines.ga_data)[lines.ga_len++] = p;
+	}
+    line_array = (char_u **)lines.ga_data;
+
     /* If the buffer is also used as input insert above the last
      * line. Don't write these lines. */
     if (save_write_to)
@@ -2452,7 +2526,11 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
     }
 
     /* Append to the buffer */
-    ch_log(channel, "appending line %d to buffer", (int)lnum + 1 - empty);
+    if (lines.ga_len == 1)
+	ch_log(channel, "appending line %d to buffer", (int)lnum + 1 - empty);
+    else
+	ch_log(channel, "appending lines %d to %d to buffer",
+		       (int)lnum + 1 - empty, (int)lnum - empty + lines.ga_len);
 
     buffer->b_p_ma = TRUE;
 
@@ -2467,11 +2545,14 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
     {
 	/* The buffer is empty, replace the first (dummy) line. */
 	ml_replace(lnum, msg, TRUE);
+	if (lines.ga_len > 1)
+	    ml_append_lines(lnum, line_array + 1, NULL,
+					    (long)(lines.ga_len - 1), FALSE);
 	lnum = 0;
     }
     else
-	ml_append(lnum, msg, 0, FALSE);
-    appended_lines_mark(lnum, 1L);
+	ml_append_lines(lnum, line_array, NULL, (long)lines.ga_len, FALSE);
+    appended_lines_mark(lnum, (long)lines.ga_len);
 
     /* Restore curbuf/curwin/curtab */
     restore_win_for_buf(save_curwin, save_curtab, &save_curbuf);
@@ -2493,7 +2574,7 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
 			: (wp->w_cursor.lnum == lnum
 			    && wp->w_cursor.col == 0)))
 	    {
-		++wp->w_cursor.lnum;
+		wp->w_cursor.lnum += lines.ga_len;
 		save_curwin = curwin;
 		curwin = wp;
 		curbuf = curwin->w_buffer;
@@ -2521,6 +2602,11 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
 		in_part->ch_buf_bot = buffer->b_ml.ml_line_count;
 	}
     }
+
+    /* "msg" is freed by the caller */
+    for (i = 1; i < lines.ga_len; ++i)
+	vim_free(line_array[i]);
+    ga_clear(&lines);
 }
 
     static void
@@ -2554,7 +2640,6 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
     char_u	*callback = NULL;
     partial_T	*partial = NULL;
     buf_T	*buffer = NULL;
-    char_u	*p;
 
     if (channel->ch_nb_close_cb != NULL)
 	/* this channel is handled elsewhere (netbeans) */
@@ -2648,7 +2733,6 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 	if (ch_mode == MODE_NL)
 	{
 	    char_u  *nl = NULL;
-	    char_u  *buf;
 	    readq_T *node;
 
 	    /* See if we have a message ending in NL in the first buffer.  If
@@ -2666,32 +2750,7 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 		    return FALSE; /* incomplete message */
 		}
 	    }
-	    buf = node->rq_buffer;
-
-	    // Convert NUL to NL, the internal representation.
-	    for (p = buf; (nl == NULL || p < nl)
-					    && p < buf + node->rq_buflen; ++p)
-		if (*p == NUL)
-		    *p = NL;
-
-	    if (nl == NULL)
-	    {
-		// get the whole buffer, drop the NL
-		msg = channel_get(channel, part, NULL);
-	    }
-	    else if (nl + 1 == buf + node->rq_buflen)
-	    {
-		// get the whole buffer
-		msg = channel_get(channel, part, NULL);
-		*nl = NUL;
-	    }
-	    else
-	    {
-		/* Copy the message into allocated memory (excluding the NL)
-		 * and remove it from the buffer (including the NL). */
-		msg = vim_strnsave(buf, (int)(nl - buf));
-		channel_consume(channel, part, (int)(nl - buf) + 1);
-	    }
+	    msg = channel_get_nl_msg(channel, part, node, nl);
 	}
 	else
 	{
@@ -2747,7 +2806,10 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 		    write_to_term(buffer, msg, channel);
 		else
 #endif
-		    append_to_buffer(buffer, msg, channel, part);
+		    // Without a callback the following lines don't need to
+		    // be handled one by one.
+		    append_to_buffer(buffer, msg, channel, part,
+					ch_mode == MODE_NL && callback == NULL);
 	    }
 	}
 
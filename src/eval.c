@@ -6911,6 +6911,9 @@ set_cmdarg(exarg_T *eap, char_u *oldarg)
     if (eap->read_edit)
 	len += 7;
 
+    if (eap->write_async)
+	len += 8;
+
     if (eap->force_ff != 0)
 	len += 10; /* " ++ff=unix" */
     if (eap->force_enc != 0)
@@ -6932,6 +6935,9 @@ set_cmdarg(exarg_T *eap, char_u *oldarg)
     if (eap->read_edit)
 	STRCAT(newval, " ++edit");
 
+    if (eap->write_async)
+	STRCAT(newval, " ++async");
+
     if (eap->force_ff != 0)
 	sprintf((char *)newval + STRLEN(newval), " ++ff=%s",
 						eap->force_ff == 'u' ? "unix"
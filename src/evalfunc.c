@@ -319,6 +319,7 @@ static void f_range(typval_T *argvars, typval_T *rettv);
 static void f_readfile(typval_T *argvars, typval_T *rettv);
 static void f_reg_executing(typval_T *argvars, typval_T *rettv);
 static void f_reg_recording(typval_T *argvars, typval_T *rettv);
+static void f_regexpcacheinfo(typval_T *argvars, typval_T *rettv);
 static void f_reltime(typval_T *argvars, typval_T *rettv);
 #ifdef FEAT_FLOAT
 static void f_reltimefloat(typval_T *argvars, typval_T *rettv);
@@ -332,6 +333,7 @@ static void f_remote_send(typval_T *argvars, typval_T *rettv);
 static void f_remote_startserver(typval_T *argvars, typval_T *rettv);
 static void f_remove(typval_T *argvars, typval_T *rettv);
 static void f_rename(typval_T *argvars, typval_T *rettv);
+static void f_rendertime_info(typval_T *argvars, typval_T *rettv);
 static void f_repeat(typval_T *argvars, typval_T *rettv);
 static void f_resolve(typval_T *argvars, typval_T *rettv);
 static void f_reverse(typval_T *argvars, typval_T *rettv);
@@ -414,6 +416,7 @@ static void f_synID(typval_T *argvars, typval_T *rettv);
 static void f_synIDattr(typval_T *argvars, typval_T *rettv);
 static void f_synIDtrans(typval_T *argvars, typval_T *rettv);
 static void f_synstack(typval_T *argvars, typval_T *rettv);
+static void f_syntime_list(typval_T *argvars, typval_T *rettv);
 static void f_synconcealed(typval_T *argvars, typval_T *rettv);
 static void f_system(typval_T *argvars, typval_T *rettv);
 static void f_systemlist(typval_T *argvars, typval_T *rettv);
@@ -445,6 +448,7 @@ static void f_test_null_string(typval_T *argvars, typval_T *rettv);
 static void f_test_scrollbar(typval_T *argvars, typval_T *rettv);
 #endif
 static void f_test_settime(typval_T *argvars, typval_T *rettv);
+static void f_test_syn_idle_parse(typval_T *argvars, typval_T *rettv);
 #ifdef FEAT_FLOAT
 static void f_tan(typval_T *argvars, typval_T *rettv);
 static void f_tanh(typval_T *argvars, typval_T *rettv);
@@ -809,6 +813,7 @@ static struct fst
     {"readfile",	1, 3, f_readfile},
     {"reg_executing",	0, 0, f_reg_executing},
     {"reg_recording",	0, 0, f_reg_recording},
+    {"regexpcacheinfo",	0, 0, f_regexpcacheinfo},
     {"reltime",		0, 2, f_reltime},
 #ifdef FEAT_FLOAT
     {"reltimefloat",	1, 1, f_reltimefloat},
@@ -822,6 +827,7 @@ static struct fst
     {"remote_startserver", 1, 1, f_remote_startserver},
     {"remove",		2, 3, f_remove},
     {"rename",		2, 2, f_rename},
+    {"rendertime_info",	0, 1, f_rendertime_info},
     {"repeat",		2, 2, f_repeat},
     {"resolve",		1, 1, f_resolve},
     {"reverse",		1, 1, f_reverse},
@@ -906,6 +912,7 @@ static struct fst
     {"synIDtrans",	1, 1, f_synIDtrans},
     {"synconcealed",	2, 2, f_synconcealed},
     {"synstack",	2, 2, f_synstack},
+    {"syntime_list",	0, 0, f_syntime_list},
     {"system",		1, 2, f_system},
     {"systemlist",	1, 2, f_systemlist},
     {"tabpagebuflist",	0, 1, f_tabpagebuflist},
@@ -969,6 +976,7 @@ static struct fst
     {"test_scrollbar",	3, 3, f_test_scrollbar},
 #endif
     {"test_settime",	1, 1, f_test_settime},
+    {"test_syn_idle_parse", 0, 0, f_test_syn_idle_parse},
 #ifdef FEAT_TIMERS
     {"timer_info",	0, 1, f_timer_info},
     {"timer_pause",	2, 2, f_timer_pause},
@@ -4515,6 +4523,31 @@ get_buffer_info(buf_T *buf)
     /* Get a reference to buffer variables */
     dict_add_dict(dict, "variables", buf->b_vars);
 
+    /* Statistics of the memfile cache */
+    if (buf->b_ml.ml_mfp != NULL)
+    {
+	memfile_T   *mfp = buf->b_ml.ml_mfp;
+	dict_T	    *mf_dict = dict_alloc();
+
+	if (mf_dict != NULL)
+	{
+	    dict_add_number(mf_dict, "pages", mfp->mf_used_count);
+	    dict_add_number(mf_dict, "maxpages", mfp->mf_used_count_max);
+	    dict_add_number(mf_dict, "hits", mfp->mf_hits);
+	    dict_add_number(mf_dict, "misses", mfp->mf_misses);
+	    dict_add_number(mf_dict, "evictions", mfp->mf_evictions);
+	    dict_add_number(mf_dict, "compressed_pages", mfp->mf_comp_pages);
+	    dict_add_number(mf_dict, "compressed_bytes", mfp->mf_comp_bytes);
+	    dict_add_number(mf_dict, "decompressions",
+						      mfp->mf_decompressions);
+#if defined(FEAT_RELTIME) && defined(FEAT_FLOAT)
+	    dict_add_number(mf_dict, "decompress_usec", (varnumber_T)
+			     (profile_float(&mfp->mf_decomp_time) * 1000000.0));
+#endif
+	    dict_add_dict(dict, "memfile", mf_dict);
+	}
+    }
+
     /* List of windows displaying this buffer */
     windows = list_alloc();
     if (windows != NULL)
@@ -9311,6 +9344,16 @@ f_reg_recording(typval_T *argvars UNUSED, typval_T *rettv)
     return_register(reg_recording, rettv);
 }
 
+/*
+ * "regexpcacheinfo()" function
+ */
+    static void
+f_regexpcacheinfo(typval_T *argvars UNUSED, typval_T *rettv)
+{
+    if (rettv_dict_alloc(rettv) != FAIL)
+	regcache_info(rettv->vval.v_dict);
+}
+
 #if defined(FEAT_RELTIME)
 /*
  * Convert a List to proftime_T.
@@ -9867,6 +9910,29 @@ f_rename(typval_T *argvars, typval_T *rettv)
 				      tv_get_string_buf(&argvars[1], buf));
 }
 
+/*
+ * "rendertime_info([{winid}])" function
+ */
+    static void
+f_rendertime_info(typval_T *argvars UNUSED, typval_T *rettv)
+{
+#ifdef FEAT_PROFILE
+    win_T	*wp = NULL;
+#endif
+
+    if (rettv_dict_alloc(rettv) == FAIL)
+	return;
+#ifdef FEAT_PROFILE
+    if (argvars[0].v_type != VAR_UNKNOWN)
+    {
+	wp = find_win_by_nr_or_id(&argvars[0]);
+	if (wp == NULL)
+	    return;
+    }
+    rendertime_dict(rettv->vval.v_dict, wp);
+#endif
+}
+
 /*
  * "repeat()" function
  */
@@ -13295,6 +13361,19 @@ f_synstack(typval_T *argvars UNUSED, typval_T *rettv)
 	}
     }
 #endif
+}
+
+/*
+ * "syntime_list()" function
+ */
+    static void
+f_syntime_list(typval_T *argvars UNUSED, typval_T *rettv)
+{
+    if (rettv_list_alloc(rettv) == FAIL)
+	return;
+#ifdef FEAT_PROFILE
+    syntime_list(rettv->vval.v_list);
+#endif
 }
 
     static void
@@ -13965,6 +14044,18 @@ f_test_settime(typval_T *argvars, typval_T *rettv UNUSED)
     time_for_testing = (time_t)tv_get_number(&argvars[0]);
 }
 
+/*
+ * "test_syn_idle_parse()" function
+ */
+    static void
+f_test_syn_idle_parse(typval_T *argvars UNUSED, typval_T *rettv UNUSED)
+{
+#ifdef FEAT_SYN_HL
+    while (syn_idle_parse())
+	;
+#endif
+}
+
 #if defined(FEAT_JOB_CHANNEL) || defined(FEAT_TIMERS) || defined(PROTO)
 /*
  * Get a callback from "arg".  It can be a Funcref or a function name.
@@ -1182,6 +1182,9 @@ EX(CMD_redrawtabline,	"redrawtabline", ex_redrawtabline,
 EX(CMD_registers,	"registers",	ex_display,
 			EXTRA|NOTRLCOM|TRLBAR|CMDWIN,
 			ADDR_LINES),
+EX(CMD_rendertime,	"rendertime",	ex_rendertime,
+			NEEDARG|WORD1|TRLBAR|CMDWIN,
+			ADDR_LINES),
 EX(CMD_resize,		"resize",	ex_resize,
 			RANGE|NOTADR|TRLBAR|WORD1|CMDWIN,
 			ADDR_LINES),
@@ -1789,6 +1792,7 @@ struct exarg
     int		regname;	/* register name (NUL if none) */
     int		force_bin;	/* 0, FORCE_BIN or FORCE_NOBIN */
     int		read_edit;	/* ++edit argument */
+    int		write_async;	/* ++async argument */
     int		force_ff;	/* ++ff= argument (first char of argument) */
     int		force_enc;	/* ++enc= argument (index in cmd[]) */
     int		bad_char;	/* BAD_KEEP, BAD_DROP or replacement byte */
@@ -1055,6 +1055,38 @@ profile_start(proftime_T *tm)
 # endif
 }
 
+/*
+ * Return a time stamp in nanoseconds from a monotonic clock, when available.
+ * Only useful for computing the time between two calls.
+ */
+    varnumber_T
+profile_nsec(void)
+{
+# ifdef MSWIN
+    static LARGE_INTEGER    fr;
+    LARGE_INTEGER	    now;
+
+    if (fr.QuadPart == 0)
+	QueryPerformanceFrequency(&fr);
+    QueryPerformanceCounter(&now);
+    return (varnumber_T)((double)now.QuadPart * 1000000000.0
+							 / (double)fr.QuadPart);
+# else
+#  ifdef CLOCK_MONOTONIC
+    struct timespec	ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+	return (varnumber_T)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#  endif
+    {
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return (varnumber_T)tv.tv_sec * 1000000000 + tv.tv_usec * 1000;
+    }
+# endif
+}
+
 /*
  * Compute the elapsed time from "tm" till now and store in "tm".
  */
@@ -1097,6 +1129,25 @@ profile_sub(proftime_T *tm, proftime_T *tm2)
 # endif
 }
 
+/*
+ * Add the time "tm2" to "tm".
+ */
+    void
+profile_add(proftime_T *tm, proftime_T *tm2)
+{
+# ifdef MSWIN
+    tm->QuadPart += tm2->QuadPart;
+# else
+    tm->tv_usec += tm2->tv_usec;
+    tm->tv_sec += tm2->tv_sec;
+    if (tm->tv_usec >= 1000000)
+    {
+	tm->tv_usec -= 1000000;
+	++tm->tv_sec;
+    }
+# endif
+}
+
 /*
  * Return a string that represents the time in "tm".
  * Uses a static buffer!
@@ -1431,6 +1482,11 @@ check_due_timer(void)
     next_due = term_check_timers(next_due, &now);
 #endif
 
+    /* A redraw after a callback may have been postponed for 'redrawrate'. */
+    this_due = redraw_postponed_callback();
+    if (this_due > 0 && (next_due == -1 || next_due > this_due))
+	next_due = this_due;
+
     return current_id != last_timer_id ? 1 : next_due;
 }
 
@@ -1611,25 +1667,6 @@ profile_divide(proftime_T *tm, int count, proftime_T *tm2)
 static void script_dump_profile(FILE *fd);
 static proftime_T prof_wait_time;
 
-/*
- * Add the time "tm2" to "tm".
- */
-    void
-profile_add(proftime_T *tm, proftime_T *tm2)
-{
-# ifdef MSWIN
-    tm->QuadPart += tm2->QuadPart;
-# else
-    tm->tv_usec += tm2->tv_usec;
-    tm->tv_sec += tm2->tv_sec;
-    if (tm->tv_usec >= 1000000)
-    {
-	tm->tv_usec -= 1000000;
-	++tm->tv_sec;
-    }
-# endif
-}
-
 /*
  * Add the "self" time from the total time and the children's time.
  */
@@ -3249,8 +3286,7 @@ ex_listdo(exarg_T *eap)
     if (save_ei != NULL)
     {
 	au_event_restore(save_ei);
-	apply_autocmds(EVENT_SYNTAX, curbuf->b_p_syn,
-					       curbuf->b_fname, TRUE, curbuf);
+	syn_apply_autocmds(curbuf->b_p_syn, TRUE);
     }
 #endif
 #ifdef FEAT_CLIPBOARD
@@ -4370,6 +4406,9 @@ do_source(
 	smsg(_("Cannot source a directory: \"%s\""), fname);
 	goto theend;
     }
+#ifdef FEAT_SYN_HL
+    syn_cache_sourced(fname_exp);
+#endif
 
     /* Apply SourceCmd autocommands, they should get the file and source it. */
     if (has_autocmd(EVENT_SOURCECMD, fname_exp, NULL)
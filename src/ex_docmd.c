@@ -214,6 +214,9 @@ static void	ex_popup(exarg_T *eap);
 #if !defined(FEAT_SYN_HL) || !defined(FEAT_PROFILE)
 # define ex_syntime		ex_ni
 #endif
+#ifndef FEAT_PROFILE
+# define ex_rendertime		ex_ni
+#endif
 #ifndef FEAT_SPELL
 # define ex_spell		ex_ni
 # define ex_mkspell		ex_ni
@@ -4353,6 +4356,10 @@ set_one_cmd_context(
 	    xp->xp_context = EXPAND_SYNTIME;
 	    xp->xp_pattern = arg;
 	    break;
+	case CMD_rendertime:
+	    xp->xp_context = EXPAND_RENDERTIME;
+	    xp->xp_pattern = arg;
+	    break;
 #endif
 
 	case CMD_argdelete:
@@ -5443,6 +5450,19 @@ getargopt(exarg_T *eap)
 	return OK;
     }
 
+    /* ":write ++async file", only for commands that write the buffer with
+     * do_write() */
+    if (STRNCMP(arg, "async", 5) == 0)
+    {
+	if (eap->cmdidx != CMD_write && eap->cmdidx != CMD_update
+		&& eap->cmdidx != CMD_saveas && eap->cmdidx != CMD_wnext
+		&& eap->cmdidx != CMD_wNext && eap->cmdidx != CMD_wprevious)
+	    return FAIL;
+	eap->write_async = TRUE;
+	eap->arg = skipwhite(arg + 5);
+	return OK;
+    }
+
     if (STRNCMP(arg, "ff", 2) == 0)
     {
 	arg += 2;
@@ -5975,6 +5995,7 @@ static struct
     {EXPAND_OWNSYNTAX, "syntax"},
 #if defined(FEAT_PROFILE)
     {EXPAND_SYNTIME, "syntime"},
+    {EXPAND_RENDERTIME, "rendertime"},
 #endif
     {EXPAND_SETTINGS, "option"},
     {EXPAND_PACKADD, "packadd"},
@@ -5199,6 +5199,7 @@ ExpandFromContext(
 #endif
 #ifdef FEAT_PROFILE
 	    {EXPAND_SYNTIME, get_syntime_arg, TRUE, TRUE},
+	    {EXPAND_RENDERTIME, get_rendertime_arg, TRUE, TRUE},
 #endif
 	    {EXPAND_HIGHLIGHT, get_highlight_name, TRUE, TRUE},
 	    {EXPAND_EVENTS, get_event_name, TRUE, TRUE},
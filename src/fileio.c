@@ -21,6 +21,92 @@
 # include <utime.h>		/* for struct utimbuf */
 #endif
 
+#if defined(HAVE_WRITEV) && defined(HAVE_SYS_UIO_H) && !defined(VMS)
+# include <sys/uio.h>		/* for writev() */
+# define USE_WRITEV
+/* Maximum number of pieces of text passed to one writev() call. */
+# if defined(IOV_MAX) && IOV_MAX < 512
+#  define WRITEV_MAX	IOV_MAX
+# else
+#  define WRITEV_MAX	512
+# endif
+#endif
+
+#ifdef USE_ASYNC_WRITE
+# include <pthread.h>
+
+/*
+ * A file written with ":write ++async".  The file is flushed and closed by a
+ * thread, the main thread finishes up when that is done.
+ */
+typedef struct async_write_S async_write_T;
+struct async_write_S
+{
+    async_write_T   *aw_next;	    /* next in list of pending writes */
+    int		    aw_fd;	    /* file descriptor, closed by the thread */
+    int		    aw_fsync;	    /* TRUE when fsync() is to be done */
+    int		    aw_bufnr;	    /* number of the buffer written */
+    char_u	    *aw_fname;	    /* allocated name of the written file */
+    char_u	    *aw_backup;	    /* backup file to delete or NULL */
+    int		    aw_done;	    /* set by the thread when done */
+    int		    aw_failed;	    /* set by the thread on failure */
+};
+
+static pthread_mutex_t	async_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	async_write_cond = PTHREAD_COND_INITIALIZER;
+static async_write_T	*first_async_write = NULL;
+
+static async_write_T *async_write_new(buf_T *buf, char_u *fname, int do_fsync);
+static void async_write_start(async_write_T *aw, int fd);
+static void *async_write_thread(void *arg);
+static void async_write_backup(async_write_T *aw);
+#endif
+
+#ifdef USE_INOTIFY
+# include <sys/inotify.h>
+# include <sys/statfs.h>
+
+/* Events on a watched directory that may mean a file in it changed. */
+# define WATCH_MASK (IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE \
+	| IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF \
+	| IN_MOVE_SELF | IN_ONLYDIR)
+
+/* Events on a directory above it that may mean the path of a file now leads
+ * somewhere else. */
+# define WATCH_MASK_ABOVE (IN_CREATE | IN_DELETE | IN_MOVED_FROM \
+	| IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+/*
+ * A directory watched with inotify: the directory of a watched file or one
+ * above it.  Several entries have the same watch descriptor when a symbolic
+ * link leads to the same directory.
+ */
+typedef struct
+{
+    int		wd_wd;		/* inotify watch descriptor */
+    char_u	*wd_name;	/* full path of the directory */
+} watchdir_T;
+
+static int	watch_fd = -1;		/* inotify descriptor, -2 if failed */
+static int	watch_events_read = FALSE; /* events already read */
+static garray_T	watch_dirs = {0, 0, sizeof(watchdir_T), 8, NULL};
+
+static void buf_watch_file(buf_T *buf);
+static int watch_dir_add(char_u *dir, int filedir);
+static void watch_dir_release(char_u *fname);
+static int watch_below(char_u *fname, char_u *dir);
+static int watch_local_fs(char_u *dir);
+static void watch_read_events(void);
+static void watch_handle_event(int wd, unsigned mask, char *name);
+#endif
+
+/* SSE2 is always there on x86_64, use it to scan the text read from a file
+ * 16 bytes at a time. */
+#if defined(__SSE2__) && !defined(PROTO)
+# include <emmintrin.h>
+# define USE_SSE2_SCAN
+#endif
+
 #define BUFSIZE		8192	/* size of normal write buffer */
 #define SMBUFSIZE	256	/* size of emergency write buffer */
 
@@ -37,6 +123,8 @@ static void check_marks_read(void);
 #ifdef FEAT_CRYPT
 static char_u *check_for_cryptkey(char_u *cryptkey, char_u *ptr, long *sizep, off_T *filesizep, int newfile, char_u *fname, int *did_ask);
 #endif
+static long readfile_span(char_u *p, long len, int c1, int c2, int c3);
+static long readfile_ascii(char_u *p, long len);
 static int set_rw_fname(char_u *fname, char_u *sfname);
 static int msg_add_fileformat(int eol_type);
 static void msg_add_eol(void);
@@ -100,6 +188,24 @@ struct bw_info
 
 static int  buf_write_bytes(struct bw_info *ip);
 
+#ifdef USE_WRITEV
+/*
+ * Structure used by buf_write_lines() to collect pieces of text that are
+ * written with one writev() call.
+ */
+typedef struct
+{
+    int		    wv_fd;		/* file descriptor */
+    struct iovec    wv_iov[WRITEV_MAX];	/* pieces of text to be written */
+    int		    wv_count;		/* nr of entries used in wv_iov[] */
+    long	    wv_nchars;		/* nr of bytes written */
+} writev_T;
+
+static int buf_write_lines(buf_T *buf, int fd, linenr_T start, linenr_T end, int fileformat, int write_bin, context_sha256_T *sha_ctx, linenr_T *lnump, long *ncharsp, int *no_eolp);
+static int writev_add(writev_T *wvp, char_u *p, size_t len);
+static int writev_flush(writev_T *wvp);
+#endif
+
 static linenr_T readfile_linenr(linenr_T linecnt, char_u *p, char_u *endp);
 static int ucs2bytes(unsigned c, char_u **pp, int flags);
 static int need_conversion(char_u *fenc);
@@ -155,7 +261,7 @@ filemess(
  *
  * 1. We allocate blocks with lalloc, as big as possible.
  * 2. Each block is filled with characters from the file with a single read().
- * 3. The lines are inserted in the buffer with ml_append().
+ * 3. The lines are inserted in the buffer with ml_append_lines().
  *
  * (caller must check that fname != NULL, unless READ_STDIN is used)
  *
@@ -205,6 +311,7 @@ readfile(
     int		wasempty;		/* buffer was empty before reading */
     colnr_T	len;
     long	size = 0;
+    long	n;
     char_u	*p;
     off_T	filesize = 0;
     int		skip_read = FALSE;
@@ -222,6 +329,10 @@ readfile(
     int		error = FALSE;		/* errors encountered */
     int		ff_error = EOL_UNKNOWN; /* file format with errors */
     long	linerest = 0;		/* remaining chars in line */
+#define APPEND_LINES 200		/* number of lines appended at once */
+    char_u	*append_lines[APPEND_LINES];  /* lines not appended yet */
+    colnr_T	append_lens[APPEND_LINES];
+    int		append_count = 0;
 #ifdef UNIX
     int		perm = 0;
     int		swap_mode = -1;		/* protection bits for swap file */
@@ -931,8 +1042,9 @@ retry:
 	    goto failed;
 	}
 	/* Delete the previously read lines. */
-	while (lnum > from)
-	    ml_delete(lnum--, FALSE);
+	if (lnum > from)
+	    ml_delete_range(from + 1, (long)(lnum - from), FALSE);
+	lnum = from;
 	file_rewind = FALSE;
 	if (set_options)
 	{
@@ -1999,7 +2111,10 @@ retry:
 
 		    if (todo <= 0)
 			break;
-		    if (*p >= 0x80)
+		    if (*p < 0x80)
+			/* skip over ASCII quickly */
+			p += readfile_ascii(p, (long)todo) - 1;
+		    else
 		    {
 			/* A length of 1 means it's an illegal byte.  Accept
 			 * an incomplete character at the end though, the next
@@ -2090,6 +2205,10 @@ rewind_retry:
 
 		    for (p = ptr; p < ptr + size; ++p)
 		    {
+			p += readfile_span(p, (long)((ptr + size) - p),
+								CAR, NL, NL);
+			if (p == ptr + size)
+			    break;
 			if (*p == NL)
 			{
 			    if (!try_unix
@@ -2115,6 +2234,10 @@ rewind_retry:
 			{
 			    for (p = ptr; p < ptr + size; ++p)
 			    {
+				p += readfile_span(p, (long)((ptr + size) - p),
+								CAR, NL, NL);
+				if (p == ptr + size)
+				    break;
 				if (*p == NL)
 				    try_unix++;
 				else if (*p == CAR)
@@ -2153,9 +2276,14 @@ rewind_retry:
 	    --ptr;
 	    while (++ptr, --size >= 0)
 	    {
-		/* catch most common case first */
+		/* catch most common case first, skip a run of them */
 		if ((c = *ptr) != NUL && c != CAR && c != NL)
+		{
+		    n = readfile_span(ptr, size + 1, NUL, CAR, NL) - 1;
+		    ptr += n;
+		    size -= n;
 		    continue;
+		}
 		if (c == NUL)
 		    *ptr = NL;	/* NULs are replaced by newlines! */
 		else if (c == NL)
@@ -2166,11 +2294,19 @@ rewind_retry:
 		    {
 			*ptr = NUL;	    /* end of line */
 			len = (colnr_T) (ptr - line_start + 1);
-			if (ml_append(lnum, line_start, len, newfile) == FAIL)
+			if (append_count == APPEND_LINES)
 			{
-			    error = TRUE;
-			    break;
+			    append_count = 0;
+			    if (ml_append_lines(lnum - APPEND_LINES,
+					    append_lines, append_lens,
+					    (long)APPEND_LINES, newfile) == FAIL)
+			    {
+				error = TRUE;
+				break;
+			    }
 			}
+			append_lines[append_count] = line_start;
+			append_lens[append_count++] = len;
 #ifdef FEAT_PERSISTENT_UNDO
 			if (read_undo_file)
 			    sha256_update(&sha_ctx, line_start, len);
@@ -2194,8 +2330,14 @@ rewind_retry:
 	    --ptr;
 	    while (++ptr, --size >= 0)
 	    {
-		if ((c = *ptr) != NUL && c != NL)  /* catch most common case */
+		/* catch most common case, skip a run of them */
+		if ((c = *ptr) != NUL && c != NL)
+		{
+		    n = readfile_span(ptr, size + 1, NUL, NL, NL) - 1;
+		    ptr += n;
+		    size -= n;
 		    continue;
+		}
 		if (c == NUL)
 		    *ptr = NL;	/* NULs are replaced by newlines! */
 		else
@@ -2231,16 +2373,27 @@ rewind_retry:
 					set_fileformat(EOL_UNIX, OPT_LOCAL);
 				    file_rewind = TRUE;
 				    keep_fileformat = TRUE;
+				    /* lines not appended yet are dropped */
+				    lnum -= append_count;
+				    append_count = 0;
 				    goto retry;
 				}
 				ff_error = EOL_DOS;
 			    }
 			}
-			if (ml_append(lnum, line_start, len, newfile) == FAIL)
+			if (append_count == APPEND_LINES)
 			{
-			    error = TRUE;
-			    break;
+			    append_count = 0;
+			    if (ml_append_lines(lnum - APPEND_LINES,
+					    append_lines, append_lens,
+					    (long)APPEND_LINES, newfile) == FAIL)
+			    {
+				error = TRUE;
+				break;
+			    }
 			}
+			append_lines[append_count] = line_start;
+			append_lens[append_count++] = len;
 #ifdef FEAT_PERSISTENT_UNDO
 			if (read_undo_file)
 			    sha256_update(&sha_ctx, line_start, len);
@@ -2259,6 +2412,15 @@ rewind_retry:
 		}
 	    }
 	}
+
+	/* Append the remaining lines before the buffer is used again. */
+	if (append_count > 0)
+	{
+	    if (ml_append_lines(lnum - append_count, append_lines, append_lens,
+					 (long)append_count, newfile) == FAIL)
+		error = TRUE;
+	    append_count = 0;
+	}
 	linerest = (long)(ptr - line_start);
 	ui_breakcheck();
     }
@@ -2675,6 +2837,73 @@ is_dev_fd_file(char_u *fname)
 }
 #endif
 
+/*
+ * Return the number of bytes at the start of "p[len]" that are not "c1",
+ * "c2" or "c3".
+ */
+    static long
+readfile_span(char_u *p, long len, int c1, int c2, int c3)
+{
+    long	n = 0;
+#ifdef USE_SSE2_SCAN
+    __m128i	v1 = _mm_set1_epi8((char)c1);
+    __m128i	v2 = _mm_set1_epi8((char)c2);
+    __m128i	v3 = _mm_set1_epi8((char)c3);
+    __m128i	v;
+    int		mask;
+
+    for ( ; n + 16 <= len; n += 16)
+    {
+	v = _mm_loadu_si128((__m128i *)(p + n));
+	mask = _mm_movemask_epi8(_mm_or_si128(
+		    _mm_or_si128(_mm_cmpeq_epi8(v, v1), _mm_cmpeq_epi8(v, v2)),
+		    _mm_cmpeq_epi8(v, v3)));
+	if (mask != 0)
+	{
+	    while ((mask & 1) == 0)
+	    {
+		mask >>= 1;
+		++n;
+	    }
+	    return n;
+	}
+    }
+#endif
+    while (n < len && p[n] != c1 && p[n] != c2 && p[n] != c3)
+	++n;
+    return n;
+}
+
+/*
+ * Return the number of ASCII bytes at the start of "p[len]".
+ */
+    static long
+readfile_ascii(char_u *p, long len)
+{
+    long	n = 0;
+#ifdef USE_SSE2_SCAN
+    int		mask;
+
+    for ( ; n + 16 <= len; n += 16)
+    {
+	/* the top bit of each byte ends up in "mask" */
+	mask = _mm_movemask_epi8(_mm_loadu_si128((__m128i *)(p + n)));
+	if (mask != 0)
+	{
+	    while ((mask & 1) == 0)
+	    {
+		mask >>= 1;
+		++n;
+	    }
+	    return n;
+	}
+    }
+#endif
+    while (n < len && p[n] < 0x80)
+	++n;
+    return n;
+}
+
 /*
  * From the current line count and characters read after that, estimate the
  * line number where we are now.
@@ -2715,6 +2944,7 @@ prep_exarg(exarg_T *eap, buf_T *buf)
 
     eap->force_bin = buf->b_p_bin ? FORCE_BIN : FORCE_NOBIN;
     eap->read_edit = FALSE;
+    eap->write_async = FALSE;
     eap->forceit = FALSE;
     return OK;
 }
@@ -3107,6 +3337,10 @@ buf_write(
 #ifdef FEAT_PERSISTENT_UNDO
     int		    write_undo_file = FALSE;
     context_sha256_T sha_ctx;
+#endif
+#ifdef USE_ASYNC_WRITE
+    int		    write_async = (eap != NULL && eap->write_async);
+    async_write_T   *aw = NULL;
 #endif
     unsigned int    bkc = get_bkc_value(buf);
 
@@ -3453,6 +3687,12 @@ buf_write(
     else
 	bufsize = BUFSIZE;
 
+#ifdef USE_ASYNC_WRITE
+    /* A previous ":write ++async" of this file must be finished before
+     * making a backup. */
+    async_write_wait(ffname);
+#endif
+
     /*
      * Get information about original file (if there is one).
      */
@@ -4509,6 +4749,26 @@ restore_backup:
 	fileformat = get_fileformat_force(buf, eap);
 	s = buffer;
 	len = 0;
+#ifdef USE_WRITEV
+	/* Without conversion and encryption the text can be written directly
+	 * from the memline blocks. */
+	if (fd >= 0 && wb_flags == 0
+# ifdef USE_ICONV
+		&& write_info.bw_iconv_fd == (iconv_t)-1
+# endif
+		)
+	{
+	    if (buf_write_lines(buf, fd, start, end, fileformat, write_bin,
+# ifdef FEAT_PERSISTENT_UNDO
+			write_undo_file ? &sha_ctx : NULL,
+# else
+			NULL,
+# endif
+			&lnum, &nchars, &no_eol) == FAIL)
+		end = 0;
+	}
+	else
+#endif
 	for (lnum = start; lnum <= end; ++lnum)
 	{
 	    /*
@@ -4661,6 +4921,16 @@ restore_backup:
 	 * work (could be a pipe).
 	 * If the 'fsync' option is FALSE, don't fsync().  Useful for laptops.
 	 */
+# ifdef USE_ASYNC_WRITE
+	/* With ":write ++async" a thread does the fsync() and close(). */
+	if (write_async && end != 0
+#  ifdef FEAT_EVAL
+		&& wfname == fname
+#  endif
+		)
+	    aw = async_write_new(buf, ffname, p_fs && !device);
+	if (aw == NULL)
+# endif
 	if (p_fs && vim_fsync(fd) != 0 && !device)
 	{
 	    errmsg = (char_u *)_(e_fsync);
@@ -4710,6 +4980,11 @@ restore_backup:
 	/* set permission of new file same as old file */
 	if (perm >= 0)
 	    (void)mch_fsetperm(fd, perm);
+#endif
+#ifdef USE_ASYNC_WRITE
+	if (aw != NULL)
+	    async_write_start(aw, fd);
+	else
 #endif
 	if (close(fd) != 0)
 	{
@@ -4988,8 +5263,16 @@ restore_backup:
     }
 
     /*
-     * Remove the backup unless 'backup' option is set
+     * Remove the backup unless 'backup' option is set.  With ":write ++async"
+     * this is done when the file has been flushed.
      */
+#ifdef USE_ASYNC_WRITE
+    if (!p_bk && backup != NULL && aw != NULL)
+    {
+	aw->aw_backup = backup;
+	backup = NULL;
+    }
+#endif
     if (!p_bk && backup != NULL && mch_remove(backup) != 0)
 	emsg(_("E207: Can't delete backup file"));
 
@@ -5305,6 +5588,373 @@ time_differs(long t1, long t2)
 #endif
 }
 
+#ifdef USE_WRITEV
+/*
+ * Write lines "start" to "end" of buffer "buf" to file descriptor "fd" with
+ * writev(), pointing into the memline data blocks instead of copying the text
+ * into a write buffer.  Only to be used when no conversion or encryption is
+ * to be done.
+ * A NL in the text is written as a NUL, for "fileformat" EOL_MAC a CR is
+ * written as a NL, like buf_write() does.
+ * "sha_ctx" is updated with the text when not NULL.
+ * "*lnump" is set to the line after the last one written, "*ncharsp" is
+ * incremented with the number of bytes written and "*no_eolp" is set when the
+ * last line was written without an end-of-line.
+ * Return FAIL for a write error or when interrupted, OK otherwise.
+ */
+    static int
+buf_write_lines(
+    buf_T		*buf,
+    int			fd,
+    linenr_T		start,
+    linenr_T		end,
+    int			fileformat,
+    int			write_bin,
+    context_sha256_T	*sha_ctx,
+    linenr_T		*lnump,
+    long		*ncharsp,
+    int			*no_eolp)
+{
+    static char_u	nul[] = {NUL};
+    static char_u	nl[] = "\n";
+    writev_T		wv;
+    memline_T		*ml = &buf->b_ml;
+    linenr_T		lnum;
+    char_u		*ptr;
+    char_u		*p;
+    char_u		*cr;
+    char_u		*eol;
+    size_t		eol_len;
+    size_t		len;
+    int			retval = OK;
+
+    wv.wv_fd = fd;
+    wv.wv_count = 0;
+    wv.wv_nchars = 0;
+
+    if (fileformat == EOL_UNIX)
+	eol = (char_u *)"\n";
+    else if (fileformat == EOL_MAC)
+	eol = (char_u *)"\r";
+    else
+	eol = (char_u *)"\r\n";
+    eol_len = STRLEN(eol);
+
+    for (lnum = start; lnum <= end; ++lnum)
+    {
+	/* The collected text must be written before another block is used or
+	 * a changed line is flushed, that moves or frees the text. */
+	if (wv.wv_count > 0 && (ml->ml_locked == NULL
+				|| (ml->ml_flags & ML_LINE_DIRTY)
+				|| lnum < ml->ml_locked_low
+				|| lnum > ml->ml_locked_high)
+		&& writev_flush(&wv) == FAIL)
+	{
+	    retval = FAIL;
+	    break;
+	}
+
+	ptr = ml_get_buf(buf, lnum, FALSE);
+	len = STRLEN(ptr);
+#ifdef FEAT_PERSISTENT_UNDO
+	if (sha_ctx != NULL)
+	    sha256_update(sha_ctx, ptr, (UINT32_T)(len + 1));
+#endif
+	/* Write the text in pieces separated by a NL, which stands for a NUL,
+	 * and for the Mac format a CR, which is written as a NL. */
+	while (len > 0)
+	{
+	    p = memchr(ptr, NL, len);
+	    if (fileformat == EOL_MAC)
+	    {
+		cr = memchr(ptr, CAR, p == NULL ? len : (size_t)(p - ptr));
+		if (cr != NULL)
+		    p = cr;
+	    }
+	    if (p == NULL)
+	    {
+		retval = writev_add(&wv, ptr, len);
+		break;
+	    }
+	    if ((p > ptr && writev_add(&wv, ptr, (size_t)(p - ptr)) == FAIL)
+		    || writev_add(&wv, *p == NL ? nul : nl, 1) == FAIL)
+	    {
+		retval = FAIL;
+		break;
+	    }
+	    len -= p + 1 - ptr;
+	    ptr = p + 1;
+	}
+	if (retval == FAIL)
+	    break;
+
+	/* last line has no EOL: stop here */
+	if (lnum == end
+		&& (write_bin || !buf->b_p_fixeol)
+		&& (lnum == buf->b_no_eol_lnum
+		    || (lnum == buf->b_ml.ml_line_count && !buf->b_p_eol)))
+	{
+	    *no_eolp = TRUE;
+	    ++lnum;
+	    break;
+	}
+	if (writev_add(&wv, eol, eol_len) == FAIL)
+	{
+	    retval = FAIL;
+	    break;
+	}
+    }
+    if (retval == OK)
+	retval = writev_flush(&wv);
+
+    *lnump = lnum;
+    *ncharsp += wv.wv_nchars;
+    return retval;
+}
+
+/*
+ * Add "len" bytes at "p" to the text to be written for "wvp".  Writes the
+ * collected text when there is no room for more.
+ * Return FAIL for a write error or when interrupted, OK otherwise.
+ */
+    static int
+writev_add(writev_T *wvp, char_u *p, size_t len)
+{
+    if (wvp->wv_count == WRITEV_MAX && writev_flush(wvp) == FAIL)
+	return FAIL;
+    wvp->wv_iov[wvp->wv_count].iov_base = (void *)p;
+    wvp->wv_iov[wvp->wv_count].iov_len = len;
+    ++wvp->wv_count;
+    return OK;
+}
+
+/*
+ * Write the text collected for "wvp" with writev().
+ * Return FAIL for a write error or when interrupted, OK otherwise.
+ */
+    static int
+writev_flush(writev_T *wvp)
+{
+    struct iovec    *iov = wvp->wv_iov;
+    int		    count = wvp->wv_count;
+    ssize_t	    n;
+
+    while (count > 0)
+    {
+	n = writev(wvp->wv_fd, iov, count);
+	if (n < 0)
+	{
+	    if (errno == EINTR)
+		continue;
+	    return FAIL;
+	}
+	wvp->wv_nchars += n;
+
+	/* Only part of the text may have been written, skip over it. */
+	while (count > 0 && (size_t)n >= iov->iov_len)
+	{
+	    n -= iov->iov_len;
+	    ++iov;
+	    --count;
+	}
+	if (count > 0)
+	{
+	    iov->iov_base = (char *)iov->iov_base + n;
+	    iov->iov_len -= n;
+	}
+    }
+    wvp->wv_count = 0;
+
+    ui_breakcheck();
+    return got_int ? FAIL : OK;
+}
+#endif
+
+#if defined(USE_ASYNC_WRITE) || defined(PROTO)
+/*
+ * Allocate an async_write_T for writing "fname" from "buf".  When "do_fsync"
+ * is TRUE the file is flushed before closing it.
+ * Returns NULL when out of memory, the file must be written as usual then.
+ */
+    static async_write_T *
+async_write_new(buf_T *buf, char_u *fname, int do_fsync)
+{
+    async_write_T   *aw;
+
+    aw = (async_write_T *)alloc_clear((unsigned)sizeof(async_write_T));
+    if (aw == NULL)
+	return NULL;
+    aw->aw_fname = vim_strsave(fname);
+    if (aw->aw_fname == NULL)
+    {
+	vim_free(aw);
+	return NULL;
+    }
+    aw->aw_fd = -1;
+    aw->aw_fsync = do_fsync;
+    aw->aw_bufnr = buf->b_fnum;
+    return aw;
+}
+
+/*
+ * Start flushing and closing file descriptor "fd" for "aw" in a thread.
+ * When a thread cannot be started this is done right away.
+ * async_write_check() finishes up once it is done.
+ */
+    static void
+async_write_start(async_write_T *aw, int fd)
+{
+    pthread_t	thread;
+    sigset_t	set;
+    sigset_t	oldset;
+    int		started;
+
+    aw->aw_fd = fd;
+    aw->aw_next = first_async_write;
+    first_async_write = aw;
+
+    /* Signals must be handled by the main thread, block all of them in the
+     * new thread. */
+    sigfillset(&set);
+    pthread_sigmask(SIG_SETMASK, &set, &oldset);
+    started = pthread_create(&thread, NULL, async_write_thread, aw) == 0;
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+    if (started)
+	pthread_detach(thread);
+    else
+	(void)async_write_thread(aw);
+}
+
+/*
+ * The thread started by async_write_start().  Only sets "aw_done" and
+ * "aw_failed", the main thread owns the other fields.
+ */
+    static void *
+async_write_thread(void *arg)
+{
+    async_write_T   *aw = (async_write_T *)arg;
+    int		    failed = FALSE;
+
+    if (aw->aw_fsync && vim_fsync(aw->aw_fd) != 0)
+	failed = TRUE;
+    if (close(aw->aw_fd) != 0)
+	failed = TRUE;
+
+    pthread_mutex_lock(&async_write_mutex);
+    aw->aw_failed = failed;
+    aw->aw_done = TRUE;
+    pthread_cond_broadcast(&async_write_cond);
+    pthread_mutex_unlock(&async_write_mutex);
+    return NULL;
+}
+
+/*
+ * Delete the backup file of finished write "aw", unless writing failed.
+ */
+    static void
+async_write_backup(async_write_T *aw)
+{
+    if (aw->aw_backup == NULL)
+	return;
+    if (!aw->aw_failed && mch_remove(aw->aw_backup) != 0)
+	emsg(_("E207: Can't delete backup file"));
+    VIM_CLEAR(aw->aw_backup);
+}
+
+/*
+ * Wait for ":write ++async" of file "fname" to be finished.  When "fname" is
+ * NULL wait for all files.
+ * Deletes the backup file, autocommands are triggered later by
+ * async_write_check().
+ */
+    void
+async_write_wait(char_u *fname)
+{
+    async_write_T   *aw;
+
+    if (first_async_write == NULL)
+	return;
+    pthread_mutex_lock(&async_write_mutex);
+    for (aw = first_async_write; aw != NULL; )
+    {
+	if (!aw->aw_done
+		&& (fname == NULL || fnamecmp(fname, aw->aw_fname) == 0))
+	{
+	    pthread_cond_wait(&async_write_cond, &async_write_mutex);
+	    aw = first_async_write;	/* start over */
+	}
+	else
+	    aw = aw->aw_next;
+    }
+    pthread_mutex_unlock(&async_write_mutex);
+
+    for (aw = first_async_write; aw != NULL; aw = aw->aw_next)
+	if (fname == NULL || fnamecmp(fname, aw->aw_fname) == 0)
+	    async_write_backup(aw);
+}
+
+/*
+ * Return TRUE when a ":write ++async" is in progress, async_write_check()
+ * should be called once in a while.
+ */
+    int
+async_write_pending(void)
+{
+    return first_async_write != NULL;
+}
+
+/*
+ * Finish up files written with ":write ++async" that have been flushed.
+ * Deletes the backup file and triggers the BufWriteSynced autocommands.
+ * When flushing failed give an error message and set 'modified'.
+ */
+    void
+async_write_check(void)
+{
+    async_write_T   **awp;
+    async_write_T   *aw;
+    buf_T	    *buf;
+
+    while (first_async_write != NULL)
+    {
+	pthread_mutex_lock(&async_write_mutex);
+	for (awp = &first_async_write; *awp != NULL; awp = &(*awp)->aw_next)
+	    if ((*awp)->aw_done)
+		break;
+	aw = *awp;
+	if (aw != NULL)
+	    *awp = aw->aw_next;
+	pthread_mutex_unlock(&async_write_mutex);
+	if (aw == NULL)
+	    break;
+
+	async_write_backup(aw);
+	buf = buflist_findnr(aw->aw_bufnr);
+	if (aw->aw_failed)
+	{
+	    semsg(_("E667: Fsync failed: %s"), aw->aw_fname);
+	    if (buf != NULL && buf->b_ml.ml_mfp != NULL)
+	    {
+		/* The text may not have been written, make sure it's not lost
+		 * when quitting. */
+		buf->b_changed = TRUE;
+		ml_setflags(buf);
+		check_status(buf);
+		redraw_tabline = TRUE;
+#ifdef FEAT_TITLE
+		need_maketitle = TRUE;
+#endif
+	    }
+	}
+	else if (buf != NULL)
+	    apply_autocmds(EVENT_BUFWRITESYNCED, aw->aw_fname, aw->aw_fname,
+								   FALSE, buf);
+	vim_free(aw->aw_fname);
+	vim_free(aw);
+    }
+}
+#endif
+
 /*
  * Call write() to write a number of bytes to the file.
  * Handles encryption and 'encoding' conversion.
@@ -6625,6 +7275,11 @@ check_timestamps(
 	++no_wait_return;
 	did_check_timestamps = TRUE;
 	already_warned = FALSE;
+#ifdef USE_INOTIFY
+	/* Find out which watched files changed only once. */
+	watch_read_events();
+	watch_events_read = TRUE;
+#endif
 	FOR_ALL_BUFFERS(buf)
 	{
 	    /* Only check buffers in a window. */
@@ -6645,6 +7300,9 @@ check_timestamps(
 		}
 	    }
 	}
+#ifdef USE_INOTIFY
+	watch_events_read = FALSE;
+#endif
 	--no_wait_return;
 	need_check_timestamps = FALSE;
 	if (need_wait_return && didit == 2)
@@ -6758,6 +7416,17 @@ buf_check_timestamp(
 	    )
 	return 0;
 
+#ifdef USE_INOTIFY
+    /* When the directory of the file is watched the file only needs to be
+     * checked after a change was reported. */
+    if (!watch_events_read)
+	watch_read_events();
+    if (buf->b_watch_wd > 0 && !buf->b_watch_changed
+			    && STRCMP(buf->b_watch_fname, buf->b_ffname) == 0)
+	return 0;
+    buf->b_watch_changed = FALSE;
+#endif
+
     if (       !(buf->b_flags & BF_NOTEDITED)
 	    && buf->b_mtime != 0
 	    && ((stat_res = mch_stat((char *)buf->b_ffname, &st)) < 0
@@ -7159,8 +7828,332 @@ buf_store_time(buf_T *buf, stat_T *st, char_u *fname UNUSED)
 #else
     buf->b_orig_mode = mch_getperm(fname);
 #endif
+#ifdef USE_INOTIFY
+    buf_watch_file(buf);
+#endif
 }
 
+#if defined(USE_INOTIFY) || defined(PROTO)
+/*
+ * Watch the directory of the file of "buf" with inotify, so that
+ * buf_check_timestamp() doesn't need to check the file until a change is
+ * reported.  The directories above it are watched for being renamed or
+ * deleted.  Called when the timestamp of "buf" was stored.
+ */
+    static void
+buf_watch_file(buf_T *buf)
+{
+    char_u	*fname;
+    char_u	*p;
+    char_u	*end;
+    int		c;
+    int		filedir;
+    stat_T	st;
+    int		w;
+    int		wd = -1;
+
+    if (buf->b_ffname == NULL || watch_fd == -2)
+	return;
+    if (buf->b_watch_wd > 0 && STRCMP(buf->b_watch_fname, buf->b_ffname) == 0)
+    {
+	/* Already watched, the stored time is up-to-date now. */
+	buf->b_watch_changed = FALSE;
+	return;
+    }
+    buf_unwatch_file(buf);
+
+    /* A change made through a symbolic link or another hard link is not
+     * reported for this directory. */
+    if (!mch_isFullName(buf->b_ffname)
+	    || mch_lstat((char *)buf->b_ffname, &st) != 0
+	    || S_ISLNK(st.st_mode)
+	    || st.st_nlink > 1)
+	return;
+
+    if (watch_fd == -1)
+    {
+	watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (watch_fd < 0)
+	{
+	    watch_fd = -2;
+	    return;
+	}
+    }
+
+    fname = vim_strsave(buf->b_ffname);
+    if (fname == NULL)
+	return;
+
+    /* Watch the directory of the file and every directory above it, so that
+     * renaming any of them is noticed. */
+    for (p = fname; (p = vim_strchr(p, '/')) != NULL; ++p)
+    {
+	filedir = vim_strchr(p + 1, '/') == NULL;
+	end = p == fname ? p + 1 : p;
+	c = *end;
+	*end = NUL;
+	w = watch_dir_add(fname, filedir);
+	*end = c;
+	if (w < 0)
+	{
+	    /* When there are too many watches the file is checked as
+	     * before. */
+	    wd = -1;
+	    break;
+	}
+	wd = w;
+    }
+
+    if (wd > 0)
+    {
+	buf->b_watch_fname = fname;
+	buf->b_watch_wd = wd;
+	buf->b_watch_changed = FALSE;
+    }
+    else
+    {
+	watch_dir_release(fname);
+	vim_free(fname);
+    }
+}
+
+/*
+ * Watch directory "dir", the directory of a file when "filedir" is TRUE,
+ * otherwise one above it.
+ * Returns the watch descriptor, -1 when it can't be watched.
+ */
+    static int
+watch_dir_add(char_u *dir, int filedir)
+{
+    watchdir_T	*wdp = NULL;
+    int		wd;
+    int		i;
+
+    for (i = 0; i < watch_dirs.ga_len; ++i)
+	if (STRCMP(((watchdir_T *)watch_dirs.ga_data)[i].wd_name, dir) == 0)
+	{
+	    wdp = (watchdir_T *)watch_dirs.ga_data + i;
+	    break;
+	}
+    if (wdp != NULL && !filedir)
+	return wdp->wd_wd;
+    if (wdp == NULL && !watch_local_fs(dir))
+	return -1;
+
+    /* Adding a watch for the same directory again returns the same watch
+     * descriptor, keep the events for both uses. */
+    wd = inotify_add_watch(watch_fd, (char *)dir,
+			 (filedir ? WATCH_MASK : WATCH_MASK_ABOVE) | IN_MASK_ADD);
+    if (wdp != NULL)
+	/* When it differs the path leads to another directory now. */
+	return wd == wdp->wd_wd ? wd : -1;
+    if (wd < 0 || ga_grow(&watch_dirs, 1) == FAIL)
+	return -1;
+    wdp = (watchdir_T *)watch_dirs.ga_data + watch_dirs.ga_len;
+    wdp->wd_name = vim_strsave(dir);
+    if (wdp->wd_name == NULL)
+	return -1;
+    wdp->wd_wd = wd;
+    ++watch_dirs.ga_len;
+    return wd;
+}
+
+/*
+ * Stop watching the directories of file "fname" that no watched file uses.
+ */
+    static void
+watch_dir_release(char_u *fname)
+{
+    watchdir_T	*wdp;
+    buf_T	*buf;
+    int		i;
+    int		j;
+
+    for (i = watch_dirs.ga_len - 1; i >= 0; --i)
+    {
+	wdp = (watchdir_T *)watch_dirs.ga_data + i;
+	if (!watch_below(fname, wdp->wd_name))
+	    continue;
+	FOR_ALL_BUFFERS(buf)
+	    if (buf->b_watch_wd > 0
+			     && watch_below(buf->b_watch_fname, wdp->wd_name))
+		break;
+	if (buf != NULL)
+	    continue;
+
+	/* Remove the watch unless a symbolic link leads to the same
+	 * directory. */
+	for (j = 0; j < watch_dirs.ga_len; ++j)
+	    if (j != i && ((watchdir_T *)watch_dirs.ga_data)[j].wd_wd
+								== wdp->wd_wd)
+		break;
+	if (j == watch_dirs.ga_len)
+	    inotify_rm_watch(watch_fd, wdp->wd_wd);
+	vim_free(wdp->wd_name);
+	--watch_dirs.ga_len;
+	if (i < watch_dirs.ga_len)
+	    *wdp = ((watchdir_T *)watch_dirs.ga_data)[watch_dirs.ga_len];
+    }
+}
+
+/*
+ * Return TRUE when file "fname" is in directory "dir" or below it.
+ */
+    static int
+watch_below(char_u *fname, char_u *dir)
+{
+    size_t	len = STRLEN(dir);
+
+    if (len == 1 && *dir == '/')
+	return TRUE;
+    return STRNCMP(fname, dir, len) == 0 && fname[len] == '/';
+}
+
+/*
+ * Stop watching the file of "buf".  Remove the watches that no other buffer
+ * uses, otherwise events keep coming for directories no longer edited.
+ */
+    void
+buf_unwatch_file(buf_T *buf)
+{
+    char_u	*fname = buf->b_watch_fname;
+
+    buf->b_watch_wd = 0;
+    buf->b_watch_fname = NULL;
+    if (fname == NULL)
+	return;
+    if (watch_fd >= 0)
+	watch_dir_release(fname);
+    vim_free(fname);
+}
+
+/*
+ * Return TRUE when inotify reports all changes to files in directory "dir".
+ * Not so for a network file system, where another system can change a file.
+ */
+    static int
+watch_local_fs(char_u *dir)
+{
+    struct statfs   sfs;
+
+    if (statfs((char *)dir, &sfs) != 0)
+	return FALSE;
+    switch ((unsigned)sfs.f_type)
+    {
+	case 0xEF53U:		/* ext2, ext3 and ext4 */
+	case 0x58465342U:	/* xfs */
+	case 0x9123683EU:	/* btrfs */
+	case 0x01021994U:	/* tmpfs */
+	case 0xF2F52010U:	/* f2fs */
+	case 0x2FC12FC1U:	/* zfs */
+	case 0x3153464AU:	/* jfs */
+	case 0x52654973U:	/* reiserfs */
+	case 0x794C7630U:	/* overlayfs */
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Read the pending inotify events and mark the buffers of changed files.
+ */
+    static void
+watch_read_events(void)
+{
+    union
+    {
+	struct inotify_event	ev;
+	char			buf[4096];
+    }				u;
+    struct inotify_event	*ev;
+    char			*p;
+    long			len;
+
+    if (watch_fd < 0)
+	return;
+    while ((len = read(watch_fd, u.buf, sizeof(u.buf))) > 0)
+	for (p = u.buf; p < u.buf + len;
+				  p += sizeof(struct inotify_event) + ev->len)
+	{
+	    ev = (struct inotify_event *)p;
+	    watch_handle_event(ev->wd, ev->mask, ev->len > 0 ? ev->name : NULL);
+	}
+}
+
+/*
+ * Handle inotify event "mask" for watch "wd" and file "name" (NULL for the
+ * directory itself).
+ */
+    static void
+watch_handle_event(int wd, unsigned mask, char *name)
+{
+    buf_T	*buf;
+    garray_T	paths;
+    watchdir_T	*wdp;
+    char_u	*path;
+    int		found = FALSE;
+    int		i;
+
+    if (mask & IN_Q_OVERFLOW)
+    {
+	/* Events were lost, a directory may have been renamed.  Check all
+	 * files and watch them again. */
+	FOR_ALL_BUFFERS(buf)
+	    if (buf->b_watch_wd > 0)
+	    {
+		buf->b_watch_changed = TRUE;
+		buf_unwatch_file(buf);
+	    }
+	return;
+    }
+
+    /* Find the changed paths first, unwatching files changes watch_dirs. */
+    ga_init2(&paths, (int)sizeof(char_u *), 4);
+    for (i = 0; i < watch_dirs.ga_len; ++i)
+    {
+	wdp = (watchdir_T *)watch_dirs.ga_data + i;
+	if (wdp->wd_wd != wd)
+	    continue;
+	found = TRUE;
+	if (mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT))
+	    path = vim_strsave(wdp->wd_name);
+	else if (name != NULL)
+	    path = concat_fnames(wdp->wd_name, (char_u *)name, TRUE);
+	else
+	    continue;
+	if (path != NULL && ga_grow(&paths, 1) == OK)
+	    ((char_u **)paths.ga_data)[paths.ga_len++] = path;
+	else
+	    vim_free(path);
+    }
+
+    for (i = 0; i < paths.ga_len; ++i)
+    {
+	path = ((char_u **)paths.ga_data)[i];
+	FOR_ALL_BUFFERS(buf)
+	{
+	    if (buf->b_watch_wd <= 0)
+		continue;
+	    if (STRCMP(buf->b_watch_fname, path) == 0)
+		buf->b_watch_changed = TRUE;
+	    else if (watch_below(buf->b_watch_fname, path))
+	    {
+		/* A directory in the path changed, the watches may be for
+		 * the wrong directories now. */
+		buf->b_watch_changed = TRUE;
+		buf_unwatch_file(buf);
+	    }
+	}
+    }
+    ga_clear_strings(&paths);
+
+    /* Remove a watch that no buffer uses.  After IN_IGNORED the kernel
+     * already removed it. */
+    if (!found && !(mask & IN_IGNORED))
+	inotify_rm_watch(watch_fd, wd);
+}
+#endif
+
 /*
  * Adjust the line with missing eol, used for the next write.
  * Used for do_filter(), when the input lines for the filter are deleted.
@@ -1600,6 +1600,11 @@ EXTERN time_T starttime;
 EXTERN FILE *time_fd INIT(= NULL);  /* where to write startup timing */
 #endif
 
+#ifdef FEAT_PROFILE
+EXTERN int rendertime_on INIT(= FALSE);	    /* ":rendertime on" */
+EXTERN FILE *rendertime_fd INIT(= NULL);    /* where to write frame timing */
+#endif
+
 /*
  * Some compilers warn for not using a return value, but in some situations we
  * can't do anything useful with the value.  Assign to this variable to avoid
@@ -262,6 +262,13 @@
 # define MESSAGE_QUEUE
 #endif
 
+/* With ":write ++async" a thread flushes and closes the file, the message
+ * queue is used to finish up when it is done. */
+#if defined(MESSAGE_QUEUE) && defined(UNIX) && defined(HAVE_PTHREAD) \
+	&& defined(HAVE_FSYNC)
+# define USE_ASYNC_WRITE
+#endif
+
 #if defined(FEAT_EVAL) && defined(FEAT_FLOAT)
 # include <float.h>
 # if defined(HAVE_MATH_H)
@@ -1246,6 +1246,8 @@ main_loop(
 	    update_topline();
 	    validate_cursor();
 
+	    /* Write the screen update, messages and cursor position at once. */
+	    out_frame_start();
 	    if (VIsual_active)
 		update_curbuf(INVERTED);/* update inverted part */
 	    else if (must_redraw)
@@ -1290,6 +1292,7 @@ main_loop(
 
 	    setcursor();
 	    cursor_on();
+	    out_frame_end();
 
 	    do_redraw = FALSE;
 
@@ -1417,6 +1420,13 @@ getout(int exitval)
     msg_didany = FALSE;
 #endif
 
+#ifdef USE_ASYNC_WRITE
+    /* Files written with ":write ++async" must be flushed before exiting. */
+    async_write_wait(NULL);
+    if (v_dying <= 1)
+	async_write_check();
+#endif
+
     if (v_dying <= 1)
     {
 	tabpage_T	*tp;
@@ -1478,6 +1488,7 @@ getout(int exitval)
 
 #ifdef FEAT_PROFILE
     profile_dump();
+    rendertime_log_frame(FALSE);
 #endif
 
     if (did_emsg
@@ -1928,6 +1939,13 @@ command_line_scan(mparm_T *parmp)
 		    want_argument = TRUE;
 		    argv_idx += 11;
 		}
+#ifdef FEAT_PROFILE
+		else if (STRNICMP(argv[0] + argv_idx, "rendertime", 10) == 0)
+		{
+		    want_argument = TRUE;
+		    argv_idx += 10;
+		}
+#endif
 #ifdef FEAT_CLIENTSERVER
 		else if (STRNICMP(argv[0] + argv_idx, "serverlist", 10) == 0)
 		    ; /* already processed -- no arg */
@@ -2309,6 +2327,14 @@ command_line_scan(mparm_T *parmp)
 			parmp->pre_commands[parmp->n_pre_commands++] =
 							    (char_u *)argv[0];
 		    }
+#ifdef FEAT_PROFILE
+		    else if (argv[-1][2] == 'r')
+		    {
+			/* "--rendertime <file>" write redraw timing to file */
+			rendertime_fd = mch_fopen(argv[0], "a");
+			rendertime_on = TRUE;
+		    }
+#endif
 		    /* "--startuptime <file>" already handled */
 		    break;
 
@@ -3377,6 +3403,9 @@ usage(void)
 #ifdef STARTUPTIME
     main_msg(_("--startuptime <file>\tWrite startup timing messages to <file>"));
 #endif
+#ifdef FEAT_PROFILE
+    main_msg(_("--rendertime <file>\tWrite redraw timing for each frame to <file>"));
+#endif
 #ifdef FEAT_VIMINFO
     main_msg(_("-i <viminfo>\t\tUse <viminfo> instead of .viminfo"));
 #endif
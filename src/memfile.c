@@ -65,16 +65,56 @@ extern int dos2;			/* this is in os_amiga.c */
 # endif
 #endif
 
+#if defined(UNIX) && defined(HAVE_PTHREAD) && defined(HAVE_FSYNC)
+# include <pthread.h>
+# define USE_FSYNC_THREAD
+#endif
+
 #define MEMFILE_PAGE_SIZE 4096		/* default page size */
 
 static long_u	total_mem_used = 0;	/* total memory used for memfiles */
 
+#ifdef USE_FSYNC_THREAD
+/*
+ * fsync() on a swap file can take a long time, e.g. on a network file system.
+ * When syncing because the user didn't type anything for 'updatetime', the
+ * blocks are written as usual, but the fsync() is done by a thread, so that
+ * it doesn't hold up typing.  The queue holds the file descriptors of swap
+ * files waiting to be flushed.  mf_flush_wait() waits for the thread to be
+ * done with a swap file, this must be done before closing it.
+ * When the fsync() fails the file is remembered in mf_syncq_failed[], the
+ * next mf_sync() for it then flushes the file itself and returns FAIL when
+ * that fails again.
+ */
+# define MF_SYNCQ_LEN 16
+
+static pthread_mutex_t	mf_syncq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	mf_syncq_added = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	mf_syncq_done = PTHREAD_COND_INITIALIZER;
+static int		mf_syncq[MF_SYNCQ_LEN];
+static int		mf_syncq_len = 0;	/* nr of entries in mf_syncq[] */
+static int		mf_syncq_busy = -1;	/* fd being flushed or -1 */
+static int		mf_syncq_started = FALSE; /* thread is running */
+static int		mf_syncq_failed[MF_SYNCQ_LEN];
+static int		mf_syncq_failed_len = 0; /* nr of entries in
+						    mf_syncq_failed[] */
+
+static int  mf_syncq_add(int fd);
+static int  mf_syncq_rem_failed(int fd);
+static int  mf_syncq_did_fail(int fd);
+#endif
+
 static void mf_ins_hash(memfile_T *, bhdr_T *);
 static void mf_rem_hash(memfile_T *, bhdr_T *);
 static bhdr_T *mf_find_hash(memfile_T *, blocknr_T);
 static void mf_ins_used(memfile_T *, bhdr_T *);
+static void mf_ins_protected(memfile_T *, bhdr_T *);
 static void mf_rem_used(memfile_T *, bhdr_T *);
 static bhdr_T *mf_release(memfile_T *, int);
+static int  mf_compress(memfile_T *, bhdr_T *);
+static int  mf_uncompress(memfile_T *, bhdr_T *);
+static int  mf_lz_compress(char_u *src, int len, char_u *dst, int maxlen);
+static int  mf_lz_uncompress(char_u *src, int len, char_u *dst, int dstlen);
 static bhdr_T *mf_alloc_bhdr(memfile_T *, int);
 static void mf_free_bhdr(bhdr_T *);
 static void mf_ins_free(memfile_T *, bhdr_T *);
@@ -103,6 +143,7 @@ static int mf_hash_grow(mf_hashtab_T *);
  * mf_put()	    unlock a block, may be marked for writing
  * mf_free()	    remove a block
  * mf_sync()	    sync changed parts of memfile to disk
+ * mf_flush_wait()  wait for flushing the swap file in the background
  * mf_release_all() release as much memory as possible
  * mf_trans_del()   may translate negative to positive block number
  * mf_fullname()    make file name full path (use before first :cd)
@@ -156,6 +197,18 @@ mf_open(char_u *fname, int flags)
     mfp->mf_used_last = NULL;
     mfp->mf_dirty = FALSE;
     mfp->mf_used_count = 0;
+    mfp->mf_prot_last = NULL;
+    mfp->mf_prot_count = 0;
+    mfp->mf_hits = 0;
+    mfp->mf_misses = 0;
+    mfp->mf_evictions = 0;
+    mfp->mf_comp_first = NULL;
+    mfp->mf_comp_pages = 0;
+    mfp->mf_comp_bytes = 0;
+    mfp->mf_decompressions = 0;
+#ifdef FEAT_RELTIME
+    profile_zero(&mfp->mf_decomp_time);
+#endif
     mf_hash_init(&mfp->mf_hash);
     mf_hash_init(&mfp->mf_trans);
     mfp->mf_page_size = MEMFILE_PAGE_SIZE;
@@ -228,6 +281,12 @@ mf_open_file(memfile_T *mfp, char_u *fname)
     if (mfp->mf_fd < 0)
 	return FAIL;
 
+    /* Compressed blocks can't be written, they go back to the used list and
+     * will be released to the file when needed. */
+    while (mfp->mf_comp_first != NULL)
+	if (mf_uncompress(mfp, mfp->mf_comp_first) == FAIL)
+	    break;
+
     mfp->mf_dirty = TRUE;
     return OK;
 }
@@ -244,6 +303,7 @@ mf_close(memfile_T *mfp, int del_file)
 	return;
     if (mfp->mf_fd >= 0)
     {
+	mf_flush_wait(mfp);
 	if (close(mfp->mf_fd) < 0)
 	    emsg(_(e_swapclose));
     }
@@ -255,6 +315,13 @@ mf_close(memfile_T *mfp, int del_file)
 	total_mem_used -= hp->bh_page_count * mfp->mf_page_size;
 	nextp = hp->bh_next;
 	mf_free_bhdr(hp);
+    }
+					    /* free entries in compressed list */
+    for (hp = mfp->mf_comp_first; hp != NULL; hp = nextp)
+    {
+	total_mem_used -= hp->bh_comp_size;
+	nextp = hp->bh_next;
+	mf_free_bhdr(hp);
     }
     while (mfp->mf_free_first != NULL)	    /* free entries in free list */
 	vim_free(mf_rem_free(mfp));
@@ -290,6 +357,7 @@ mf_close_file(
 	/* TODO: should check if all blocks are really in core */
     }
 
+    mf_flush_wait(mfp);
     if (close(mfp->mf_fd) < 0)			/* close the file */
 	emsg(_(e_swapclose));
     mfp->mf_fd = -1;
@@ -446,15 +514,37 @@ mf_get(memfile_T *mfp, blocknr_T nr, int page_count)
 	    mf_free_bhdr(hp);
 	    return NULL;
 	}
+	++mfp->mf_misses;
+	hp->bh_flags |= BH_LOCKED;
+	mf_ins_used(mfp, hp);	/* put in front of unprotected blocks */
     }
     else
     {
+	if (hp->bh_flags & BH_COMPRESSED)
+	{
+	    bhdr_T	*rel_hp;
+
+	    /* Compress another block if needed, then decompress this one.
+	     * mf_release() may also create a swap file, that decompresses all
+	     * blocks, and then return a released block.  Lock this block so
+	     * that it is not the one released, the other one is not needed. */
+	    hp->bh_flags |= BH_LOCKED;
+	    rel_hp = mf_release(mfp, page_count);
+	    if (rel_hp != NULL)
+		mf_free_bhdr(rel_hp);
+	    if ((hp->bh_flags & BH_COMPRESSED) && mf_uncompress(mfp, hp) == FAIL)
+	    {
+		hp->bh_flags &= ~BH_LOCKED;
+		return NULL;
+	    }
+	}
+	++mfp->mf_hits;
 	mf_rem_used(mfp, hp);	/* remove from list, insert in front below */
 	mf_rem_hash(mfp, hp);
+	hp->bh_flags |= BH_LOCKED;
+	mf_ins_protected(mfp, hp);  /* put in front of used list */
     }
 
-    hp->bh_flags |= BH_LOCKED;
-    mf_ins_used(mfp, hp);	/* put in front of used list */
     mf_ins_hash(mfp, hp);	/* put in front of hash list */
 
     return hp;
@@ -484,7 +574,7 @@ mf_put(
     flags &= ~BH_LOCKED;
     if (dirty)
     {
-	flags |= BH_DIRTY;
+	flags = (flags | BH_DIRTY) & ~BH_NOCOMPRESS;
 	mfp->mf_dirty = TRUE;
     }
     hp->bh_flags = flags;
@@ -529,7 +619,8 @@ fdtofh(int filedescriptor)
  *  MFS_STOP	Stop syncing when a character becomes available, but sync at
  *		least one block.
  *  MFS_FLUSH	Make sure buffers are flushed to disk, so they will survive a
- *		system crash.
+ *		system crash.  Together with MFS_STOP this may be done in the
+ *		background.
  *  MFS_ZERO	Only write block 0.
  *
  * Return FAIL for failure, OK otherwise
@@ -600,8 +691,14 @@ mf_sync(memfile_T *mfp, int flags)
 	 */
 	if (STRCMP(p_sws, "fsync") == 0)
 	{
-	    if (vim_fsync(mfp->mf_fd))
-		status = FAIL;
+#  ifdef USE_FSYNC_THREAD
+	    /* Let the thread do it when the user may start typing.  Not when
+	     * it failed doing that last time. */
+	    if (!(flags & MFS_STOP) || mf_syncq_did_fail(mfp->mf_fd)
+					    || mf_syncq_add(mfp->mf_fd) == FAIL)
+#  endif
+		if (vim_fsync(mfp->mf_fd))
+		    status = FAIL;
 	}
 	else
 # endif
@@ -675,6 +772,154 @@ mf_sync(memfile_T *mfp, int flags)
     return status;
 }
 
+#ifdef USE_FSYNC_THREAD
+/*
+ * The thread that flushes swap files in the background.
+ */
+    static void *
+mf_syncq_thread(void *arg UNUSED)
+{
+    int		fd;
+    int		i;
+
+    pthread_mutex_lock(&mf_syncq_mutex);
+    for (;;)
+    {
+	while (mf_syncq_len == 0)
+	    pthread_cond_wait(&mf_syncq_added, &mf_syncq_mutex);
+	fd = mf_syncq[0];
+	--mf_syncq_len;
+	mch_memmove(mf_syncq, mf_syncq + 1, mf_syncq_len * sizeof(int));
+	mf_syncq_busy = fd;
+	pthread_mutex_unlock(&mf_syncq_mutex);
+
+	if (vim_fsync(fd) != 0)
+	{
+	    pthread_mutex_lock(&mf_syncq_mutex);
+	    for (i = 0; i < mf_syncq_failed_len; ++i)
+		if (mf_syncq_failed[i] == fd)
+		    break;
+	    if (i == mf_syncq_failed_len && i < MF_SYNCQ_LEN)
+		mf_syncq_failed[mf_syncq_failed_len++] = fd;
+	}
+	else
+	    pthread_mutex_lock(&mf_syncq_mutex);
+	mf_syncq_busy = -1;
+	pthread_cond_broadcast(&mf_syncq_done);
+    }
+    /* NOTREACHED */
+    return NULL;
+}
+
+/*
+ * Add swap file "fd" to the queue of files to be flushed by the thread.
+ * Starts the thread when needed.
+ * Returns FAIL when this isn't possible, the caller must flush the file.
+ */
+    static int
+mf_syncq_add(int fd)
+{
+    int		retval = FAIL;
+    int		i;
+    pthread_t	thread;
+    sigset_t	set;
+    sigset_t	oldset;
+
+    pthread_mutex_lock(&mf_syncq_mutex);
+    if (!mf_syncq_started)
+    {
+	/* Signals must be handled by the main thread, block all of them in
+	 * the new thread. */
+	sigfillset(&set);
+	pthread_sigmask(SIG_SETMASK, &set, &oldset);
+	if (pthread_create(&thread, NULL, mf_syncq_thread, NULL) == 0)
+	{
+	    pthread_detach(thread);
+	    mf_syncq_started = TRUE;
+	}
+	pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+    }
+    if (mf_syncq_started)
+    {
+	for (i = 0; i < mf_syncq_len; ++i)
+	    if (mf_syncq[i] == fd)
+		break;
+	if (i < mf_syncq_len)
+	    retval = OK;		/* already waiting to be flushed */
+	else if (mf_syncq_len < MF_SYNCQ_LEN)
+	{
+	    mf_syncq[mf_syncq_len++] = fd;
+	    pthread_cond_signal(&mf_syncq_added);
+	    retval = OK;
+	}
+    }
+    pthread_mutex_unlock(&mf_syncq_mutex);
+    return retval;
+}
+
+/*
+ * Remove swap file "fd" from mf_syncq_failed[].  Return TRUE when it was
+ * there.  Must be called with mf_syncq_mutex locked.
+ */
+    static int
+mf_syncq_rem_failed(int fd)
+{
+    int		i;
+
+    for (i = 0; i < mf_syncq_failed_len; ++i)
+	if (mf_syncq_failed[i] == fd)
+	{
+	    --mf_syncq_failed_len;
+	    mf_syncq_failed[i] = mf_syncq_failed[mf_syncq_failed_len];
+	    return TRUE;
+	}
+    return FALSE;
+}
+
+/*
+ * Return TRUE when flushing swap file "fd" in the background failed since the
+ * last call.
+ */
+    static int
+mf_syncq_did_fail(int fd)
+{
+    int		retval;
+
+    pthread_mutex_lock(&mf_syncq_mutex);
+    retval = mf_syncq_rem_failed(fd);
+    pthread_mutex_unlock(&mf_syncq_mutex);
+    return retval;
+}
+#endif
+
+/*
+ * Wait until the swap file of memfile "mfp" is no longer being flushed in
+ * the background.  Must be called before closing the file.
+ */
+    void
+mf_flush_wait(memfile_T *mfp)
+{
+#ifdef USE_FSYNC_THREAD
+    int		i;
+
+    if (mfp->mf_fd < 0)
+	return;
+    pthread_mutex_lock(&mf_syncq_mutex);
+    for (;;)
+    {
+	for (i = 0; i < mf_syncq_len; ++i)
+	    if (mf_syncq[i] == mfp->mf_fd)
+		break;
+	if (i == mf_syncq_len && mf_syncq_busy != mfp->mf_fd)
+	    break;
+	pthread_cond_wait(&mf_syncq_done, &mf_syncq_mutex);
+    }
+    /* The file descriptor may be reused for another file. */
+    (void)mf_syncq_rem_failed(mfp->mf_fd);
+    pthread_mutex_unlock(&mf_syncq_mutex);
+#endif
+}
+
 /*
  * For all blocks in memory file *mfp that have a positive block number set
  * the dirty flag.  These are blocks that need to be written to a newly
@@ -719,11 +964,41 @@ mf_find_hash(memfile_T *mfp, blocknr_T nr)
 }
 
 /*
- * insert block *hp in front of used list of memfile *mfp
+ * insert block *hp in the used list of memfile *mfp, in front of the blocks
+ * that are not protected
  */
     static void
 mf_ins_used(memfile_T *mfp, bhdr_T *hp)
 {
+    hp->bh_prev = mfp->mf_prot_last;
+    if (hp->bh_prev == NULL)	    /* no protected blocks, insert in front */
+    {
+	hp->bh_next = mfp->mf_used_first;
+	mfp->mf_used_first = hp;
+    }
+    else
+    {
+	hp->bh_next = hp->bh_prev->bh_next;
+	hp->bh_prev->bh_next = hp;
+    }
+    if (hp->bh_next == NULL)	    /* at end of list, adjust last pointer */
+	mfp->mf_used_last = hp;
+    else
+	hp->bh_next->bh_prev = hp;
+    mfp->mf_used_count += hp->bh_page_count;
+    total_mem_used += hp->bh_page_count * mfp->mf_page_size;
+}
+
+/*
+ * insert block *hp in front of used list of memfile *mfp and protect it.
+ * When the protected blocks take up more than three quarters of the pages,
+ * the last one becomes unprotected.
+ */
+    static void
+mf_ins_protected(memfile_T *mfp, bhdr_T *hp)
+{
+    bhdr_T	*lp;
+
     hp->bh_next = mfp->mf_used_first;
     mfp->mf_used_first = hp;
     hp->bh_prev = NULL;
@@ -733,6 +1008,19 @@ mf_ins_used(memfile_T *mfp, bhdr_T *hp)
 	hp->bh_next->bh_prev = hp;
     mfp->mf_used_count += hp->bh_page_count;
     total_mem_used += hp->bh_page_count * mfp->mf_page_size;
+
+    hp->bh_flags |= BH_PROTECTED;
+    if (mfp->mf_prot_last == NULL)
+	mfp->mf_prot_last = hp;
+    mfp->mf_prot_count += hp->bh_page_count;
+    while (mfp->mf_prot_count
+		     > mfp->mf_used_count_max - mfp->mf_used_count_max / 4)
+    {
+	lp = mfp->mf_prot_last;
+	lp->bh_flags &= ~BH_PROTECTED;
+	mfp->mf_prot_count -= lp->bh_page_count;
+	mfp->mf_prot_last = lp->bh_prev;
+    }
 }
 
 /*
@@ -741,6 +1029,13 @@ mf_ins_used(memfile_T *mfp, bhdr_T *hp)
     static void
 mf_rem_used(memfile_T *mfp, bhdr_T *hp)
 {
+    if (hp->bh_flags & BH_PROTECTED)
+    {
+	if (hp == mfp->mf_prot_last)
+	    mfp->mf_prot_last = hp->bh_prev;
+	mfp->mf_prot_count -= hp->bh_page_count;
+	hp->bh_flags &= ~BH_PROTECTED;
+    }
     if (hp->bh_next == NULL)	    /* last block in used list */
 	mfp->mf_used_last = hp->bh_prev;
     else
@@ -755,7 +1050,8 @@ mf_rem_used(memfile_T *mfp, bhdr_T *hp)
 
 /*
  * Release the least recently used block from the used list if the number
- * of used memory blocks gets to big.
+ * of used memory blocks gets to big.  Blocks that are not protected are at
+ * the end of the list, they go first.
  *
  * Return the block header to the caller, including the memory block, so
  * it can be re-used. Make sure the page_count is right.
@@ -803,7 +1099,15 @@ mf_release(memfile_T *mfp, int page_count)
      *	total memory used is not up to 'maxmemtot'
      */
     if (mfp->mf_fd < 0 || !need_release)
+    {
+	/* Without a file compress the least recently used block instead. */
+	if (mfp->mf_fd < 0 && need_release)
+	    for (hp = mfp->mf_used_last; hp != NULL; hp = hp->bh_prev)
+		if (!(hp->bh_flags & (BH_LOCKED | BH_NOCOMPRESS))
+					       && mf_compress(mfp, hp) == OK)
+		    break;
 	return NULL;
+    }
 
     for (hp = mfp->mf_used_last; hp != NULL; hp = hp->bh_prev)
 	if (!(hp->bh_flags & BH_LOCKED))
@@ -820,6 +1124,7 @@ mf_release(memfile_T *mfp, int page_count)
 
     mf_rem_used(mfp, hp);
     mf_rem_hash(mfp, hp);
+    ++mfp->mf_evictions;
 
     /*
      * If a bhdr_T is returned, make sure that the page_count of bh_data is
@@ -838,6 +1143,249 @@ mf_release(memfile_T *mfp, int page_count)
     return hp;
 }
 
+/*
+ * Compress block "hp" and move it from the used list to the compressed list.
+ * Returns FAIL when it doesn't get smaller or memory runs out.
+ */
+    static int
+mf_compress(memfile_T *mfp, bhdr_T *hp)
+{
+    int		size = mfp->mf_page_size * hp->bh_page_count;
+    int		len;
+    char_u	*p;
+
+    /* Only worth it when it takes at least a quarter less memory. */
+    if ((p = alloc(size)) == NULL)
+	return FAIL;
+    len = mf_lz_compress(hp->bh_data, size, p, size - size / 4);
+    if (len == 0)
+    {
+	vim_free(p);
+	hp->bh_flags |= BH_NOCOMPRESS;
+	return FAIL;
+    }
+    mf_rem_used(mfp, hp);
+    vim_free(hp->bh_data);
+    hp->bh_data = vim_realloc(p, len);
+    if (hp->bh_data == NULL)	/* cannot really happen */
+	hp->bh_data = p;
+    hp->bh_comp_size = len;
+    hp->bh_flags |= BH_COMPRESSED;
+
+    hp->bh_prev = NULL;
+    hp->bh_next = mfp->mf_comp_first;
+    if (hp->bh_next != NULL)
+	hp->bh_next->bh_prev = hp;
+    mfp->mf_comp_first = hp;
+    mfp->mf_comp_pages += hp->bh_page_count;
+    mfp->mf_comp_bytes += len;
+    total_mem_used += len;
+    return OK;
+}
+
+/*
+ * Decompress block "hp" and move it from the compressed list to the used
+ * list.
+ */
+    static int
+mf_uncompress(memfile_T *mfp, bhdr_T *hp)
+{
+    int		size = mfp->mf_page_size * hp->bh_page_count;
+    char_u	*p;
+#ifdef FEAT_RELTIME
+    proftime_T	start;
+#endif
+
+    if ((p = alloc(size)) == NULL)
+	return FAIL;
+#ifdef FEAT_RELTIME
+    profile_start(&start);
+#endif
+    if (mf_lz_uncompress(hp->bh_data, hp->bh_comp_size, p, size) == FAIL)
+    {
+	vim_free(p);
+	siemsg(_("E983: Cannot decompress block %ld"), (long)hp->bh_bnum);
+	return FAIL;
+    }
+#ifdef FEAT_RELTIME
+    profile_end(&start);
+    profile_add(&mfp->mf_decomp_time, &start);
+#endif
+    ++mfp->mf_decompressions;
+
+    if (hp->bh_prev == NULL)
+	mfp->mf_comp_first = hp->bh_next;
+    else
+	hp->bh_prev->bh_next = hp->bh_next;
+    if (hp->bh_next != NULL)
+	hp->bh_next->bh_prev = hp->bh_prev;
+    mfp->mf_comp_pages -= hp->bh_page_count;
+    mfp->mf_comp_bytes -= hp->bh_comp_size;
+    total_mem_used -= hp->bh_comp_size;
+
+    vim_free(hp->bh_data);
+    hp->bh_data = p;
+    hp->bh_flags &= ~BH_COMPRESSED;
+    mf_ins_used(mfp, hp);
+    return OK;
+}
+
+/*
+ * A simple LZ77 compressor, using the LZ4 block format: A sequence starts
+ * with a token byte, the upper four bits are the number of literal bytes and
+ * the lower four bits the match length minus MF_LZ_MINMATCH.  When one of
+ * them is 15, more bytes follow that are added, up to and including the
+ * first one that isn't 255.  Then come the literal bytes, a two byte offset
+ * of the match, least significant byte first, and the extra match length
+ * bytes.  The last sequence has only literals.
+ */
+#define MF_LZ_MINMATCH	4
+#define MF_LZ_HASHBITS	12
+#define MF_LZ_HASH(p) ((unsigned)(((p)[0] | ((p)[1] << 8) | ((p)[2] << 16) \
+		     | ((unsigned)(p)[3] << 24)) * 2654435761U) >> (32 - MF_LZ_HASHBITS))
+
+/*
+ * Store a length of 15 or more as extra bytes at "p".
+ * Returns the number of bytes used.
+ */
+    static int
+mf_lz_put_len(char_u *p, int len)
+{
+    int		n = 0;
+
+    for (len -= 15; len >= 255; len -= 255)
+	p[n++] = 255;
+    p[n++] = len;
+    return n;
+}
+
+/*
+ * Compress "len" bytes at "src" into "dst", using at most "maxlen" bytes.
+ * Returns the compressed size, zero when it doesn't fit.
+ */
+    static int
+mf_lz_compress(char_u *src, int len, char_u *dst, int maxlen)
+{
+    int		htab[1 << MF_LZ_HASHBITS];
+    int		ip = 0;		/* current position in "src" */
+    int		anchor = 0;	/* start of literals in "src" */
+    int		op = 0;		/* current position in "dst" */
+    int		ref;
+    int		h;
+    int		llen;
+    int		mlen;
+
+    for (h = 0; h < (1 << MF_LZ_HASHBITS); ++h)
+	htab[h] = -1;
+
+    while (ip + MF_LZ_MINMATCH <= len)
+    {
+	h = MF_LZ_HASH(src + ip);
+	ref = htab[h];
+	htab[h] = ip;
+	if (ref < 0 || ip - ref > 0xffff
+			     || memcmp(src + ref, src + ip, MF_LZ_MINMATCH) != 0)
+	{
+	    ++ip;
+	    continue;
+	}
+	for (mlen = MF_LZ_MINMATCH; ip + mlen < len
+				      && src[ref + mlen] == src[ip + mlen]; ++mlen)
+	    ;
+
+	/* token, literals, offset and lengths must fit */
+	llen = ip - anchor;
+	if (op + 1 + llen + llen / 255 + 1 + 2 + mlen / 255 + 1 > maxlen)
+	    return 0;
+	dst[op++] = ((llen < 15 ? llen : 15) << 4)
+	       | (mlen - MF_LZ_MINMATCH < 15 ? mlen - MF_LZ_MINMATCH : 15);
+	if (llen >= 15)
+	    op += mf_lz_put_len(dst + op, llen);
+	mch_memmove(dst + op, src + anchor, (size_t)llen);
+	op += llen;
+	dst[op++] = (ip - ref) & 0xff;
+	dst[op++] = (ip - ref) >> 8;
+	if (mlen - MF_LZ_MINMATCH >= 15)
+	    op += mf_lz_put_len(dst + op, mlen - MF_LZ_MINMATCH);
+
+	ip += mlen;
+	anchor = ip;
+    }
+
+    /* last literals */
+    llen = len - anchor;
+    if (op + 1 + llen + llen / 255 + 1 > maxlen)
+	return 0;
+    dst[op++] = (llen < 15 ? llen : 15) << 4;
+    if (llen >= 15)
+	op += mf_lz_put_len(dst + op, llen);
+    mch_memmove(dst + op, src + anchor, (size_t)llen);
+    return op + llen;
+}
+
+/*
+ * Get a length of 15 or more from "src" at "*ip".
+ * Returns -1 for invalid data.
+ */
+    static int
+mf_lz_get_len(char_u *src, int len, int *ip)
+{
+    int		n = 15;
+
+    do
+    {
+	if (*ip >= len)
+	    return -1;
+	n += src[*ip];
+    } while (src[(*ip)++] == 255);
+    return n;
+}
+
+/*
+ * Decompress "len" bytes at "src" into "dstlen" bytes at "dst".
+ * Returns FAIL when the data is invalid.
+ */
+    static int
+mf_lz_uncompress(char_u *src, int len, char_u *dst, int dstlen)
+{
+    int		ip = 0;
+    int		op = 0;
+    int		token;
+    int		llen;
+    int		mlen;
+    int		off;
+
+    while (ip < len)
+    {
+	token = src[ip++];
+	llen = token >> 4;
+	if (llen == 15 && (llen = mf_lz_get_len(src, len, &ip)) < 0)
+	    return FAIL;
+	if (ip + llen > len || op + llen > dstlen)
+	    return FAIL;
+	mch_memmove(dst + op, src + ip, (size_t)llen);
+	ip += llen;
+	op += llen;
+	if (ip == len)
+	    break;		/* last sequence has no match */
+
+	if (ip + 2 > len)
+	    return FAIL;
+	off = src[ip] | (src[ip + 1] << 8);
+	ip += 2;
+	mlen = token & 15;
+	if (mlen == 15 && (mlen = mf_lz_get_len(src, len, &ip)) < 0)
+	    return FAIL;
+	mlen += MF_LZ_MINMATCH;
+	if (off == 0 || off > op || op + mlen > dstlen)
+	    return FAIL;
+	/* copy byte by byte, the match may overlap */
+	for ( ; mlen > 0; --mlen, ++op)
+	    dst[op] = dst[op - off];
+    }
+    return op == dstlen ? OK : FAIL;
+}
+
 /*
  * release as many blocks as possible
  * Used in case of out of memory
@@ -873,6 +1421,7 @@ mf_release_all(void)
 			mf_rem_used(mfp, hp);
 			mf_rem_hash(mfp, hp);
 			mf_free_bhdr(hp);
+			++mfp->mf_evictions;
 			hp = mfp->mf_used_last;	/* re-start, list was changed */
 			retval = TRUE;
 		    }
@@ -1305,7 +1854,7 @@ mf_do_open(
  * MHT_GROWTH_FACTOR when the average number of items per bucket
  * exceeds 2 ^ MHT_LOG_LOAD_FACTOR.
  */
-#define MHT_LOG_LOAD_FACTOR 6
+#define MHT_LOG_LOAD_FACTOR 2
 #define MHT_GROWTH_FACTOR   2   /* must be a power of two */
 
 /*
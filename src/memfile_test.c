@@ -19,6 +19,21 @@
 #define NO_VIM_MAIN
 #include "main.c"
 
+/* Count the calls to vim_fsync() in memfile.c, make it fail when
+ * "fsync_fail" is set. */
+static int fsync_fail = FALSE;
+static int fsync_count = 0;
+
+    static int
+test_fsync(int fd)
+{
+    ++fsync_count;
+    if (fsync_fail)
+	return -1;
+    return vim_fsync(fd);
+}
+#define vim_fsync test_fsync
+
 /* This file has to be included because the tested functions are static */
 #include "memfile.c"
 
@@ -135,9 +150,290 @@ test_mf_hash(void)
     mf_hash_free_all(&ht);
 }
 
+#define TEST_BLOCKS 100
+#define TEST_MAX_PAGES 20
+#define TEST_OFTEN_USED 5
+
+/*
+ * Test that a sweep over many blocks doesn't release the blocks that are
+ * used often.
+ */
+    static void
+test_mf_release(void)
+{
+    memfile_T	*mfp;
+    bhdr_T	*hp;
+    blocknr_T	nr;
+    int		i;
+#ifdef FEAT_CRYPT
+    buf_T	buf;
+
+    vim_memset(&buf, 0, sizeof(buf));
+    buf.b_p_key = (char_u *)"";
+#endif
+
+    p_mmt = 1000000L;
+    mch_remove((char_u *)"Xmemfile_test");
+    mfp = mf_open(vim_strsave((char_u *)"Xmemfile_test"),
+						     O_RDWR | O_CREAT | O_EXCL);
+    assert(mfp != NULL);
+    assert(mfp->mf_fd >= 0);
+#ifdef FEAT_CRYPT
+    mfp->mf_buffer = &buf;
+#endif
+    mfp->mf_used_count_max = TEST_MAX_PAGES;
+
+    /* create the blocks, older ones are written to the file */
+    for (nr = 0; nr < TEST_BLOCKS; ++nr)
+    {
+	hp = mf_new(mfp, FALSE, 1);
+	assert(hp != NULL);
+	assert(hp->bh_bnum == nr);
+	hp->bh_data[0] = (char_u)nr;
+	mf_put(mfp, hp, TRUE, FALSE);
+	assert(mfp->mf_used_count <= TEST_MAX_PAGES);
+    }
+    assert(mf_sync(mfp, 0) == OK);
+    assert(mfp->mf_hits == 0);
+    assert(mfp->mf_misses == 0);
+    assert(mfp->mf_evictions == TEST_BLOCKS - TEST_MAX_PAGES);
+
+    /* use the first blocks twice */
+    for (i = 0; i < 2; ++i)
+	for (nr = 0; nr < TEST_OFTEN_USED; ++nr)
+	{
+	    hp = mf_get(mfp, nr, 1);
+	    assert(hp != NULL);
+	    assert(hp->bh_data[0] == nr);
+	    mf_put(mfp, hp, FALSE, FALSE);
+	}
+    assert(mfp->mf_hits == TEST_OFTEN_USED);
+    assert(mfp->mf_misses == TEST_OFTEN_USED);
+
+    /* use all the blocks that are not in memory once */
+    for (nr = TEST_OFTEN_USED; nr < TEST_BLOCKS - TEST_MAX_PAGES; ++nr)
+    {
+	assert(mf_find_hash(mfp, nr) == NULL);
+	hp = mf_get(mfp, nr, 1);
+	assert(hp != NULL);
+	assert(hp->bh_data[0] == nr);
+	mf_put(mfp, hp, FALSE, FALSE);
+    }
+    assert(mfp->mf_misses == TEST_BLOCKS - TEST_MAX_PAGES);
+
+    /* the often used blocks must still be in memory */
+    for (nr = 0; nr < TEST_OFTEN_USED; ++nr)
+	assert(mf_find_hash(mfp, nr) != NULL);
+
+    mf_close(mfp, TRUE);
+}
+
+/*
+ * Test mf_lz_compress() and mf_lz_uncompress() with text, zeros and data that
+ * can't be compressed.
+ */
+    static void
+test_mf_lz(void)
+{
+    char_u	src[8192];
+    char_u	comp[8192];
+    char_u	dst[8192];
+    int		len;
+    int		i;
+    long_u	r = 1;
+
+    /* lines of text followed by zeros, like a data block */
+    for (i = 0; i < 5000; ++i)
+	src[i] = "the quick brown fox jumps over the lazy dog\n"[i % 44];
+    vim_memset(src + 5000, 0, sizeof(src) - 5000);
+    len = mf_lz_compress(src, sizeof(src), comp, sizeof(comp));
+    assert(len > 0);
+    assert(len < 1000);
+    assert(mf_lz_uncompress(comp, len, dst, sizeof(dst)) == OK);
+    assert(memcmp(src, dst, sizeof(src)) == 0);
+
+    /* wrong size or truncated data is detected */
+    assert(mf_lz_uncompress(comp, len, dst, sizeof(dst) - 1) == FAIL);
+    assert(mf_lz_uncompress(comp, len / 2, dst, sizeof(dst)) == FAIL);
+
+    /* doesn't fit in a smaller buffer */
+    assert(mf_lz_compress(src, sizeof(src), comp, len - 1) == 0);
+
+    /* random data doesn't get smaller */
+    for (i = 0; i < (int)sizeof(src); ++i)
+    {
+	r = r * 1103515245 + 12345;
+	src[i] = (char_u)(r >> 16);
+    }
+    assert(mf_lz_compress(src, sizeof(src), comp, sizeof(comp) - 1) == 0);
+    len = mf_lz_compress(src, sizeof(src), comp, sizeof(comp) + 100);
+    assert(len > 0);
+    assert(mf_lz_uncompress(comp, len, dst, sizeof(dst)) == OK);
+    assert(memcmp(src, dst, sizeof(src)) == 0);
+}
+
+/*
+ * Test that without a swap file blocks are compressed instead of released.
+ */
+    static void
+test_mf_compress(void)
+{
+    memfile_T	*mfp;
+    bhdr_T	*hp;
+    blocknr_T	nr;
+    int		i;
+
+    p_mmt = 1000000L;
+    mfp = mf_open(NULL, 0);
+    assert(mfp != NULL);
+    mfp->mf_used_count_max = TEST_MAX_PAGES;
+
+    for (i = 0; i < TEST_BLOCKS; ++i)
+    {
+	hp = mf_new(mfp, TRUE, 1);
+	assert(hp != NULL);
+	assert(hp->bh_bnum == -1 - i);
+	vim_snprintf((char *)hp->bh_data, 100, "block %d", i);
+	mf_put(mfp, hp, TRUE, FALSE);
+	assert(mfp->mf_used_count <= TEST_MAX_PAGES);
+    }
+    assert(mfp->mf_comp_pages == TEST_BLOCKS - TEST_MAX_PAGES);
+    assert(mfp->mf_comp_bytes > 0);
+    assert(mfp->mf_comp_bytes < mfp->mf_comp_pages * 100);
+
+    for (i = 0; i < TEST_BLOCKS; ++i)
+    {
+	nr = -1 - i;
+	hp = mf_get(mfp, nr, 1);
+	assert(hp != NULL);
+	assert(hp->bh_bnum == nr);
+	assert(atoi((char *)hp->bh_data + 6) == i);
+	mf_put(mfp, hp, FALSE, FALSE);
+	assert(mfp->mf_used_count <= TEST_MAX_PAGES);
+    }
+    assert(mfp->mf_decompressions >= TEST_BLOCKS - TEST_MAX_PAGES);
+    assert(mfp->mf_comp_pages == TEST_BLOCKS - TEST_MAX_PAGES);
+
+    mf_close(mfp, FALSE);
+}
+
+#ifdef USE_FSYNC_THREAD
+/*
+ * Wait for the thread to be done flushing swap files.
+ */
+    static void
+wait_syncq_idle(void)
+{
+    pthread_mutex_lock(&mf_syncq_mutex);
+    while (mf_syncq_len > 0 || mf_syncq_busy >= 0)
+	pthread_cond_wait(&mf_syncq_done, &mf_syncq_mutex);
+    pthread_mutex_unlock(&mf_syncq_mutex);
+}
+
+/*
+ * Test flushing the swap file in the background, with fsync() working and
+ * failing, and that the file has all the blocks after closing it.
+ */
+    static void
+test_mf_sync_thread(void)
+{
+    memfile_T	*mfp;
+    bhdr_T	*hp;
+    blocknr_T	nr;
+    unsigned	page_size;
+    int		fd;
+    char_u	c;
+    char_u	*save_sws = p_sws;
+#ifdef FEAT_CRYPT
+    buf_T	buf;
+
+    vim_memset(&buf, 0, sizeof(buf));
+    buf.b_p_key = (char_u *)"";
+#endif
+
+    p_mmt = 1000000L;
+    p_sws = (char_u *)"fsync";
+    mch_remove((char_u *)"Xmemfile_test");
+    mfp = mf_open(vim_strsave((char_u *)"Xmemfile_test"),
+						     O_RDWR | O_CREAT | O_EXCL);
+    assert(mfp != NULL);
+    assert(mfp->mf_fd >= 0);
+#ifdef FEAT_CRYPT
+    mfp->mf_buffer = &buf;
+#endif
+    page_size = mfp->mf_page_size;
+
+    for (nr = 0; nr < TEST_BLOCKS; ++nr)
+    {
+	hp = mf_new(mfp, FALSE, 1);
+	assert(hp != NULL);
+	hp->bh_data[0] = (char_u)nr;
+	mf_put(mfp, hp, TRUE, FALSE);
+    }
+    assert(mf_sync(mfp, MFS_ALL) == OK);
+
+    /* a changed block is written, the thread flushes the file */
+    hp = mf_get(mfp, 1, 1);
+    assert(hp != NULL);
+    hp->bh_data[0] = 99;
+    mf_put(mfp, hp, TRUE, FALSE);
+    fsync_count = 0;
+    assert(mf_sync(mfp, MFS_STOP | MFS_FLUSH) == OK);
+    wait_syncq_idle();
+    assert(mf_syncq_started);
+    assert(fsync_count == 1);
+
+    /* when flushing in the background fails, the next time it is done right
+     * away and failing again is reported */
+    fsync_fail = TRUE;
+    assert(mf_sync(mfp, MFS_STOP | MFS_FLUSH) == OK);
+    wait_syncq_idle();
+    assert(fsync_count == 2);
+    assert(mf_syncq_failed_len == 1);
+    assert(mf_sync(mfp, MFS_STOP | MFS_FLUSH) == FAIL);
+    assert(fsync_count == 3);
+    assert(mf_syncq_failed_len == 0);
+    assert(mf_syncq_len == 0);
+
+    /* after that the thread is used again */
+    fsync_fail = FALSE;
+    assert(mf_sync(mfp, MFS_STOP | MFS_FLUSH) == OK);
+    wait_syncq_idle();
+    assert(fsync_count == 4);
+
+    /* a failure is forgotten when the file is closed */
+    fsync_fail = TRUE;
+    assert(mf_sync(mfp, MFS_STOP | MFS_FLUSH) == OK);
+    fsync_fail = FALSE;
+    mf_close(mfp, FALSE);
+    assert(mf_syncq_len == 0);
+    assert(mf_syncq_failed_len == 0);
+
+    /* the file has all the blocks, also the changed one */
+    fd = mch_open("Xmemfile_test", O_RDONLY | O_EXTRA, 0);
+    assert(fd >= 0);
+    for (nr = 0; nr < TEST_BLOCKS; ++nr)
+    {
+	assert(vim_lseek(fd, (off_T)nr * page_size, SEEK_SET)
+						   == (off_T)nr * page_size);
+	assert(read_eintr(fd, &c, 1) == 1);
+	assert(c == (nr == 1 ? 99 : nr));
+    }
+    close(fd);
+    mch_remove((char_u *)"Xmemfile_test");
+    p_sws = save_sws;
+}
+#endif
+
     int
 main(void)
 {
     test_mf_hash();
+    test_mf_release();
+    test_mf_lz();
+    test_mf_compress();
+#ifdef USE_FSYNC_THREAD
+    test_mf_sync_thread();
+#endif
     return 0;
 }
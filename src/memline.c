@@ -244,7 +244,10 @@ static void add_b0_fenc(ZERO_BL *b0p, buf_T *buf);
 static time_t swapfile_info(char_u *);
 static int recov_file_names(char_u **, char_u *, int prepend_dot);
 static int ml_append_int(buf_T *, linenr_T, char_u *, colnr_T, int, int);
+static long ml_append_block(buf_T *buf, linenr_T lnum, char_u **lines, colnr_T *lens, long count, int newfile);
 static int ml_delete_int(buf_T *, linenr_T, int);
+static long ml_delete_block(buf_T *buf, linenr_T lnum, long count);
+static int ml_delete_data_block(buf_T *buf, bhdr_T *hp);
 static char_u *findswapname(buf_T *, char_u **, char_u *);
 static void ml_flush_line(buf_T *);
 static bhdr_T *ml_new_data(memfile_T *, int, int);
@@ -262,7 +265,9 @@ static long char_to_long(char_u *);
 static cryptstate_T *ml_crypt_prepare(memfile_T *mfp, off_T offset, int reading);
 #endif
 #ifdef FEAT_BYTEOFF
-static void ml_updatechunk(buf_T *buf, long line, long len, int updtype);
+static void ml_updatechunk(buf_T *buf, long line, long len, long lines, int updtype);
+static void ml_chunktree_add(buf_T *buf, int idx, long lines, long size);
+static int ml_find_chunk(buf_T *buf, linenr_T lnum, long offset, int ffdos, linenr_T *linep, long *sizep);
 #endif
 
 /*
@@ -289,6 +294,7 @@ ml_open(buf_T *buf)
     buf->b_ml.ml_line_lnum = 0;	/* no cached line */
 #ifdef FEAT_BYTEOFF
     buf->b_ml.ml_chunksize = NULL;
+    buf->b_ml.ml_chunktree = NULL;
 #endif
 
     if (cmdmod.noswapfile)
@@ -678,6 +684,7 @@ ml_setname(buf_T *buf)
 	/* need to close the swap file before renaming */
 	if (mfp->mf_fd >= 0)
 	{
+	    mf_flush_wait(mfp);
 	    close(mfp->mf_fd);
 	    mfp->mf_fd = -1;
 	}
@@ -848,6 +855,7 @@ ml_close(buf_T *buf, int del_file)
     vim_free(buf->b_ml.ml_stack);
 #ifdef FEAT_BYTEOFF
     VIM_CLEAR(buf->b_ml.ml_chunksize);
+    VIM_CLEAR(buf->b_ml.ml_chunktree);
 #endif
     buf->b_ml.ml_mfp = NULL;
 
@@ -2672,6 +2680,56 @@ ml_append_buf(
 }
 #endif
 
+/*
+ * Append "count" lines after "lnum" in the current buffer (lnum may be 0).
+ * "lines[i]" is the text of a line and "lens[i]" its length including the
+ * NUL, or zero to use STRLEN().  "lens" may be NULL.
+ * As many lines as fit are copied into a data block at once, this is a lot
+ * faster than calling ml_append() for every line.
+ *
+ * Check: The caller of this function should probably also call
+ * appended_lines().
+ *
+ * return FAIL for failure, OK otherwise
+ */
+    int
+ml_append_lines(
+    linenr_T	lnum,		/* append after this line (can be 0) */
+    char_u	**lines,	/* text of the new lines */
+    colnr_T	*lens,		/* lengths of the new lines or NULL */
+    long	count,		/* number of lines */
+    int		newfile)	/* flag, see ml_append() */
+{
+    long	done;
+
+    /* When starting up, we might still need to create the memfile */
+    if (curbuf->b_ml.ml_mfp == NULL && open_buffer(FALSE, NULL, 0) == FAIL)
+	return FAIL;
+
+    if (curbuf->b_ml.ml_line_lnum != 0)
+	ml_flush_line(curbuf);
+    while (count > 0)
+    {
+	done = ml_append_block(curbuf, lnum, lines, lens, count, newfile);
+	if (done < 0)
+	    return FAIL;
+	if (done == 0)
+	{
+	    /* Block is full or the line needs special handling. */
+	    if (ml_append_int(curbuf, lnum, lines[0],
+			    lens == NULL ? 0 : lens[0], newfile, FALSE) == FAIL)
+		return FAIL;
+	    done = 1;
+	}
+	lnum += done;
+	lines += done;
+	if (lens != NULL)
+	    lens += done;
+	count -= done;
+    }
+    return OK;
+}
+
     static int
 ml_append_int(
     buf_T	*buf,
@@ -3169,7 +3227,7 @@ ml_append_int(
 
 #ifdef FEAT_BYTEOFF
     /* The line was inserted below 'lnum' */
-    ml_updatechunk(buf, lnum + 1, (long)len, ML_CHNK_ADDLINE);
+    ml_updatechunk(buf, lnum + 1, (long)len, 1L, ML_CHNK_ADDLINE);
 #endif
 #ifdef FEAT_NETBEANS_INTG
     if (netbeans_active())
@@ -3193,6 +3251,120 @@ theend:
     return ret;
 }
 
+/*
+ * Append as many of the "count" lines in "lines" after "lnum" as fit in the
+ * data block that "lnum" is in.  The text of the following lines is moved
+ * only once.
+ * Returns the number of lines appended, zero when nothing was done and
+ * ml_append_int() is to be used, -1 for failure.
+ */
+    static long
+ml_append_block(
+    buf_T	*buf,
+    linenr_T	lnum,
+    char_u	**lines,
+    colnr_T	*lens,
+    long	count,
+    int		newfile)
+{
+    bhdr_T	*hp;
+    DATA_BL	*dp;
+    int		db_idx;
+    int		line_count;	/* number of lines in the block */
+    int		offset;
+    int		len;
+    int		total = 0;	/* size of the text of the new lines */
+    long	n;
+    long	i;
+
+    if (lnum > buf->b_ml.ml_line_count || buf->b_ml.ml_mfp == NULL)
+	return -1;  /* lnum out of range */
+
+    /* Text properties and netbeans need to see every line. */
+#ifdef FEAT_TEXT_PROP
+    if (buf->b_has_textprop)
+	return 0;
+#endif
+#ifdef FEAT_NETBEANS_INTG
+    if (netbeans_active())
+	return 0;
+#endif
+
+    if ((hp = ml_find_line(buf, lnum == 0 ? (linenr_T)1 : lnum,
+							    ML_FIND)) == NULL)
+	return -1;
+    dp = (DATA_BL *)(hp->bh_data);
+    if (lnum == 0)
+	db_idx = -1;		/* careful, it is negative! */
+    else
+	db_idx = lnum - buf->b_ml.ml_locked_low;
+    line_count = buf->b_ml.ml_locked_high - buf->b_ml.ml_locked_low + 1;
+
+    /* Count the lines that fit in the free space. */
+    for (n = 0; n < count; ++n)
+    {
+	len = (lens == NULL || lens[n] == 0)
+				    ? (int)STRLEN(lines[n]) + 1 : (int)lens[n];
+	if (total + len + (n + 1) * INDEX_SIZE > (long)dp->db_free)
+	    break;
+	total += len;
+    }
+    if (n == 0)
+	return 0;
+
+    if (lowest_marked && lowest_marked > lnum)
+	lowest_marked = lnum + 1;
+
+    /*
+     * Move the text of the lines that follow to the front and adjust their
+     * indexes.  Offset is where the text of the new lines ends.
+     */
+    if (db_idx < 0)
+	offset = dp->db_txt_end;
+    else
+	offset = ((dp->db_index[db_idx]) & DB_INDEX_MASK);
+    if (line_count > db_idx + 1)
+    {
+	mch_memmove((char *)dp + dp->db_txt_start - total,
+				  (char *)dp + dp->db_txt_start,
+				  (size_t)(offset - dp->db_txt_start));
+	for (i = line_count - 1; i > db_idx; --i)
+	    dp->db_index[i + n] = dp->db_index[i] - total;
+    }
+    dp->db_txt_start -= total;
+    dp->db_free -= total + n * INDEX_SIZE;
+    dp->db_line_count += n;
+
+    /* copy the text into the block */
+    for (i = 0; i < n; ++i)
+    {
+	len = (lens == NULL || lens[i] == 0)
+				    ? (int)STRLEN(lines[i]) + 1 : (int)lens[i];
+	offset -= len;
+	dp->db_index[db_idx + 1 + i] = offset;
+	mch_memmove((char *)dp + offset, lines[i], (size_t)len);
+    }
+
+    /* The pointer blocks are updated when the block is released. */
+    buf->b_ml.ml_line_count += n;
+    buf->b_ml.ml_locked_high += n;
+    buf->b_ml.ml_locked_lineadd += n;
+    buf->b_ml.ml_flags &= ~ML_EMPTY;
+    buf->b_ml.ml_flags |= ML_LOCKED_DIRTY;
+    if (!newfile)
+	buf->b_ml.ml_flags |= ML_LOCKED_POS;
+
+#ifdef FEAT_BYTEOFF
+    /* The lines were inserted below 'lnum' */
+    ml_updatechunk(buf, lnum + 1, (long)total, n, ML_CHNK_ADDLINE);
+#endif
+#ifdef FEAT_JOB_CHANNEL
+    if (buf->b_write_to_channel)
+	channel_write_new_lines(buf);
+#endif
+    return n;
+}
+
 /*
  * Replace line lnum, with buffering, in current buffer.
  *
@@ -3428,11 +3600,8 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int message)
     bhdr_T	*hp;
     memfile_T	*mfp;
     DATA_BL	*dp;
-    PTR_BL	*pp;
-    infoptr_T	*ip;
     int		count;	    /* number of entries in block */
     int		idx;
-    int		stack_idx;
     int		text_start;
     int		line_start;
     long	line_size;
@@ -3524,48 +3693,8 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int message)
  */
     if (count == 1)
     {
-	mf_free(mfp, hp);	/* free the data block */
-	buf->b_ml.ml_locked = NULL;
-
-	for (stack_idx = buf->b_ml.ml_stack_top - 1; stack_idx >= 0;
-								  --stack_idx)
-	{
-	    buf->b_ml.ml_stack_top = 0;	    /* stack is invalid when failing */
-	    ip = &(buf->b_ml.ml_stack[stack_idx]);
-	    idx = ip->ip_index;
-	    if ((hp = mf_get(mfp, ip->ip_bnum, 1)) == NULL)
-		goto theend;
-	    pp = (PTR_BL *)(hp->bh_data);   /* must be pointer block */
-	    if (pp->pb_id != PTR_ID)
-	    {
-		iemsg(_("E317: pointer block id wrong 4"));
-		mf_put(mfp, hp, FALSE, FALSE);
-		goto theend;
-	    }
-	    count = --(pp->pb_count);
-	    if (count == 0)	    /* the pointer block becomes empty! */
-		mf_free(mfp, hp);
-	    else
-	    {
-		if (count != idx)	/* move entries after the deleted one */
-		    mch_memmove(&pp->pb_pointer[idx], &pp->pb_pointer[idx + 1],
-				      (size_t)(count - idx) * sizeof(PTR_EN));
-		mf_put(mfp, hp, TRUE, FALSE);
-
-		buf->b_ml.ml_stack_top = stack_idx;	/* truncate stack */
-		/* fix line count for rest of blocks in the stack */
-		if (buf->b_ml.ml_locked_lineadd != 0)
-		{
-		    ml_lineadd(buf, buf->b_ml.ml_locked_lineadd);
-		    buf->b_ml.ml_stack[buf->b_ml.ml_stack_top].ip_high +=
-						  buf->b_ml.ml_locked_lineadd;
-		}
-		++(buf->b_ml.ml_stack_top);
-
-		break;
-	    }
-	}
-	CHECK(stack_idx < 0, _("deleted block 1?"));
+	if (ml_delete_data_block(buf, hp) == FAIL)
+	    goto theend;
     }
     else
     {
@@ -3594,7 +3723,7 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int message)
     }
 
 #ifdef FEAT_BYTEOFF
-    ml_updatechunk(buf, lnum, line_size, ML_CHNK_DELLINE);
+    ml_updatechunk(buf, lnum, line_size, 1L, ML_CHNK_DELLINE);
 #endif
     ret = OK;
 
@@ -3613,6 +3742,231 @@ theend:
     return ret;
 }
 
+/*
+ * Free data block "hp", which is ml_locked, and remove the entry pointing to
+ * it from the pointer block.  If this pointer block also becomes empty, we go
+ * up another block, and so on, up to the root if necessary.
+ * The line counts in the pointer blocks on the stack must have been adjusted
+ * by ml_find_line() or be in ml_locked_lineadd.
+ *
+ * return FAIL for failure, OK otherwise
+ */
+    static int
+ml_delete_data_block(buf_T *buf, bhdr_T *hp)
+{
+    memfile_T	*mfp = buf->b_ml.ml_mfp;
+    PTR_BL	*pp;
+    infoptr_T	*ip;
+    int		count;
+    int		idx;
+    int		stack_idx;
+
+    mf_free(mfp, hp);	/* free the data block */
+    buf->b_ml.ml_locked = NULL;
+
+    for (stack_idx = buf->b_ml.ml_stack_top - 1; stack_idx >= 0; --stack_idx)
+    {
+	buf->b_ml.ml_stack_top = 0;	/* stack is invalid when failing */
+	ip = &(buf->b_ml.ml_stack[stack_idx]);
+	idx = ip->ip_index;
+	if ((hp = mf_get(mfp, ip->ip_bnum, 1)) == NULL)
+	    return FAIL;
+	pp = (PTR_BL *)(hp->bh_data);   /* must be pointer block */
+	if (pp->pb_id != PTR_ID)
+	{
+	    iemsg(_("E317: pointer block id wrong 4"));
+	    mf_put(mfp, hp, FALSE, FALSE);
+	    return FAIL;
+	}
+	count = --(pp->pb_count);
+	if (count == 0)	    /* the pointer block becomes empty! */
+	    mf_free(mfp, hp);
+	else
+	{
+	    if (count != idx)	/* move entries after the deleted one */
+		mch_memmove(&pp->pb_pointer[idx], &pp->pb_pointer[idx + 1],
+				      (size_t)(count - idx) * sizeof(PTR_EN));
+	    mf_put(mfp, hp, TRUE, FALSE);
+
+	    buf->b_ml.ml_stack_top = stack_idx;	/* truncate stack */
+	    /* fix line count for rest of blocks in the stack */
+	    if (buf->b_ml.ml_locked_lineadd != 0)
+	    {
+		ml_lineadd(buf, buf->b_ml.ml_locked_lineadd);
+		buf->b_ml.ml_stack[buf->b_ml.ml_stack_top].ip_high +=
+						  buf->b_ml.ml_locked_lineadd;
+	    }
+	    ++(buf->b_ml.ml_stack_top);
+
+	    break;
+	}
+    }
+    CHECK(stack_idx < 0, _("deleted block 1?"));
+    return OK;
+}
+
+/*
+ * Delete "count" lines starting at "lnum" in the current buffer.
+ * Like calling ml_delete() "count" times, but the lines in one data block
+ * are removed at once and a block with only deleted lines is freed.
+ * When "message" is TRUE may give a "No lines in buffer" message.
+ *
+ * Check: The caller of this function should probably also call
+ * deleted_lines() after this.
+ *
+ * return FAIL for failure, OK otherwise
+ */
+    int
+ml_delete_range(linenr_T lnum, long count, int message)
+{
+    long	done;
+
+    ml_flush_line(curbuf);
+    while (count > 0)
+    {
+	done = ml_delete_block(curbuf, lnum, count);
+	if (done < 0)
+	    return FAIL;
+	if (done == 0)
+	{
+	    if (ml_delete_int(curbuf, lnum, message) == FAIL)
+		return FAIL;
+	    done = 1;
+	}
+	count -= done;
+    }
+    return OK;
+}
+
+/*
+ * Delete up to "count" lines starting at "lnum" from the data block that
+ * "lnum" is in.  The last line of the buffer is never deleted.
+ * Returns the number of lines deleted, zero when nothing was done and
+ * ml_delete_int() is to be used, -1 for failure.
+ */
+    static long
+ml_delete_block(buf_T *buf, linenr_T lnum, long count)
+{
+    bhdr_T	*hp;
+    DATA_BL	*dp;
+    int		idx;
+    int		line_count;	/* number of lines in the block */
+    int		text_start;	/* start of the text of the deleted lines */
+    int		text_end;	/* end of the text of the deleted lines */
+    int		size;
+    long	n;
+    long	i;
+#ifdef FEAT_BYTEOFF
+    int		line_start;
+#endif
+
+    if (lnum < 1 || lnum > buf->b_ml.ml_line_count
+					       || buf->b_ml.ml_mfp == NULL)
+	return -1;
+
+    /* Text properties and netbeans need to see every line. */
+#ifdef FEAT_TEXT_PROP
+    if (buf->b_has_textprop)
+	return 0;
+#endif
+#ifdef FEAT_NETBEANS_INTG
+    if (netbeans_active())
+	return 0;
+#endif
+    if (count > buf->b_ml.ml_line_count - 1)
+	count = buf->b_ml.ml_line_count - 1;
+    if (count <= 1)
+	return 0;
+
+    if ((hp = ml_find_line(buf, lnum, ML_FIND)) == NULL)
+	return -1;
+    dp = (DATA_BL *)(hp->bh_data);
+    idx = lnum - buf->b_ml.ml_locked_low;
+    line_count = buf->b_ml.ml_locked_high - buf->b_ml.ml_locked_low + 1;
+    n = line_count - idx;
+    if (n > count)
+	n = count;
+
+    if (lowest_marked && lowest_marked > lnum)
+	lowest_marked = lowest_marked - n > lnum ? lowest_marked - n : lnum;
+
+    if (idx == 0)		/* first line in block, text at the end */
+	text_end = dp->db_txt_end;
+    else
+	text_end = ((dp->db_index[idx - 1]) & DB_INDEX_MASK);
+    text_start = ((dp->db_index[idx + n - 1]) & DB_INDEX_MASK);
+    size = text_end - text_start;
+
+#ifdef FEAT_BYTEOFF
+    /* The lines are deleted one after another at "lnum". */
+    for (i = idx; i < idx + n; ++i)
+    {
+	line_start = ((dp->db_index[i]) & DB_INDEX_MASK);
+	ml_updatechunk(buf, lnum, (long)(text_end - line_start), 1L,
+							    ML_CHNK_DELLINE);
+	text_end = line_start;
+    }
+#endif
+
+    /* The pointer blocks are updated when the block is released. */
+    buf->b_ml.ml_line_count -= n;
+    buf->b_ml.ml_locked_lineadd -= n;
+    if (n == line_count)
+    {
+	/* all lines in the block are deleted */
+	if (ml_delete_data_block(buf, hp) == FAIL)
+	    return -1;
+    }
+    else
+    {
+	/*
+	 * delete the text by moving the next lines forwards
+	 * delete the indexes by moving the next indexes backwards
+	 */
+	mch_memmove((char *)dp + dp->db_txt_start + size,
+				  (char *)dp + dp->db_txt_start,
+				  (size_t)(text_start - dp->db_txt_start));
+	for (i = idx; i < line_count - n; ++i)
+	    dp->db_index[i] = dp->db_index[i + n] + size;
+
+	dp->db_free += size + n * INDEX_SIZE;
+	dp->db_txt_start += size;
+	dp->db_line_count -= n;
+	buf->b_ml.ml_locked_high -= n;
+
+	/*
+	 * mark the block dirty and make sure it is in the file (for recovery)
+	 */
+	buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
+    }
+    return n;
+}
+
+/*
+ * Replace "count" lines starting at "lnum" in the current buffer with the
+ * "newcount" lines in "lines", see ml_append_lines() for "lens".
+ * The new lines are appended before the old ones are deleted, thus the
+ * buffer does not become empty in between.
+ *
+ * Check: The caller of this function should probably also call
+ * changed_lines().
+ *
+ * return FAIL for failure, OK otherwise
+ */
+    int
+ml_replace_range(
+    linenr_T	lnum,
+    long	count,
+    char_u	**lines,
+    colnr_T	*lens,
+    long	newcount)
+{
+    if (newcount > 0 && ml_append_lines(lnum + count - 1, lines, lens,
+						     newcount, FALSE) == FAIL)
+	return FAIL;
+    return ml_delete_range(lnum, count, FALSE);
+}
+
 /*
  * set the DB_MARKED flag for line 'lnum'
  */
@@ -3807,7 +4161,7 @@ ml_flush_line(buf_T *buf)
 		buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
 #ifdef FEAT_BYTEOFF
 		/* The else case is already covered by the insert and delete */
-		ml_updatechunk(buf, lnum, (long)extra, ML_CHNK_UPDLINE);
+		ml_updatechunk(buf, lnum, (long)extra, 1L, ML_CHNK_UPDLINE);
 #endif
 	    }
 	    else
@@ -5241,10 +5595,115 @@ ml_crypt_prepare(memfile_T *mfp, off_T offset, int reading)
 #define MLCS_MAXL 800	/* max no of lines in chunk */
 #define MLCS_MINL 400   /* should be half of MLCS_MAXL */
 
+/*
+ * The ml_chunksize[] array is accompanied by a Fenwick tree, so that the
+ * chunk containing a line or byte offset can be found in logarithmic time.
+ * Entry "i" of ml_chunktree[] (counting from one) holds the sum of the
+ * chunks "i - (i & -i)" up to "i - 1".
+ * Changing the size of a chunk updates the tree.  Inserting or removing a
+ * chunk invalidates it, it is rebuilt when it is used next time.
+ */
+    static int
+ml_chunktree_build(buf_T *buf)
+{
+    chunksize_T	*tree = buf->b_ml.ml_chunktree;
+    int		used = buf->b_ml.ml_usedchunks;
+    int		i;
+    int		j;
+
+    if (tree == NULL)
+	return FAIL;
+    for (i = 1; i <= used; ++i)
+	tree[i] = buf->b_ml.ml_chunksize[i - 1];
+    for (i = 1; i <= used; ++i)
+    {
+	j = i + (i & -i);
+	if (j <= used)
+	{
+	    tree[j].mlcs_numlines += tree[i].mlcs_numlines;
+	    tree[j].mlcs_totalsize += tree[i].mlcs_totalsize;
+	}
+    }
+    buf->b_ml.ml_chunktree_valid = TRUE;
+    return OK;
+}
+
+/*
+ * Add "lines" and "size" to chunk "idx" in the Fenwick tree.  Does nothing
+ * when the tree is to be rebuilt anyway.
+ */
+    static void
+ml_chunktree_add(buf_T *buf, int idx, long lines, long size)
+{
+    int	    i;
+
+    if (!buf->b_ml.ml_chunktree_valid)
+	return;
+    for (i = idx + 1; i <= buf->b_ml.ml_usedchunks; i += i & -i)
+    {
+	buf->b_ml.ml_chunktree[i].mlcs_numlines += lines;
+	buf->b_ml.ml_chunktree[i].mlcs_totalsize += size;
+    }
+}
+
+/*
+ * Find the chunk containing line "lnum" (when not zero) or byte "offset"
+ * (when not zero).  With "ffdos" count a CR for every line in "offset".
+ * The last chunk always qualifies.
+ * Sets "*linep" to the first line in the chunk and "*sizep" to the number of
+ * bytes before the chunk, including CRs if "offset" and "ffdos" are set.
+ * Returns the index of the chunk, -1 if the tree can't be built.
+ */
+    static int
+ml_find_chunk(
+    buf_T	*buf,
+    linenr_T	lnum,
+    long	offset,
+    int		ffdos,
+    linenr_T	*linep,
+    long	*sizep)
+{
+    chunksize_T	*tree = buf->b_ml.ml_chunktree;
+    int		last = buf->b_ml.ml_usedchunks - 1;
+    int		idx = 0;
+    int		next;
+    int		step;
+    long	lines = 0;
+    long	size = 0;
+
+    if (!buf->b_ml.ml_chunktree_valid && ml_chunktree_build(buf) == FAIL)
+	return -1;
+
+    for (step = 1; step * 2 <= last; step *= 2)
+	;
+    for ( ; step > 0; step /= 2)
+    {
+	next = idx + step;
+	if (next > last)
+	    continue;
+	if ((lnum != 0 && lines + tree[next].mlcs_numlines < lnum)
+		|| (offset != 0 && size + tree[next].mlcs_totalsize
+			+ ffdos * (lines + tree[next].mlcs_numlines) < offset))
+	{
+	    idx = next;
+	    lines += tree[next].mlcs_numlines;
+	    size += tree[next].mlcs_totalsize;
+	}
+    }
+
+    *linep = (linenr_T)lines + 1;
+    *sizep = size;
+    if (offset != 0 && ffdos)
+	*sizep += lines;
+    return idx;
+}
+
 /*
  * Keep information for finding byte offset of a line, updtype may be one of:
  * ML_CHNK_ADDLINE: Add len to parent chunk, possibly splitting it
  *	   Careful: ML_CHNK_ADDLINE may cause ml_find_line() to be called.
+ *	   "lines" lines starting at "line" were added, "len" is their total
+ *	   size.  They must all be in the buffer already.
  * ML_CHNK_DELLINE: Subtract len from parent chunk, possibly deleting it
  * ML_CHNK_UPDLINE: Add len to parent chunk, as a signed entity.
  */
@@ -5253,6 +5712,7 @@ ml_updatechunk(
     buf_T	*buf,
     linenr_T	line,
     long	len,
+    long	lines,
     int		updtype)
 {
     static buf_T	*ml_upd_lastbuf = NULL;
@@ -5274,8 +5734,12 @@ ml_updatechunk(
     {
 	buf->b_ml.ml_chunksize = (chunksize_T *)
 				  alloc((unsigned)sizeof(chunksize_T) * 100);
-	if (buf->b_ml.ml_chunksize == NULL)
+	buf->b_ml.ml_chunktree = (chunksize_T *)
+				  alloc((unsigned)sizeof(chunksize_T) * 101);
+	if (buf->b_ml.ml_chunksize == NULL || buf->b_ml.ml_chunktree == NULL)
 	{
+	    VIM_CLEAR(buf->b_ml.ml_chunksize);
+	    VIM_CLEAR(buf->b_ml.ml_chunktree);
 	    buf->b_ml.ml_usedchunks = -1;
 	    return;
 	}
@@ -5283,6 +5747,7 @@ ml_updatechunk(
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = 1;
+	buf->b_ml.ml_chunktree_valid = FALSE;
     }
 
     if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1)
@@ -5293,6 +5758,7 @@ ml_updatechunk(
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = (long)buf->b_ml.ml_line_len;
+	buf->b_ml.ml_chunktree_valid = FALSE;
 	return;
     }
 
@@ -5303,12 +5769,11 @@ ml_updatechunk(
     if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
 	    || updtype != ML_CHNK_ADDLINE)
     {
-	for (curline = 1, curix = 0;
-	     curix < buf->b_ml.ml_usedchunks - 1
-	     && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	     curix++)
+	curix = ml_find_chunk(buf, line, 0L, FALSE, &curline, &size);
+	if (curix < 0)
 	{
-	    curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
+	    buf->b_ml.ml_usedchunks = -1;
+	    return;
 	}
     }
     else if (curix < buf->b_ml.ml_usedchunks - 1
@@ -5325,21 +5790,29 @@ ml_updatechunk(
     curchnk->mlcs_totalsize += len;
     if (updtype == ML_CHNK_ADDLINE)
     {
-	curchnk->mlcs_numlines++;
+	curchnk->mlcs_numlines += lines;
+	ml_chunktree_add(buf, curix, lines, len);
+	line += lines - 1;
 
 	/* May resize here so we don't have to do it in both cases below */
 	if (buf->b_ml.ml_usedchunks + 1 >= buf->b_ml.ml_numchunks)
 	{
-	    chunksize_T *t_chunksize = buf->b_ml.ml_chunksize;
+	    chunksize_T *t_chunksize;
 
 	    buf->b_ml.ml_numchunks = buf->b_ml.ml_numchunks * 3 / 2;
-	    buf->b_ml.ml_chunksize = (chunksize_T *)
-		vim_realloc(buf->b_ml.ml_chunksize,
-			    sizeof(chunksize_T) * buf->b_ml.ml_numchunks);
-	    if (buf->b_ml.ml_chunksize == NULL)
+	    t_chunksize = (chunksize_T *)vim_realloc(buf->b_ml.ml_chunksize,
+				sizeof(chunksize_T) * buf->b_ml.ml_numchunks);
+	    if (t_chunksize != NULL)
+		buf->b_ml.ml_chunksize = t_chunksize;
+	    vim_free(buf->b_ml.ml_chunktree);
+	    buf->b_ml.ml_chunktree = (chunksize_T *)alloc((unsigned)
+			   sizeof(chunksize_T) * (buf->b_ml.ml_numchunks + 1));
+	    buf->b_ml.ml_chunktree_valid = FALSE;
+	    if (t_chunksize == NULL || buf->b_ml.ml_chunktree == NULL)
 	    {
 		/* Hmmmm, Give up on offset for this buffer */
-		vim_free(t_chunksize);
+		VIM_CLEAR(buf->b_ml.ml_chunksize);
+		VIM_CLEAR(buf->b_ml.ml_chunktree);
 		buf->b_ml.ml_usedchunks = -1;
 		return;
 	    }
@@ -5412,6 +5885,7 @@ ml_updatechunk(
 	    buf->b_ml.ml_chunksize[curix].mlcs_totalsize = size;
 	    buf->b_ml.ml_chunksize[curix + 1].mlcs_totalsize -= size;
 	    buf->b_ml.ml_usedchunks++;
+	    buf->b_ml.ml_chunktree_valid = FALSE;
 	    ml_upd_lastbuf = NULL;   /* Force recalc of curix & curline */
 	    return;
 	}
@@ -5425,6 +5899,7 @@ ml_updatechunk(
 	     */
 	    curchnk = buf->b_ml.ml_chunksize + curix + 1;
 	    buf->b_ml.ml_usedchunks++;
+	    buf->b_ml.ml_chunktree_valid = FALSE;
 	    if (line == buf->b_ml.ml_line_count)
 	    {
 		curchnk->mlcs_numlines = 0;
@@ -5459,6 +5934,7 @@ ml_updatechunk(
     else if (updtype == ML_CHNK_DELLINE)
     {
 	curchnk->mlcs_numlines--;
+	ml_chunktree_add(buf, curix, -1L, len);
 	ml_upd_lastbuf = NULL;   /* Force recalc of curix & curline */
 	if (curix < (buf->b_ml.ml_usedchunks - 1)
 		&& (curchnk->mlcs_numlines + curchnk[1].mlcs_numlines)
@@ -5470,6 +5946,7 @@ ml_updatechunk(
 	else if (curix == 0 && curchnk->mlcs_numlines <= 0)
 	{
 	    buf->b_ml.ml_usedchunks--;
+	    buf->b_ml.ml_chunktree_valid = FALSE;
 	    mch_memmove(buf->b_ml.ml_chunksize, buf->b_ml.ml_chunksize + 1,
 			buf->b_ml.ml_usedchunks * sizeof(chunksize_T));
 	    return;
@@ -5485,6 +5962,7 @@ ml_updatechunk(
 	curchnk[-1].mlcs_numlines += curchnk->mlcs_numlines;
 	curchnk[-1].mlcs_totalsize += curchnk->mlcs_totalsize;
 	buf->b_ml.ml_usedchunks--;
+	buf->b_ml.ml_chunktree_valid = FALSE;
 	if (curix < buf->b_ml.ml_usedchunks)
 	{
 	    mch_memmove(buf->b_ml.ml_chunksize + curix,
@@ -5494,6 +5972,8 @@ ml_updatechunk(
 	}
 	return;
     }
+    else
+	ml_chunktree_add(buf, curix, 0L, len);
     ml_upd_lastbuf = buf;
     ml_upd_lastline = line;
     ml_upd_lastcurline = curline;
@@ -5510,7 +5990,6 @@ ml_updatechunk(
 ml_find_line_or_offset(buf_T *buf, linenr_T lnum, long *offp)
 {
     linenr_T	curline;
-    int		curix;
     long	size;
     bhdr_T	*hp;
     DATA_BL	*dp;
@@ -5538,24 +6017,11 @@ ml_find_line_or_offset(buf_T *buf, linenr_T lnum, long *offp)
     if (lnum == 0 && offset <= 0)
 	return 1;   /* Not a "find offset" and offset 0 _must_ be in line 1 */
     /*
-     * Find the last chunk before the one containing our line. Last chunk is
-     * special because it will never qualify
+     * Find the chunk containing our line.  Last chunk is special because it
+     * will always qualify.
      */
-    curline = 1;
-    curix = size = 0;
-    while (curix < buf->b_ml.ml_usedchunks - 1
-	    && ((lnum != 0
-	     && lnum >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
-		|| (offset != 0
-	       && offset > size + buf->b_ml.ml_chunksize[curix].mlcs_totalsize
-		      + ffdos * buf->b_ml.ml_chunksize[curix].mlcs_numlines)))
-    {
-	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	size += buf->b_ml.ml_chunksize[curix].mlcs_totalsize;
-	if (offset && ffdos)
-	    size += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	curix++;
-    }
+    if (ml_find_chunk(buf, lnum, offset, ffdos, &curline, &size) < 0)
+	return -1;
 
     while ((lnum != 0 && curline < lnum) || (offset != 0 && size < offset))
     {
@@ -0,0 +1,336 @@
+/* vi:set ts=8 sts=4 sw=4 noet:
+ *
+ * VIM - Vi IMproved	by Bram Moolenaar
+ *
+ * Do ":help uganda"  in Vim to read copying and usage conditions.
+ * Do ":help credits" in Vim to see a list of people who contributed.
+ * See README.txt for an overview of the Vim source code.
+ */
+
+/*
+ * memline_test.c: Unittests for memline.c
+ */
+
+#undef NDEBUG
+#include <assert.h>
+
+/* Must include main.c because it contains much more than just main() */
+#define NO_VIM_MAIN
+#include "main.c"
+
+/* This file has to be included because the tested functions are static */
+#include "memline.c"
+
+#define TEST_LINES	10000000L   /* number of lines in the test buffer */
+#define TEST_QUERIES	10000L	    /* number of random offset queries */
+#define TEST_EDITS	10000L	    /* number of lines inserted at the top */
+#define EDIT_LEN	5	    /* length of the inserted lines */
+
+#ifdef FEAT_BYTEOFF
+static long_u test_seed = 1;
+
+/*
+ * Simple pseudo random number generator, the test must be repeatable.
+ */
+    static long
+test_random(long max)
+{
+    test_seed = test_seed * 1103515245 + 12345;
+    return (long)((test_seed >> 16) % (long_u)max);
+}
+
+/*
+ * Length of the text of line "lnum" in the test buffer, excluding the NUL.
+ */
+#define TEST_LINE_LEN(lnum) ((int)((lnum) % 10))
+
+/*
+ * Return the byte offset of line "lnum" in the test buffer, before it was
+ * edited.  "ffdos" is TRUE for 'fileformat' "dos".
+ */
+    static long
+test_offset(linenr_T lnum, int ffdos)
+{
+    long    n = lnum - 1;
+    long    full = n / 10;
+    long    rest = n % 10;
+
+    return n * (1 + ffdos) + full * 45 + rest * (rest + 1) / 2;
+}
+
+/*
+ * Return the byte offset of line "lnum" after TEST_EDITS lines were inserted
+ * below line 1.
+ */
+    static long
+test_offset_edited(linenr_T lnum, int ffdos)
+{
+    if (lnum <= 2)
+	return test_offset(lnum, ffdos);
+    if (lnum <= TEST_EDITS + 2)
+	return test_offset(2, ffdos) + (lnum - 2) * (EDIT_LEN + 1 + ffdos);
+    return test_offset(lnum - TEST_EDITS, ffdos)
+				       + TEST_EDITS * (EDIT_LEN + 1 + ffdos);
+}
+
+/*
+ * Check the offsets of random lines and the lines of random offsets.
+ */
+    static void
+test_queries(int ffdos, int edited)
+{
+    long	i;
+    linenr_T	lnum;
+    long	expected;
+    long	off;
+    int		col;
+
+    for (i = 0; i < TEST_QUERIES; ++i)
+    {
+	lnum = test_random(curbuf->b_ml.ml_line_count) + 1;
+	expected = edited ? test_offset_edited(lnum, ffdos)
+						   : test_offset(lnum, ffdos);
+	assert(ml_find_line_or_offset(curbuf, lnum, NULL) == expected);
+
+	/* The column returned for the first byte of a line is unreliable, only
+	 * check offsets inside the line. */
+	col = (int)STRLEN(ml_get(lnum));
+	if (col < 2)
+	    continue;
+	col = test_random(col - 1) + 1;
+	off = expected + col;
+	assert(ml_find_line_or_offset(curbuf, (linenr_T)0, &off) == lnum);
+	assert(off == col);
+    }
+}
+
+/*
+ * Test ml_find_line_or_offset() and ml_updatechunk() on a large buffer.
+ */
+    static void
+test_byteoff(void)
+{
+    linenr_T	lnum;
+    long	i;
+    elapsed_T	start;
+
+    cmdmod.noswapfile = TRUE;
+    assert(ml_open(curbuf) == OK);
+
+    ELAPSED_INIT(start);
+    for (lnum = 1; lnum <= TEST_LINES; ++lnum)
+	assert(ml_append(lnum - 1,
+		   (char_u *)"abcdefghi" + 9 - TEST_LINE_LEN(lnum), 0, FALSE)
+									== OK);
+    /* delete the empty line that was in the buffer */
+    ml_delete(curbuf->b_ml.ml_line_count, FALSE);
+    assert(curbuf->b_ml.ml_line_count == TEST_LINES);
+    printf("appending %ld lines: %ld msec\n", TEST_LINES,
+							ELAPSED_FUNC(start));
+
+    /* total size of the buffer */
+    assert(ml_find_line_or_offset(curbuf, TEST_LINES + 1, NULL)
+					 == test_offset(TEST_LINES + 1, FALSE));
+
+    ELAPSED_INIT(start);
+    test_queries(FALSE, FALSE);
+    printf("%ld offset queries: %ld msec\n", TEST_QUERIES * 2,
+							ELAPSED_FUNC(start));
+
+    set_fileformat(EOL_DOS, OPT_LOCAL);
+    test_queries(TRUE, FALSE);
+    set_fileformat(EOL_UNIX, OPT_LOCAL);
+
+    /* Insert lines near the top, with a query in between, like when the
+     * byte count is in the statusline. */
+    ELAPSED_INIT(start);
+    for (i = 1; i <= TEST_EDITS; ++i)
+    {
+	assert(ml_append(1, (char_u *)"abcde", 0, FALSE) == OK);
+	assert(ml_find_line_or_offset(curbuf, TEST_LINES, NULL)
+				 == test_offset(TEST_LINES - i, FALSE)
+						     + i * (EDIT_LEN + 1));
+    }
+    printf("inserting %ld lines at the top: %ld msec\n", TEST_EDITS,
+							ELAPSED_FUNC(start));
+    test_queries(FALSE, TRUE);
+
+    /* Change the inserted lines, this only changes the size. */
+    for (lnum = 2; lnum < TEST_EDITS + 2; ++lnum)
+	assert(ml_replace(lnum, (char_u *)"vwxyz", TRUE) == OK);
+    test_queries(FALSE, TRUE);
+
+    /* Delete the inserted lines again. */
+    ELAPSED_INIT(start);
+    for (i = 0; i < TEST_EDITS; ++i)
+	assert(ml_delete(2, FALSE) == OK);
+    printf("deleting %ld lines at the top: %ld msec\n", TEST_EDITS,
+							ELAPSED_FUNC(start));
+    assert(curbuf->b_ml.ml_line_count == TEST_LINES);
+    test_queries(FALSE, FALSE);
+
+    ml_close(curbuf, TRUE);
+}
+#endif
+
+#define BULK_LINES	100000L	    /* number of lines in the bulk test */
+
+static long	bulk_ids[BULK_LINES * 2];   /* ids of the lines in the buffer */
+static long	bulk_count = 0;		    /* number of ids in bulk_ids[] */
+static long	bulk_next_id = 0;
+
+/*
+ * Put the text for line "id" in "buf" followed by a NL, the length varies.
+ * Returns the length including the NL.
+ */
+    static int
+test_bulk_text(long id, char_u *buf)
+{
+    sprintf((char *)buf, "%ld:%.*s\n", id, (int)(id % 37),
+				      "abcdefghijklmnopqrstuvwxyzabcdefghijk");
+    return (int)STRLEN(buf);
+}
+
+/*
+ * Append "count" new lines after "lnum" with ml_append_lines(), in one block
+ * of text with a NUL after each line, like readfile() does.
+ */
+    static void
+test_bulk_append(linenr_T lnum, long count)
+{
+    char_u	*text = alloc((unsigned)(count * 50));
+    char_u	**lines = (char_u **)alloc((unsigned)(count * sizeof(char_u *)));
+    colnr_T	*lens = (colnr_T *)alloc((unsigned)(count * sizeof(colnr_T)));
+    char_u	*p = text;
+    long	i;
+
+    for (i = 0; i < count; ++i)
+    {
+	lines[i] = p;
+	lens[i] = test_bulk_text(bulk_next_id + i, p);
+	p[lens[i] - 1] = NUL;
+	p += lens[i];
+    }
+    assert(ml_append_lines(lnum, lines, lens, count, FALSE) == OK);
+
+    mch_memmove(bulk_ids + lnum + count, bulk_ids + lnum,
+				  (size_t)(bulk_count - lnum) * sizeof(long));
+    for (i = 0; i < count; ++i)
+	bulk_ids[lnum + i] = bulk_next_id + i;
+    bulk_count += count;
+    bulk_next_id += count;
+
+    vim_free(text);
+    vim_free(lines);
+    vim_free(lens);
+}
+
+/*
+ * Delete "count" lines at "lnum" with ml_delete_range().
+ */
+    static void
+test_bulk_delete(linenr_T lnum, long count)
+{
+    assert(ml_delete_range(lnum, count, FALSE) == OK);
+    mch_memmove(bulk_ids + lnum - 1, bulk_ids + lnum - 1 + count,
+			  (size_t)(bulk_count - lnum + 1 - count) * sizeof(long));
+    bulk_count -= count;
+}
+
+/*
+ * Check that the buffer contains the lines in bulk_ids[].
+ */
+    static void
+test_bulk_check(void)
+{
+    char_u	buf[100];
+    linenr_T	lnum;
+    int		len;
+#ifdef FEAT_BYTEOFF
+    long	offset = 0;
+#endif
+
+    assert(curbuf->b_ml.ml_line_count == bulk_count);
+    for (lnum = 1; lnum <= bulk_count; ++lnum)
+    {
+	len = test_bulk_text(bulk_ids[lnum - 1], buf);
+	buf[len - 1] = NUL;
+	assert(STRCMP(ml_get(lnum), buf) == 0);
+#ifdef FEAT_BYTEOFF
+	assert(ml_find_line_or_offset(curbuf, lnum, NULL) == offset);
+	offset += len;
+#endif
+    }
+#ifdef FEAT_BYTEOFF
+    assert(ml_find_line_or_offset(curbuf, bulk_count + 1, NULL) == offset);
+#endif
+}
+
+/*
+ * Test ml_append_lines(), ml_delete_range() and ml_replace_range().
+ */
+    static void
+test_bulk(void)
+{
+    char_u	*lines[3];
+
+    cmdmod.noswapfile = TRUE;
+    assert(ml_open(curbuf) == OK);
+
+    /* Fill the buffer, then remove the empty line that was in it. */
+    test_bulk_append(0, BULK_LINES);
+    bulk_ids[bulk_count++] = -1;
+    assert(ml_delete(curbuf->b_ml.ml_line_count, FALSE) == OK);
+    --bulk_count;
+    test_bulk_check();
+
+    /* Insert in the middle, at the start and at the end. */
+    test_bulk_append(5000, 3000);
+    test_bulk_append(0, 10);
+    test_bulk_append(curbuf->b_ml.ml_line_count, 1000);
+    test_bulk_check();
+
+    /* Delete ranges that span several blocks, at the start, in the middle
+     * and at the end. */
+    test_bulk_delete(100, 70000);
+    test_bulk_delete(1, 50);
+    test_bulk_delete(3, 1);
+    test_bulk_delete(curbuf->b_ml.ml_line_count - 9, 10);
+    test_bulk_check();
+
+    /* Replace a range with more and with fewer lines. */
+    lines[0] = (char_u *)"0:";
+    lines[1] = (char_u *)"1:a";
+    lines[2] = (char_u *)"2:ab";
+    assert(ml_replace_range(200, 500, lines, NULL, 3L) == OK);
+    mch_memmove(bulk_ids + 202, bulk_ids + 699,
+			       (size_t)(bulk_count - 699) * sizeof(long));
+    bulk_ids[199] = 0;
+    bulk_ids[200] = 1;
+    bulk_ids[201] = 2;
+    bulk_count -= 497;
+    test_bulk_check();
+
+    /* Delete everything, one empty line remains. */
+    assert(ml_delete_range(1, curbuf->b_ml.ml_line_count, FALSE) == OK);
+    assert(curbuf->b_ml.ml_line_count == 1);
+    assert(curbuf->b_ml.ml_flags & ML_EMPTY);
+    assert(*ml_get(1) == NUL);
+
+    ml_close(curbuf, TRUE);
+}
+
+    int
+main(int argc, char **argv)
+{
+    vim_memset(&params, 0, sizeof(params));
+    params.argc = argc;
+    params.argv = argv;
+    common_init(&params);
+
+#ifdef FEAT_BYTEOFF
+    test_byteoff();
+#endif
+    test_bulk();
+    return 0;
+}
@@ -2705,17 +2705,15 @@ del_lines(
     if (undo && u_savedel(first, nlines) == FAIL)
 	return;
 
-    for (n = 0; n < nlines; )
+    if (curbuf->b_ml.ml_flags & ML_EMPTY)	    /* nothing to delete */
+	n = 0;
+    else
     {
-	if (curbuf->b_ml.ml_flags & ML_EMPTY)	    /* nothing to delete */
-	    break;
-
-	ml_delete(first, TRUE);
-	++n;
-
 	/* If we delete the last line in the file, stop */
-	if (first > curbuf->b_ml.ml_line_count)
-	    break;
+	n = curbuf->b_ml.ml_line_count - first + 1;
+	if (n > nlines)
+	    n = nlines;
+	ml_delete_range(first, n, TRUE);
     }
 
     /* Correct the cursor position before calling deleted_lines_mark(), it may
@@ -1219,6 +1219,9 @@ free_all_mem(void)
 
     /* highlight info */
     free_highlight();
+# ifdef FEAT_SYN_HL
+    syn_cache_clear();
+# endif
 
     reset_last_sourcing();
 
@@ -4464,6 +4467,10 @@ parse_queued_messages(void)
 # endif
 # ifdef FEAT_TERMINAL
 	free_unused_terminals();
+# endif
+# ifdef USE_ASYNC_WRITE
+	// Finish files written with ":write ++async".
+	async_write_check();
 # endif
 	break;
     }
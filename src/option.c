@@ -2231,6 +2231,13 @@ static struct vimoption options[] =
     {"redraw",	    NULL,   P_BOOL|P_VI_DEF,
 			    (char_u *)NULL, PV_NONE,
 			    {(char_u *)FALSE, (char_u *)0L} SCTX_INIT},
+    {"redrawrate",  "rdr",  P_NUM|P_VI_DEF,
+#ifdef FEAT_TIMERS
+			    (char_u *)&p_rdr, PV_NONE,
+#else
+			    (char_u *)NULL, PV_NONE,
+#endif
+			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
     {"redrawtime",  "rdt",  P_NUM|P_VI_DEF,
 #ifdef FEAT_RELTIME
 			    (char_u *)&p_rdt, PV_NONE,
@@ -2600,6 +2607,20 @@ static struct vimoption options[] =
     {"switchbuf",   "swb",  P_STRING|P_VI_DEF|P_ONECOMMA|P_NODUP,
 			    (char_u *)&p_swb, PV_NONE,
 			    {(char_u *)"", (char_u *)0L} SCTX_INIT},
+    {"syncache",    "syc",  P_BOOL|P_VI_DEF,
+#ifdef FEAT_SYN_HL
+			    (char_u *)&p_syc, PV_NONE,
+#else
+			    (char_u *)NULL, PV_NONE,
+#endif
+			    {(char_u *)FALSE, (char_u *)0L} SCTX_INIT},
+    {"synidlemem",  "sim",  P_NUM|P_VI_DEF,
+#ifdef FEAT_SYN_HL
+			    (char_u *)&p_sim, PV_NONE,
+#else
+			    (char_u *)NULL, PV_NONE,
+#endif
+			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
     {"synmaxcol",   "smc",  P_NUM|P_VI_DEF|P_RBUF,
 #ifdef FEAT_SYN_HL
 			    (char_u *)&p_smc, PV_SMC,
@@ -2915,6 +2936,13 @@ static struct vimoption options[] =
 			    {(char_u *)0L, (char_u *)0L}
 #endif
 			    SCTX_INIT},
+    {"vimgrepjobs", "vgj",  P_NUM|P_VI_DEF,
+#ifdef FEAT_QUICKFIX
+			    (char_u *)&p_vgj, PV_NONE,
+#else
+			    (char_u *)NULL, PV_NONE,
+#endif
+			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
     {"viminfo",	    "vi",   P_STRING|P_ONECOMMA|P_NODUP|P_SECURE,
 #ifdef FEAT_VIMINFO
 			    (char_u *)&p_viminfo, PV_NONE,
@@ -3089,6 +3117,7 @@ static struct vimoption options[] =
     p_term("t_bc", T_BC)
     p_term("t_BE", T_BE)
     p_term("t_BD", T_BD)
+    p_term("t_BS", T_BS)
     p_term("t_cd", T_CD)
     p_term("t_ce", T_CE)
     p_term("t_cl", T_CL)
@@ -3105,6 +3134,7 @@ static struct vimoption options[] =
     p_term("t_dl", T_DL)
     p_term("t_EC", T_CEC)
     p_term("t_EI", T_CEI)
+    p_term("t_ES", T_ES)
     p_term("t_fs", T_FS)
     p_term("t_GP", T_CGP)
     p_term("t_IE", T_CIE)
@@ -7690,8 +7720,8 @@ did_set_string_option(
 	    ++syn_recursive;
 	    // Only pass TRUE for "force" when the value changed or not used
 	    // recursively, to avoid endless recurrence.
-	    apply_autocmds(EVENT_SYNTAX, curbuf->b_p_syn, curbuf->b_fname,
-		    value_changed || syn_recursive == 1, curbuf);
+	    syn_apply_autocmds(curbuf->b_p_syn,
+					 value_changed || syn_recursive == 1);
 	    --syn_recursive;
 	}
 #endif
@@ -8652,6 +8682,15 @@ set_bool_option(
     }
 #endif
 
+#ifdef FEAT_SYN_HL
+    /* When 'syncache' is reset forget the cached syntax items. */
+    else if ((int *)varp == &p_syc)
+    {
+	if (!p_syc)
+	    syn_cache_clear();
+    }
+#endif
+
 #ifdef FEAT_AUTOCHDIR
     else if ((int *)varp == &p_acd)
     {
@@ -9330,6 +9369,20 @@ set_num_option(
 	errmsg = e_positive;
 	p_report = 1;
     }
+#ifdef FEAT_QUICKFIX
+    if (p_vgj < 0)
+    {
+	errmsg = e_positive;
+	p_vgj = 0;
+    }
+#endif
+#ifdef FEAT_SYN_HL
+    if (p_sim < 0)
+    {
+	errmsg = e_positive;
+	p_sim = 0;
+    }
+#endif
     if ((p_sj < -100 || p_sj >= Rows) && full_screen)
     {
 	if (Rows != old_Rows)	/* Rows changed, just adjust p_sj */
@@ -9367,6 +9420,13 @@ set_num_option(
 	errmsg = e_positive;
 	p_ss = 0;
     }
+#ifdef FEAT_TIMERS
+    if (p_rdr < 0)
+    {
+	errmsg = e_positive;
+	p_rdr = 0;
+    }
+#endif
 
     /* May set global value for local option. */
     if ((opt_flags & (OPT_LOCAL | OPT_GLOBAL)) == 0)
@@ -11001,6 +11061,18 @@ get_equalprg(void)
     return curbuf->b_p_ep;
 }
 
+#if defined(FEAT_QUICKFIX) || defined(PROTO)
+/*
+ * Return TRUE if 'iskeyword' of buffer "buf" is the global value, which a new
+ * buffer gets.
+ */
+    int
+buf_isk_is_global(buf_T *buf)
+{
+    return STRCMP(buf->b_p_isk, p_isk) == 0;
+}
+#endif
+
 /*
  * Copy options from one window to another.
  * Used when splitting a window.
@@ -678,6 +678,9 @@ EXTERN char_u	*p_pyhome;	/* 'pythonhome' */
 #if defined(FEAT_PYTHON) || defined(FEAT_PYTHON3)
 EXTERN long	p_pyx;		/* 'pyxversion' */
 #endif
+#ifdef FEAT_TIMERS
+EXTERN long	p_rdr;		/* 'redrawrate' */
+#endif
 #ifdef FEAT_RELTIME
 EXTERN long	p_rdt;		/* 'redrawtime' */
 #endif
@@ -798,6 +801,10 @@ static char *(p_swb_values[]) = {"useopen", "usetab", "split", "newtab", "vsplit
 #define SWB_SPLIT		0x004
 #define SWB_NEWTAB		0x008
 #define SWB_VSPLIT		0x010
+#ifdef FEAT_SYN_HL
+EXTERN int	p_syc;		/* 'syncache' */
+EXTERN long	p_sim;		/* 'synidlemem' */
+#endif
 EXTERN int	p_tbs;		/* 'tagbsearch' */
 EXTERN char_u	*p_tc;		/* 'tagcase' */
 EXTERN unsigned tc_flags;       /* flags from 'tagcase' */
@@ -899,6 +906,9 @@ EXTERN char_u	*p_vdir;	/* 'viewdir' */
 EXTERN char_u	*p_vop;		/* 'viewoptions' */
 EXTERN unsigned	vop_flags;	/* uses SSOP_ flags */
 #endif
+#ifdef FEAT_QUICKFIX
+EXTERN long	p_vgj;		/* 'vimgrepjobs' */
+#endif
 EXTERN int	p_vb;		/* 'visualbell' */
 EXTERN char_u	*p_ve;		/* 'virtualedit' */
 EXTERN unsigned ve_flags;
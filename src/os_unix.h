@@ -169,6 +169,13 @@
 # define HAVE_TOTAL_MEM
 #endif
 
+/* Linux: use inotify to find out which files changed, instead of using
+ * stat() on the file of every buffer when checking timestamps. */
+#if defined(__linux__) && defined(HAVE_SYS_INOTIFY_H) \
+	&& defined(HAVE_INOTIFY_INIT1) && defined(HAVE_SYS_STATFS_H)
+# define USE_INOTIFY
+#endif
+
 
 #ifndef PROTO
 
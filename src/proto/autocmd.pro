@@ -3,6 +3,7 @@ void aubuflocal_remove(buf_T *buf);
 int au_has_group(char_u *name);
 void do_augroup(char_u *arg, int del_group);
 void free_all_autocmds(void);
+int event_ignored(event_T event);
 int check_ei(void);
 char_u *au_event_disable(char *what);
 void au_event_restore(char_u *old_ei);
@@ -31,6 +32,7 @@ void unblock_autocmds(void);
 int is_autocmd_blocked(void);
 char_u *getnextac(int c, void *cookie, int indent);
 int has_autocmd(event_T event, char_u *sfname, buf_T *buf);
+int has_read_autocmd(char_u *sfname);
 char_u *get_augroup_name(expand_T *xp, int idx);
 char_u *set_context_in_autocmd(expand_T *xp, char_u *arg, int doautocmd);
 char_u *get_event_name(expand_T *xp, int idx);
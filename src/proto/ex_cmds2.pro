@@ -12,8 +12,10 @@ linenr_T dbg_find_breakpoint(int file, char_u *fname, linenr_T after);
 int has_profiling(int file, char_u *fname, int *fp);
 void dbg_breakpoint(char_u *name, linenr_T lnum);
 void profile_start(proftime_T *tm);
+varnumber_T profile_nsec(void);
 void profile_end(proftime_T *tm);
 void profile_sub(proftime_T *tm, proftime_T *tm2);
+void profile_add(proftime_T *tm, proftime_T *tm2);
 char *profile_msg(proftime_T *tm);
 float_T profile_float(proftime_T *tm);
 void profile_setlimit(long msec, proftime_T *tm);
@@ -30,7 +32,6 @@ void add_timer_info_all(typval_T *rettv);
 int set_ref_in_timer(int copyID);
 void timer_free_all(void);
 void profile_divide(proftime_T *tm, int count, proftime_T *tm2);
-void profile_add(proftime_T *tm, proftime_T *tm2);
 void profile_self(proftime_T *self, proftime_T *total, proftime_T *children);
 void profile_get_wait(proftime_T *tm);
 void profile_sub_wait(proftime_T *tm, proftime_T *tma);
@@ -9,6 +9,7 @@ bhdr_T *mf_get(memfile_T *mfp, blocknr_T nr, int page_count);
 void mf_put(memfile_T *mfp, bhdr_T *hp, int dirty, int infile);
 void mf_free(memfile_T *mfp, bhdr_T *hp);
 int mf_sync(memfile_T *mfp, int flags);
+void mf_flush_wait(memfile_T *mfp);
 void mf_set_dirty(memfile_T *mfp);
 int mf_release_all(void);
 blocknr_T mf_trans_del(memfile_T *mfp, blocknr_T old_nr);
@@ -9,6 +9,7 @@ void redraw_buf_line_later(buf_T *buf, linenr_T lnum);
 void redraw_buf_and_status_later(buf_T *buf, int type);
 int redraw_asap(int type);
 void redraw_after_callback(int call_update_screen);
+long redraw_postponed_callback(void);
 void redrawWinline(win_T *wp, linenr_T lnum);
 void reset_updating_screen(int may_resize_shell);
 void update_curbuf(int type);
@@ -17,6 +18,7 @@ int conceal_cursor_line(win_T *wp);
 void conceal_check_cursor_line(void);
 void update_debug_sign(buf_T *buf, linenr_T lnum);
 void updateWindow(win_T *wp);
+void line_cache_free(win_T *wp);
 int screen_get_current_line_off(void);
 void screen_line(int row, int coloff, int endcol, int clear_width, int rlflag);
 void rl_mirror(char_u *str);
@@ -61,4 +63,9 @@ void showruler(int always);
 int number_width(win_T *wp);
 int screen_screencol(void);
 int screen_screenrow(void);
+void rendertime_add(int part, win_T *wp, varnumber_T start);
+void rendertime_log_frame(int start);
+void ex_rendertime(exarg_T *eap);
+char_u *get_rendertime_arg(expand_T *xp, int idx);
+void rendertime_dict(dict_T *dict, win_T *wp);
 /* vim: set ft=c : */
@@ -1,6 +1,7 @@
 /* syntax.c */
 void syn_set_timeout(proftime_T *tm);
 void syntax_start(win_T *wp, linenr_T lnum);
+int syn_idle_parse(void);
 void syn_stack_free_all(synblock_T *block);
 void syn_stack_apply_changes(buf_T *buf);
 void syntax_end_parsing(linenr_T lnum);
@@ -9,6 +10,9 @@ int get_syntax_attr(colnr_T col, int *can_spell, int keep_state);
 void syntax_clear(synblock_T *block);
 void reset_synblock(win_T *wp);
 void ex_syntax(exarg_T *eap);
+void syn_apply_autocmds(char_u *name, int force);
+void syn_cache_sourced(char_u *fname);
+void syn_cache_clear(void);
 void ex_ownsyntax(exarg_T *eap);
 int syntax_present(win_T *win);
 void reset_expand_highlight(void);
@@ -22,6 +26,7 @@ int syn_get_stack_item(int i);
 int syn_get_foldlevel(win_T *wp, long lnum);
 void ex_syntime(exarg_T *eap);
 char_u *get_syntime_arg(expand_T *xp, int idx);
+void syntime_list(list_T *list);
 void init_highlight(int both, int reset);
 int load_colors(char_u *name);
 int lookup_color(int idx, int foreground, int *boldp);
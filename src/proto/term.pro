@@ -12,6 +12,8 @@ int term_is_gui(char_u *name);
 char_u *tltoa(unsigned long i);
 void termcapinit(char_u *name);
 void out_flush(void);
+void out_frame_start(void);
+void out_frame_end(void);
 void out_flush_cursor(int force, int clear_selection);
 void out_flush_check(void);
 void out_trash(void);
@@ -21,6 +23,8 @@ void out_str_cf(char_u *s);
 void out_str(char_u *s);
 void term_windgoto(int row, int col);
 void term_cursor_right(int i);
+int term_windgoto_len(int row, int col);
+int term_cursor_right_len(int i);
 void term_append_lines(int line_count);
 void term_delete_lines(int line_count);
 void term_set_winpos(int x, int y);
@@ -15,6 +15,11 @@
 
 #if defined(FEAT_QUICKFIX) || defined(PROTO)
 
+#if defined(UNIX) && defined(HAVE_PTHREAD)
+# include <pthread.h>
+# define USE_VIMGREP_THREADS
+#endif
+
 struct dir_stack_T
 {
     struct dir_stack_T	*next;
@@ -5336,6 +5341,645 @@ vgr_match_buflines(
     return found_match;
 }
 
+/*
+ * Return TRUE if every encoding in 'fileencodings' has ASCII characters as
+ * the same bytes, so that ASCII text can be found in a file without
+ * converting it.  A file with a UTF-16 or UCS-4 BOM is checked separately.
+ */
+    static int
+vgr_fencs_ascii(void)
+{
+    char_u	*p = p_fencs;
+    char_u	*enc;
+    char_u	buf[100];
+    int		prop;
+
+    while (*p != NUL)
+    {
+	copy_option_part(&p, buf, (int)sizeof(buf), ",");
+	if (STRCMP(buf, "ucs-bom") == 0 || STRCMP(buf, "default") == 0)
+	    continue;
+	enc = enc_canonize(buf);
+	if (enc == NULL)
+	    return FALSE;
+	prop = enc_canon_props(enc);
+	vim_free(enc);
+	if (!(prop & (ENC_8BIT | ENC_DBCS)) && (!(prop & ENC_UNICODE)
+			     || (prop & (ENC_2BYTE | ENC_2WORD | ENC_4BYTE))))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Files that are not loaded are searched without a buffer when the text is
+ * used as it is in the file and the pattern gives the same result for a
+ * single line.  This avoids the buffer, memline, swap file and autocommands
+ * that loading a dummy buffer involves.  Otherwise the file is loaded.
+ */
+#define VGR_RAW_NONE	0	// always load files
+#define VGR_RAW_ANY	1	// any text is used as-is
+#define VGR_RAW_UTF8	2	// text is used as-is when it is valid UTF-8
+#define VGR_RAW_ASCII	3	// text is used as-is when it is ASCII
+
+/*
+ * Return how the files for ":vimgrep" with pattern "pat" and compiled
+ * "regmatch" can be searched without loading them, one of VGR_RAW_ values.
+ */
+    static int
+vgr_raw_mode(regmmatch_T *regmatch, char_u *pat)
+{
+    char_u	*p;
+    char_u	buf[100];
+    char_u	*enc = NULL;
+
+    if (regmatch->regprog == NULL || re_multiline(regmatch->regprog))
+	return VGR_RAW_NONE;
+    if (pat == NULL || *pat == NUL)
+	pat = last_search_pat();
+    if (pat == NULL)
+	return VGR_RAW_NONE;
+    for (p = pat; *p != NUL; ++p)
+    {
+	if (*p == '\\')
+	{
+	    // "\n" and "\_x" match a line break, the NFA engine doesn't flag
+	    // all of them as multi-line.
+	    if (p[1] == 'n' || p[1] == '_')
+		return VGR_RAW_NONE;
+	    if (p[1] == '\\')
+		++p;
+	}
+	else if (*p == '%')
+	{
+	    char_u *q = p + 1;
+
+	    // "\%23l", "\%V", "\%#", "\%'m", "\%^" and "\%$" depend on the
+	    // position in the buffer, "\%23v" on the tabstops.
+	    if (*q == '<' || *q == '>')
+		++q;
+	    while (VIM_ISDIGIT(*q))
+		++q;
+	    if (*q != NUL && vim_strchr((char_u *)"lvV#'^$", *q) != NULL)
+		return VGR_RAW_NONE;
+	}
+    }
+
+    // Matching a single line uses 'iskeyword' of the current buffer, a dummy
+    // buffer gets the global value.
+    if (!buf_isk_is_global(curbuf))
+	return VGR_RAW_NONE;
+
+    // Without 'fileformats' the global 'fileformat' is used.  In the Mac
+    // format a file without a CR may be one long line.
+    if (*p_ffs == NUL || vim_strchr(p_ffs, 'm') != NULL)
+	return VGR_RAW_NONE;
+
+    // The first encoding in 'fileencodings' is tried first.  A file with a
+    // BOM is always loaded.
+    for (p = p_fencs; *p != NUL; )
+    {
+	copy_option_part(&p, buf, (int)sizeof(buf), ",");
+	if (STRCMP(buf, "ucs-bom") != 0)
+	{
+	    enc = enc_canonize(buf);
+	    if (enc == NULL)
+		return VGR_RAW_NONE;
+	    break;
+	}
+    }
+    if (enc == NULL)
+	return VGR_RAW_ANY;
+    if (STRCMP(enc, p_enc) == 0)
+    {
+	vim_free(enc);
+	// When the text isn't valid UTF-8 the next encoding is tried.
+	return enc_utf8 ? VGR_RAW_UTF8 : VGR_RAW_ANY;
+    }
+    vim_free(enc);
+
+    // The text is converted, ASCII text stays the same if all the encodings
+    // that may be tried use the same bytes for it.
+    if (
+#ifdef FEAT_EVAL
+	    *p_ccv != NUL ||
+#endif
+	    !vgr_fencs_ascii())
+	return VGR_RAW_NONE;
+    return VGR_RAW_ASCII;
+}
+
+/*
+ * Return TRUE when "len" bytes of file text "text" end up in a buffer as-is
+ * and are split into lines at a NL only.
+ */
+    static int
+vgr_raw_text_ok(char_u *text, long len, int mode)
+{
+    long	i;
+
+    if (len <= 0)
+	return TRUE;
+    // A file with a BOM is converted, an encrypted file is decrypted.
+    if ((len >= 2 && ((text[0] == 0xfe && text[1] == 0xff)
+				      || (text[0] == 0xff && text[1] == 0xfe)))
+	    || (len >= 3 && text[0] == 0xef && text[1] == 0xbb
+							 && text[2] == 0xbf)
+	    || (len >= 9 && memcmp(text, "VimCrypt~", 9) == 0))
+	return FALSE;
+    // A NUL is stored as a NL, a CR may be part of the line break.
+    if (memchr(text, NUL, (size_t)len) != NULL
+				      || memchr(text, CAR, (size_t)len) != NULL)
+	return FALSE;
+    if (mode == VGR_RAW_UTF8)
+	return utf_valid_string(text, text + len);
+    if (mode == VGR_RAW_ASCII)
+	for (i = 0; i < len; ++i)
+	    if (text[i] >= 0x80)
+		return FALSE;
+    return TRUE;
+}
+
+/*
+ * Search for a pattern in all the lines of file "fname" without loading it
+ * into a buffer and add the matching lines to a quickfix list.
+ * "mode" is what vgr_raw_mode() returned.  Sets "*found_match" when a match
+ * was found.
+ * Returns FAIL when the file must be loaded into a buffer to search it.
+ */
+    static int
+vgr_match_file(
+	qf_info_T   *qi,
+	char_u	    *fname,
+	regmmatch_T *regmatch,
+	int	    mode,
+	long	    *tomatch,
+	int	    flags,
+	int	    *found_match)
+{
+    stat_T	st;
+    int		fd;
+    char_u	*text = NULL;
+    long	len;
+    long	n;
+    long	r;
+    char_u	*p;
+    char_u	*e;
+    char_u	*line = NULL;
+    long	linesize = 0;
+    long	linelen;
+    linenr_T	lnum;
+    colnr_T	col;
+    regmatch_T	rm;
+    int		retval = FAIL;
+
+    // Autocommands used when reading may change the text, a fifo would
+    // block.
+    if (has_read_autocmd(fname)
+	    || mch_stat((char *)fname, &st) < 0
+	    || !S_ISREG(st.st_mode)
+	    || (off_T)(long)st.st_size != st.st_size)
+	return FAIL;
+    fd = mch_open((char *)fname, O_RDONLY | O_EXTRA, 0);
+    if (fd < 0)
+	return FAIL;
+    len = (long)st.st_size;
+    if (len > 0)
+    {
+	text = lalloc((long_u)len, TRUE);
+	if (text != NULL)
+	{
+	    // The file may have been truncated meanwhile.
+	    for (n = 0; n < len; n += r)
+	    {
+		r = read_eintr(fd, text + n, (size_t)(len - n));
+		if (r <= 0)
+		    break;
+	    }
+	    len = n;
+	}
+    }
+    close(fd);
+    if ((len > 0 && text == NULL) || !vgr_raw_text_ok(text, len, mode))
+	goto theend;
+
+    rm.regprog = regmatch->regprog;
+    rm.rm_ic = regmatch->rmm_ic;
+    p = text;
+    for (lnum = 1; *tomatch > 0; ++lnum)
+    {
+	e = len == 0 ? NULL : memchr(p, NL, (size_t)(text + len - p));
+	linelen = (e == NULL ? text + len : e) - p;
+	if (linelen >= linesize)
+	{
+	    vim_free(line);
+	    linesize = linelen + 100;
+	    line = lalloc((long_u)linesize, TRUE);
+	    if (line == NULL)
+	    {
+		linesize = 0;
+		break;
+	    }
+	}
+	mch_memmove(line, p, (size_t)linelen);
+	line[linelen] = NUL;
+
+	col = 0;
+	while (vim_regexec(&rm, line, col))
+	{
+	    if (qf_add_entry(qi,
+			qi->qf_curlist,
+			NULL,       // dir
+			fname,
+			NULL,
+			0,
+			line,
+			lnum,
+			(int)(rm.startp[0] - line) + 1,
+			FALSE,      // vis_col
+			NULL,	    // search pattern
+			0,	    // nr
+			0,	    // type
+			TRUE	    // valid
+			) == FAIL)
+	    {
+		got_int = TRUE;
+		break;
+	    }
+	    *found_match = TRUE;
+	    if (--*tomatch == 0)
+		break;
+	    if ((flags & VGR_GLOBAL) == 0)
+		break;
+	    col = (colnr_T)(rm.endp[0] - line)
+				   + (col == (colnr_T)(rm.endp[0] - line));
+	    if (col > linelen)
+		break;
+	}
+	line_breakcheck();
+	if (got_int)
+	    break;
+	// A NL at the end of the file doesn't start another line.
+	if (e == NULL || e + 1 == text + len)
+	    break;
+	p = e + 1;
+    }
+    // The regexp engine may have changed the program.
+    regmatch->regprog = rm.regprog;
+    vim_free(line);
+    retval = OK;
+
+theend:
+    vim_free(text);
+    return retval;
+}
+
+#ifdef USE_VIMGREP_THREADS
+/*
+ * With 'vimgrepjobs' set, threads read the files ahead of ex_vimgrep() and
+ * check whether they contain the literal text that every match of the pattern
+ * must include.  Files without it are skipped without loading them into a
+ * buffer.  The regexp engine itself can't be used by a thread, it keeps its
+ * state in global variables, thus the other files are still loaded and
+ * searched by the main thread.
+ */
+# define VGR_MAX_JOBS	64	// maximum number of threads
+# define VGR_AHEAD	512	// nr of files the threads may work ahead
+# define VGR_MAX_LIT	128	// max nr of bytes of the literal to use
+# define VGR_BUFSIZE	32768	// size of one read() by a thread
+# define VGR_WAIT_MSEC	50	// time between checks for CTRL-C
+
+# define VGR_UNKNOWN	0	// file was not checked yet
+# define VGR_LOAD	1	// file must be loaded and searched
+# define VGR_SKIP	2	// file does not contain the literal
+
+typedef struct
+{
+    char_u	    **vp_fnames;	// full file names, NULL to always load
+    char_u	    *vp_state;		// VGR_ value for each file
+    int		    vp_count;		// number of files
+    int		    vp_next;		// next file to check by a thread
+    int		    vp_main;		// file the main thread is at
+    int		    vp_stop;		// TRUE when the threads must stop
+    int		    vp_skipped;		// nr of files skipped by the main thread
+    char_u	    vp_lit[VGR_MAX_LIT]; // literal text
+    int		    vp_litlen;		// length of vp_lit
+    int		    vp_ic;		// ignore case for vp_lit
+    int		    vp_nthreads;	// number of started threads
+    pthread_t	    vp_threads[VGR_MAX_JOBS];
+    pthread_mutex_t vp_mutex;
+    pthread_cond_t  vp_checked;		// signalled when a file was checked
+    pthread_cond_t  vp_moved;		// signalled when vp_main changed
+} vgr_prefilter_T;
+
+/*
+ * Return TRUE if the literal of "vp" appears in the "len" bytes at "s".
+ */
+    static int
+vgr_find_lit(vgr_prefilter_T *vp, char_u *s, long len)
+{
+    char_u	*lit = vp->vp_lit;
+    int		litlen = vp->vp_litlen;
+    char_u	*end;
+    char_u	*p;
+    int		i;
+
+    if (len < litlen)
+	return FALSE;
+    end = s + len - litlen;
+    if (!vp->vp_ic)
+    {
+	for (p = s; p <= end; ++p)
+	{
+	    p = memchr(p, lit[0], end - p + 1);
+	    if (p == NULL)
+		break;
+	    if (memcmp(p, lit, litlen) == 0)
+		return TRUE;
+	}
+	return FALSE;
+    }
+
+    for (p = s; p <= end; ++p)
+	if (TOLOWER_ASC(*p) == lit[0])
+	{
+	    for (i = 1; i < litlen; ++i)
+		if (TOLOWER_ASC(p[i]) != lit[i])
+		    break;
+	    if (i == litlen)
+		return TRUE;
+	}
+    return FALSE;
+}
+
+/*
+ * Return TRUE if file "fname" may contain the literal of "vp": it does, the
+ * file can't be read or its text is converted when loaded.
+ * Called by a thread, must not use global variables.
+ */
+    static int
+vgr_file_has_lit(vgr_prefilter_T *vp, char_u *fname)
+{
+    char_u	buf[VGR_MAX_LIT + VGR_BUFSIZE];
+    stat_T	st;
+    int		fd;
+    long	keep = 0;	// bytes kept from the previous read
+    long	n;
+    int		first = TRUE;
+    int		found = FALSE;
+    int		stop;
+
+    // Let the main thread handle anything that isn't a plain file, opening
+    // a fifo would block.
+    if (mch_stat((char *)fname, &st) < 0 || !S_ISREG(st.st_mode))
+	return TRUE;
+    fd = mch_open((char *)fname, O_RDONLY | O_EXTRA, 0);
+    if (fd < 0)
+	return TRUE;
+
+    for (;;)
+    {
+	// A big file takes a while, stop when vimgrep was interrupted.
+	pthread_mutex_lock(&vp->vp_mutex);
+	stop = vp->vp_stop;
+	pthread_mutex_unlock(&vp->vp_mutex);
+	if (stop)
+	    break;
+
+	n = read_eintr(fd, buf + keep, VGR_BUFSIZE);
+	if (n <= 0)
+	{
+	    found = n < 0;
+	    break;
+	}
+	// A file with a UTF-16 or UCS-4 BOM is converted when read, an
+	// encrypted file is decrypted.
+	if (first && ((n >= 2 && ((buf[0] == 0xfe && buf[1] == 0xff)
+				      || (buf[0] == 0xff && buf[1] == 0xfe)))
+		    || (n >= 4 && buf[0] == 0 && buf[1] == 0
+					     && buf[2] == 0xfe && buf[3] == 0xff)
+		    || (n >= 9 && memcmp(buf, "VimCrypt~", 9) == 0)))
+	{
+	    found = TRUE;
+	    break;
+	}
+	first = FALSE;
+	n += keep;
+	if (vgr_find_lit(vp, buf, n))
+	{
+	    found = TRUE;
+	    break;
+	}
+	// The literal may continue in the next block, keep the bytes it could
+	// start with.
+	keep = vp->vp_litlen - 1;
+	if (keep > n)
+	    keep = n;
+	mch_memmove(buf, buf + n - keep, (size_t)keep);
+    }
+    close(fd);
+    return found;
+}
+
+/*
+ * The function executed by each thread: check files until there are no more.
+ */
+    static void *
+vgr_prefilter_thread(void *arg)
+{
+    vgr_prefilter_T *vp = (vgr_prefilter_T *)arg;
+    int		    fi;
+    int		    state;
+
+    pthread_mutex_lock(&vp->vp_mutex);
+    for (;;)
+    {
+	// Don't get too far ahead of the main thread, ":1vimgrep" may stop
+	// at the first match.
+	while (!vp->vp_stop && vp->vp_next < vp->vp_count
+				    && vp->vp_next >= vp->vp_main + VGR_AHEAD)
+	    pthread_cond_wait(&vp->vp_moved, &vp->vp_mutex);
+	if (vp->vp_stop || vp->vp_next >= vp->vp_count)
+	    break;
+	fi = vp->vp_next++;
+	if (vp->vp_fnames[fi] == NULL)
+	    continue;
+	pthread_mutex_unlock(&vp->vp_mutex);
+
+	state = vgr_file_has_lit(vp, vp->vp_fnames[fi]) ? VGR_LOAD : VGR_SKIP;
+
+	pthread_mutex_lock(&vp->vp_mutex);
+	vp->vp_state[fi] = state;
+	pthread_cond_broadcast(&vp->vp_checked);
+    }
+    pthread_mutex_unlock(&vp->vp_mutex);
+    return NULL;
+}
+
+/*
+ * Stop the threads of "vp" and free it.
+ */
+    static void
+vgr_prefilter_end(vgr_prefilter_T *vp)
+{
+    int		i;
+
+    pthread_mutex_lock(&vp->vp_mutex);
+    vp->vp_stop = TRUE;
+    pthread_cond_broadcast(&vp->vp_moved);
+    pthread_mutex_unlock(&vp->vp_mutex);
+    for (i = 0; i < vp->vp_nthreads; ++i)
+	pthread_join(vp->vp_threads[i], NULL);
+
+    pthread_mutex_destroy(&vp->vp_mutex);
+    pthread_cond_destroy(&vp->vp_checked);
+    pthread_cond_destroy(&vp->vp_moved);
+    for (i = 0; i < vp->vp_count; ++i)
+	vim_free(vp->vp_fnames[i]);
+    vim_free(vp->vp_fnames);
+    vim_free(vp->vp_state);
+    vim_free(vp);
+}
+
+/*
+ * Start checking the "fcount" files in "fnames" for the literal text of the
+ * pattern in "regmatch" with 'vimgrepjobs' threads.
+ * Returns NULL when this is not possible or not useful.
+ */
+    static vgr_prefilter_T *
+vgr_prefilter_start(regmmatch_T *regmatch, char_u **fnames, int fcount)
+{
+    vgr_prefilter_T *vp;
+    char_u	    *lit;
+    int		    len;
+    int		    ic = regmatch->rmm_ic;
+    int		    njobs;
+    int		    i;
+    sigset_t	    set;
+    sigset_t	    oldset;
+
+    if (p_vgj <= 0 || fcount < 2)
+	return NULL;
+    lit = vim_regprog_literal(regmatch->regprog, &ic, &len);
+    if (lit == NULL)
+	return NULL;
+    // Any part of the literal is also required.
+    if (len > VGR_MAX_LIT)
+	len = VGR_MAX_LIT;
+    // Only use plain ASCII text, other characters may be converted when
+    // reading the file and a NUL is stored as a NL.
+    for (i = 0; i < len; ++i)
+	if (lit[i] >= 0x80 || (lit[i] < ' ' && lit[i] != TAB))
+	    return NULL;
+# ifdef FEAT_EVAL
+    if (*p_ccv != NUL)
+	return NULL;
+# endif
+    if (!vgr_fencs_ascii())
+	return NULL;
+
+    vp = (vgr_prefilter_T *)alloc_clear((unsigned)sizeof(vgr_prefilter_T));
+    if (vp == NULL)
+	return NULL;
+    vp->vp_fnames = (char_u **)alloc_clear(
+					  (unsigned)(fcount * sizeof(char_u *)));
+    vp->vp_state = alloc_clear((unsigned)fcount);
+    if (vp->vp_fnames == NULL || vp->vp_state == NULL)
+    {
+	vim_free(vp->vp_fnames);
+	vim_free(vp->vp_state);
+	vim_free(vp);
+	return NULL;
+    }
+    vp->vp_count = fcount;
+    for (i = 0; i < len; ++i)
+	vp->vp_lit[i] = ic ? TOLOWER_ASC(lit[i]) : lit[i];
+    vp->vp_litlen = len;
+    vp->vp_ic = ic;
+
+    // The threads need full names, an autocommand may change the current
+    // directory.  Autocommands used when reading a file may change the text,
+    // always load those files.
+    for (i = 0; i < fcount; ++i)
+    {
+	if (!has_read_autocmd(fnames[i]))
+	    vp->vp_fnames[i] = FullName_save(fnames[i], TRUE);
+	if (vp->vp_fnames[i] == NULL)
+	    vp->vp_state[i] = VGR_LOAD;
+    }
+
+    pthread_mutex_init(&vp->vp_mutex, NULL);
+    pthread_cond_init(&vp->vp_checked, NULL);
+    pthread_cond_init(&vp->vp_moved, NULL);
+
+    njobs = p_vgj > VGR_MAX_JOBS ? VGR_MAX_JOBS : (int)p_vgj;
+    if (njobs > fcount)
+	njobs = fcount;
+    // Signals must be handled by the main thread, block all of them in the
+    // new threads.
+    sigfillset(&set);
+    pthread_sigmask(SIG_SETMASK, &set, &oldset);
+    for (i = 0; i < njobs; ++i)
+	if (pthread_create(&vp->vp_threads[vp->vp_nthreads], NULL,
+					       vgr_prefilter_thread, vp) == 0)
+	    ++vp->vp_nthreads;
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+
+    if (vp->vp_nthreads == 0)
+    {
+	vgr_prefilter_end(vp);
+	return NULL;
+    }
+    return vp;
+}
+
+/*
+ * Return TRUE if file "fi" of "vp" doesn't contain the literal and doesn't
+ * need to be loaded.  Waits for a thread to check the file.
+ * Also returns TRUE when interrupted, "got_int" is set then.
+ */
+    static int
+vgr_prefilter_skip(vgr_prefilter_T *vp, int fi)
+{
+    int		    skip;
+    struct timeval  tv;
+    struct timespec ts;
+
+    pthread_mutex_lock(&vp->vp_mutex);
+    vp->vp_main = fi;
+    pthread_cond_broadcast(&vp->vp_moved);
+    while (vp->vp_state[fi] == VGR_UNKNOWN)
+    {
+	// Checking a big file may take long, wake up now and then to check
+	// for CTRL-C.
+	gettimeofday(&tv, NULL);
+	ts.tv_sec = tv.tv_sec;
+	ts.tv_nsec = (tv.tv_usec + VGR_WAIT_MSEC * 1000L) * 1000L;
+	if (ts.tv_nsec >= 1000000000L)
+	{
+	    ++ts.tv_sec;
+	    ts.tv_nsec -= 1000000000L;
+	}
+	if (pthread_cond_timedwait(&vp->vp_checked, &vp->vp_mutex, &ts)
+								   != ETIMEDOUT)
+	    continue;
+	pthread_mutex_unlock(&vp->vp_mutex);
+	ui_breakcheck();
+	pthread_mutex_lock(&vp->vp_mutex);
+	if (got_int)
+	{
+	    pthread_mutex_unlock(&vp->vp_mutex);
+	    return TRUE;
+	}
+    }
+    skip = vp->vp_state[fi] == VGR_SKIP;
+    pthread_mutex_unlock(&vp->vp_mutex);
+    if (skip)
+	++vp->vp_skipped;
+    return skip;
+}
+#endif
+
 /*
  * Jump to the first match and update the directory.
  */
@@ -5391,6 +6035,9 @@ ex_vimgrep(exarg_T *eap)
     buf_T	*buf;
     int		duplicate_name = FALSE;
     int		using_dummy;
+    int		raw_mode;
+    int		searched_raw;
+    int		found_raw_match = FALSE;
     int		redraw_for_dummy = FALSE;
     int		found_match;
     buf_T	*first_match_buf = NULL;
@@ -5402,6 +6049,9 @@ ex_vimgrep(exarg_T *eap)
     char_u	*dirname_now = NULL;
     char_u	*target_dir = NULL;
     char_u	*au_name =  NULL;
+#ifdef USE_VIMGREP_THREADS
+    vgr_prefilter_T *prefilter;
+#endif
 
     au_name = vgr_get_auname(eap->cmdidx);
     if (au_name != NULL && apply_autocmds(EVENT_QUICKFIXCMDPRE, au_name,
@@ -5481,6 +6131,11 @@ ex_vimgrep(exarg_T *eap)
     // autocommands changing the current quickfix list.
     save_qfid = qi->qf_lists[qi->qf_curlist].qf_id;
 
+#ifdef USE_VIMGREP_THREADS
+    prefilter = vgr_prefilter_start(&regmatch, fnames, fcount);
+#endif
+    raw_mode = vgr_raw_mode(&regmatch, s);
+
     seconds = (time_t)0;
     for (fi = 0; fi < fcount && !got_int && tomatch > 0; ++fi)
     {
@@ -5493,15 +6148,35 @@ ex_vimgrep(exarg_T *eap)
 	    vgr_display_fname(fname);
 	}
 
+	searched_raw = FALSE;
 	buf = buflist_findname_exp(fnames[fi]);
 	if (buf == NULL || buf->b_ml.ml_mfp == NULL)
 	{
-	    // Remember that a buffer with this name already exists.
-	    duplicate_name = (buf != NULL);
-	    using_dummy = TRUE;
-	    redraw_for_dummy = TRUE;
+#ifdef USE_VIMGREP_THREADS
+	    // No need to load a file that can't match.
+	    if (prefilter != NULL && vgr_prefilter_skip(prefilter, fi))
+	    {
+		fast_breakcheck();
+		continue;
+	    }
+#endif
+	    if (raw_mode != VGR_RAW_NONE && vgr_match_file(qi, fname,
+		  &regmatch, raw_mode, &tomatch, flags, &found_raw_match) == OK)
+	    {
+		// Searched the file without loading it.
+		searched_raw = TRUE;
+		using_dummy = FALSE;
+		buf = NULL;
+	    }
+	    else
+	    {
+		// Remember that a buffer with this name already exists.
+		duplicate_name = (buf != NULL);
+		using_dummy = TRUE;
+		redraw_for_dummy = TRUE;
 
-	    buf = vgr_load_dummy_buf(fname, dirname_start, dirname_now);
+		buf = vgr_load_dummy_buf(fname, dirname_start, dirname_now);
+	    }
 	}
 	else
 	    // Use existing, loaded buffer.
@@ -5511,6 +6186,10 @@ ex_vimgrep(exarg_T *eap)
 	// buffer above, autocommands might have changed the quickfix list.
 	if (!vgr_qflist_valid(wp, qi, save_qfid, qf_cmdtitle(*eap->cmdlinep)))
 	{
+#ifdef USE_VIMGREP_THREADS
+	    if (prefilter != NULL)
+		vgr_prefilter_end(prefilter);
+#endif
 	    FreeWild(fcount, fnames);
 	    decr_quickfix_busy();
 	    goto theend;
@@ -5519,7 +6198,7 @@ ex_vimgrep(exarg_T *eap)
 
 	if (buf == NULL)
 	{
-	    if (!got_int)
+	    if (!got_int && !searched_raw)
 		smsg(_("Cannot open file \"%s\""), fname);
 	}
 	else
@@ -5531,7 +6210,9 @@ ex_vimgrep(exarg_T *eap)
 
 	    if (using_dummy)
 	    {
-		if (found_match && first_match_buf == NULL)
+		// Only the buffer for the first file with a match is kept
+		// loaded, it may have been searched without a buffer.
+		if (found_match && first_match_buf == NULL && !found_raw_match)
 		    first_match_buf = buf;
 		if (duplicate_name)
 		{
@@ -5593,6 +6274,19 @@ ex_vimgrep(exarg_T *eap)
 	}
     }
 
+#ifdef USE_VIMGREP_THREADS
+    if (prefilter != NULL)
+    {
+	if (p_verbose > 0)
+	{
+	    verbose_enter();
+	    smsg(_("Skipped %d of %d files without loading"),
+						 prefilter->vp_skipped, fcount);
+	    verbose_leave();
+	}
+	vgr_prefilter_end(prefilter);
+    }
+#endif
     FreeWild(fcount, fnames);
 
     qfl = &qi->qf_lists[qi->qf_curlist];
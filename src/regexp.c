@@ -46,6 +46,13 @@
 
 #include "vim.h"
 
+/* SSE2 is always there on x86_64, use it to look for a literal string 16
+ * bytes at a time. */
+#if defined(__SSE2__) && !defined(PROTO)
+# include <emmintrin.h>
+# define USE_SSE2_SCAN
+#endif
+
 #ifdef DEBUG
 /* show/save debugging data when BT engine is used */
 # define BT_REGEXP_DUMP
@@ -69,12 +76,12 @@
  *
  * Regstart and reganch permit very fast decisions on suitable starting points
  * for a match, cutting down the work a lot.  Regmust permits fast rejection
- * of lines that cannot possibly match.  The regmust tests are costly enough
- * that vim_regcomp() supplies a regmust only if the r.e. contains something
- * potentially expensive (at present, the only such thing detected is * or +
- * at the start of the r.e., which can involve a lot of backup).  Regmlen is
- * supplied because the test in vim_regexec() needs it and vim_regcomp() is
- * computing it anyway.
+ * of lines that cannot possibly match.  It is looked for with
+ * reg_find_literal(), which is fast enough to always do this when the r.e.
+ * has a literal string that must appear.  Regmlen is supplied because the
+ * test in vim_regexec() needs it and vim_regcomp() is computing it anyway.
+ * Regmust_icok is set when regmust can be found with reg_find_literal() when
+ * ignoring case.
  */
 
 /*
@@ -347,6 +354,12 @@ toggle_Magic(int x)
 
 static int cstrncmp(char_u *s1, char_u *s2, int *n);
 static char_u *cstrchr(char_u *, int);
+static int reg_literal_icok(char_u *lit, int len);
+static char_u *reg_find_literal(char_u *s, char_u *lit, int len, int ic);
+
+/* Bytes checked for the end of the line before looking for a literal string
+ * in them, doubled for each next chunk. */
+#define REG_FIND_CHUNK	64
 
 #ifdef BT_REGEXP_DUMP
 static void	regdump(char_u *, bt_regprog_T *);
@@ -581,6 +594,9 @@ init_class_tab(void)
 #define RF_HASNL    4	/* can match a NL */
 #define RF_ICOMBINE 8	/* ignore combining characters */
 #define RF_LOOKBH   16	/* uses "\@<=" or "\@<!" */
+#define RF_NESTED   32	/* has a multi on an item with a multi or "\|" */
+#define RF_NOMEMO   64	/* uses a back reference, look-around or complex
+			 * \{}, can't use memoization */
 
 /*
  * Global work variables for vim_regcomp().
@@ -599,6 +615,7 @@ static long	regsize;	/* Code size. */
 static int	reg_toolong;	/* TRUE when offset out of range */
 static char_u	had_endbrace[NSUBEXP];	/* flags, TRUE if end of () found */
 static unsigned	regflags;	/* RF_ flags for prog */
+static int	regchoice;	/* nr of multis and "\|" seen */
 static long	brace_min[10];	/* Minimums for complex brace repeats */
 static long	brace_max[10];	/* Maximums for complex brace repeats */
 static int	brace_count[10]; /* Current counts for complex brace repeats */
@@ -705,6 +722,9 @@ static int	read_limits(long *, long *);
 static void	regtail(char_u *, char_u *);
 static void	regoptail(char_u *, char_u *);
 static int	reg_iswordc(int);
+#ifdef EXITFREE
+static void	regcache_clear(void);
+#endif
 
 static regengine_T bt_regengine;
 static regengine_T nfa_regengine;
@@ -1301,8 +1321,10 @@ bt_regcomp(char_u *expr, int re_flags)
     bt_regprog_T    *r;
     char_u	*scan;
     char_u	*longest;
+    char_u	*startlit;
     int		len;
     int		flags;
+    int		expensive;
 
     if (expr == NULL)
 	EMSG_RET_NULL(_(e_null));
@@ -1323,6 +1345,7 @@ bt_regcomp(char_u *expr, int re_flags)
     if (r == NULL)
 	return NULL;
     r->re_in_use = FALSE;
+    r->regsize = regsize;
 
     /*
      * Second pass: emit code.
@@ -1343,6 +1366,7 @@ bt_regcomp(char_u *expr, int re_flags)
     r->reganch = 0;
     r->regmust = NULL;
     r->regmlen = 0;
+    r->regmust_icok = FALSE;
     r->regflags = regflags;
     if (flags & HASNL)
 	r->regflags |= RF_HASNL;
@@ -1364,41 +1388,43 @@ bt_regcomp(char_u *expr, int re_flags)
 	    scan = regnext(scan);
 	}
 
+	startlit = NULL;
 	if (OP(scan) == EXACTLY)
-	{
-	    if (has_mbyte)
-		r->regstart = (*mb_ptr2char)(OPERAND(scan));
-	    else
-		r->regstart = *OPERAND(scan);
-	}
+	    startlit = OPERAND(scan);
 	else if ((OP(scan) == BOW
 		    || OP(scan) == EOW
 		    || OP(scan) == NOTHING
 		    || OP(scan) == MOPEN + 0 || OP(scan) == NOPEN
 		    || OP(scan) == MCLOSE + 0 || OP(scan) == NCLOSE)
 		 && OP(regnext(scan)) == EXACTLY)
+	    startlit = OPERAND(regnext(scan));
+	if (startlit != NULL)
 	{
 	    if (has_mbyte)
-		r->regstart = (*mb_ptr2char)(OPERAND(regnext(scan)));
+		r->regstart = (*mb_ptr2char)(startlit);
 	    else
-		r->regstart = *OPERAND(regnext(scan));
+		r->regstart = *startlit;
 	}
 
 	/*
-	 * If there's something expensive in the r.e., find the longest
-	 * literal string that must appear and make it the regmust.  Resolve
-	 * ties in favor of later strings, since the regstart check works
-	 * with the beginning of the r.e. and avoiding duplication
+	 * Find the longest literal string that must appear and make it the
+	 * regmust.  Resolve ties in favor of later strings, since the regstart
+	 * check works with the beginning of the r.e. and avoiding duplication
 	 * strengthens checking.  Not a strong reason, but sufficient in the
 	 * absence of others.
+	 * Not when the match may continue in the next line, the string may
+	 * be there.
+	 * Looking for it pays off when there's something expensive in the
+	 * r.e. (at present, the only such thing detected is * or + at the
+	 * start of the r.e., which can involve a lot of backup), when the r.e.
+	 * starts with BOW (used a lot for "#" and "*" commands) and when the
+	 * string is not at the start of an unanchored r.e., where the regstart
+	 * check already finds it.
 	 */
-	/*
-	 * When the r.e. starts with BOW, it is faster to look for a regmust
-	 * first. Used a lot for "#" and "*" commands. (Added by mool).
-	 */
-	if ((flags & SPSTART || OP(scan) == BOW || OP(scan) == EOW)
-							  && !(flags & HASNL))
+	if (!(flags & HASNL))
 	{
+	    expensive = (flags & SPSTART) || OP(scan) == BOW
+							   || OP(scan) == EOW;
 	    longest = NULL;
 	    len = 0;
 	    for (; scan != NULL; scan = regnext(scan))
@@ -1407,8 +1433,15 @@ bt_regcomp(char_u *expr, int re_flags)
 		    longest = OPERAND(scan);
 		    len = (int)STRLEN(OPERAND(scan));
 		}
+	    if (!expensive && (r->reganch || longest == startlit))
+	    {
+		longest = NULL;
+		len = 0;
+	    }
 	    r->regmust = longest;
 	    r->regmlen = len;
+	    if (longest != NULL)
+		r->regmust_icok = reg_literal_icok(longest, len);
 	}
     }
 #ifdef BT_REGEXP_DUMP
@@ -1427,6 +1460,24 @@ bt_regfree(regprog_T *prog)
     vim_free(prog);
 }
 
+/*
+ * Return a copy of a compiled regexp program, returned by bt_regcomp().
+ */
+    static regprog_T *
+bt_regdup(regprog_T *prog)
+{
+    bt_regprog_T    *r = (bt_regprog_T *)prog;
+    bt_regprog_T    *copy;
+
+    copy = (bt_regprog_T *)lalloc(sizeof(bt_regprog_T) + r->regsize, TRUE);
+    if (copy == NULL)
+	return NULL;
+    mch_memmove(copy, r, sizeof(bt_regprog_T) + r->regsize);
+    if (r->regmust != NULL)
+	copy->regmust = copy->program + (r->regmust - r->program);
+    return (regprog_T *)copy;
+}
+
 /*
  * Setup to parse the regexp.  Used once to get the length and once to do it.
  */
@@ -1454,6 +1505,7 @@ regcomp_start(
     regsize = 0L;
     reg_toolong = FALSE;
     regflags = 0;
+    regchoice = 0;
 #if defined(FEAT_SYN_HL) || defined(PROTO)
     had_eol = FALSE;
 #endif
@@ -1543,6 +1595,7 @@ reg(
     while (peekchr() == Magic('|'))
     {
 	skipchr();
+	++regchoice;
 	br = regbranch(&flags);
 	if (br == NULL || reg_toolong)
 	    return NULL;
@@ -1732,6 +1785,7 @@ regpiece(int *flagp)
     int		    flags;
     long	    minval;
     long	    maxval;
+    int		    choice_before = regchoice;
 
     ret = regatom(&flags);
     if (ret == NULL)
@@ -1743,6 +1797,16 @@ regpiece(int *flagp)
 	*flagp = flags;
 	return ret;
     }
+    if (op == Magic('@'))
+	regflags |= RF_NOMEMO;
+    else
+    {
+	/* A repeated item that can match in several ways may take
+	 * exponential time, see regmemo_seen(). */
+	if (re_multi_type(op) == MULTI_MULT && regchoice > choice_before)
+	    regflags |= RF_NESTED;
+	++regchoice;
+    }
     /* default flags */
     *flagp = (WORST | SPSTART | (flags & (HASNL | HASLOOKBH)));
 
@@ -1840,6 +1904,7 @@ regpiece(int *flagp)
 		    EMSG2_RET_NULL(_("E60: Too many complex %s{...}s"),
 						      reg_magic == MAGIC_ALL);
 		reginsert(BRACE_COMPLEX + num_complex_braces, ret);
+		regflags |= RF_NOMEMO;
 		regoptail(ret, regnode(BACK));
 		regoptail(ret, ret);
 		reginsert_limits(BRACE_LIMITS, minval, maxval, ret);
@@ -2068,6 +2133,7 @@ regatom(int *flagp)
 		if (!seen_endbrace(refnum))
 		    return NULL;
 		ret = regnode(BACKREF + refnum);
+		regflags |= RF_NOMEMO;
 	    }
 	    break;
 
@@ -2099,6 +2165,7 @@ regatom(int *flagp)
 		case '9': if ((reg_do_extmatch & REX_USE) == 0)
 			      EMSG_RET_NULL(_(e_z1_not_allowed));
 			  ret = regnode(ZREF + c - '0');
+			  regflags |= RF_NOMEMO;
 			  re_has_z = REX_USE;
 			  break;
 #endif
@@ -3600,6 +3667,145 @@ static garray_T	backpos = {0, 0, 0, 0, NULL};
 #define REGSTACK_INITIAL	2048
 #define BACKPOS_INITIAL		64
 
+/*
+ * Memoization for patterns where a repeated item can match in several ways,
+ * such as "\(a*\)*b".  Backtracking may then try the same thing over and
+ * over, taking exponential time.  When regmatch() arrives at a BRANCH or a
+ * STAR-like item in the same state as before, the previous attempt must have
+ * failed, otherwise matching would have stopped, thus it fails right away.
+ * That bounds the time by the number of items times the line length.
+ * The state is the item, the input position and the BACK items that were
+ * passed at this position, BACK fails when the position didn't change.
+ * Nothing else may matter: not with back references, look-around or complex
+ * \{}, those have RF_NOMEMO.
+ * Only positions in the first line are remembered.  The table is only
+ * created after REGMEMO_START items were tried, most patterns don't need
+ * it.
+ */
+typedef struct regmemo_S
+{
+    char_u	*rm_scan;	/* item in the program, NULL when unused */
+    colnr_T	rm_col;		/* column in the first line */
+    unsigned	rm_backs;	/* BACK items passed at "rm_col" */
+} regmemo_T;
+
+#define REGMEMO_START	2000	/* items tried before using the table */
+#define REGMEMO_INITIAL	1024	/* initial table size, power of two */
+#define REGMEMO_MAX	(1024 * 1024)	/* maximum table size */
+#define REGMEMO_BACKS	32	/* max nr of BACK items, bits in rm_backs */
+
+#define REGMEMO_HASH(m, size) \
+    (int)(((((unsigned)(long_u)(m)->rm_scan * 31u + (unsigned)(m)->rm_col) \
+		     * 31u + (m)->rm_backs) * 2654435761u >> 12) & ((size) - 1))
+
+static int	regmemo_ok;		/* pattern may use memoization */
+static long	regmemo_steps;		/* items tried so far */
+static regmemo_T *regmemo_table = NULL;	/* hash table or NULL */
+static int	regmemo_size;		/* nr of entries in regmemo_table */
+static int	regmemo_used;		/* nr of used entries */
+static char_u	*regmemo_back[REGMEMO_BACKS];	/* BACK items seen */
+static int	regmemo_nback;		/* nr of items in regmemo_back[] */
+
+/*
+ * Add "m" to memo table "table" with "size" entries.
+ */
+    static void
+regmemo_add(regmemo_T *table, int size, regmemo_T *m)
+{
+    int		i = REGMEMO_HASH(m, size);
+
+    while (table[i].rm_scan != NULL)
+	i = (i + 1) & (size - 1);
+    table[i] = *m;
+}
+
+/*
+ * Return TRUE when item "scan" was tried before in the current state, it
+ * can't match now either.  Otherwise remember it.
+ */
+    static int
+regmemo_seen(char_u *scan)
+{
+    regmemo_T	m;
+    backpos_T	*bp;
+    int		i;
+    int		j;
+
+    if (rex.lnum != 0)
+	return FALSE;
+    if (regmemo_table == NULL)
+    {
+	if (++regmemo_steps < REGMEMO_START)
+	    return FALSE;
+	regmemo_table = (regmemo_T *)lalloc_clear(
+			   (long_u)(REGMEMO_INITIAL * sizeof(regmemo_T)), FALSE);
+	if (regmemo_table == NULL)
+	{
+	    regmemo_ok = FALSE;
+	    return FALSE;
+	}
+	regmemo_size = REGMEMO_INITIAL;
+	regmemo_used = 0;
+	regmemo_nback = 0;
+    }
+
+    m.rm_scan = scan;
+    m.rm_col = (colnr_T)(rex.input - rex.line);
+    m.rm_backs = 0;
+
+    /* The positions in "backpos" are in the order of the input, the ones at
+     * the current position are at the end. */
+    bp = (backpos_T *)backpos.ga_data;
+    for (i = backpos.ga_len - 1; i >= 0 && reg_save_equal(&bp[i].bp_pos);
+									  --i)
+    {
+	for (j = 0; j < regmemo_nback; ++j)
+	    if (regmemo_back[j] == bp[i].bp_scan)
+		break;
+	if (j == regmemo_nback)
+	{
+	    if (j == REGMEMO_BACKS)
+	    {
+		/* Too many loops, give up. */
+		regmemo_ok = FALSE;
+		return FALSE;
+	    }
+	    regmemo_back[regmemo_nback++] = bp[i].bp_scan;
+	}
+	m.rm_backs |= 1u << j;
+    }
+
+    for (i = REGMEMO_HASH(&m, regmemo_size);
+				regmemo_table[i].rm_scan != NULL;
+					       i = (i + 1) & (regmemo_size - 1))
+	if (regmemo_table[i].rm_scan == scan
+		&& regmemo_table[i].rm_col == m.rm_col
+		&& regmemo_table[i].rm_backs == m.rm_backs)
+	    return TRUE;
+
+    if (regmemo_used * 2 >= regmemo_size)
+    {
+	regmemo_T   *table;
+
+	/* Grow the table.  When at the maximum size, stop remembering. */
+	if (regmemo_size >= REGMEMO_MAX)
+	    return FALSE;
+	table = (regmemo_T *)lalloc_clear(
+			  (long_u)(regmemo_size * 2 * sizeof(regmemo_T)), FALSE);
+	if (table == NULL)
+	    return FALSE;
+	for (j = 0; j < regmemo_size; ++j)
+	    if (regmemo_table[j].rm_scan != NULL)
+		regmemo_add(table, regmemo_size * 2, &regmemo_table[j]);
+	vim_free(regmemo_table);
+	regmemo_table = table;
+	regmemo_size *= 2;
+    }
+    regmemo_add(regmemo_table, regmemo_size, &m);
+    ++regmemo_used;
+    return FALSE;
+}
+
 #if defined(EXITFREE) || defined(PROTO)
     void
 free_regexp_stuff(void)
@@ -3608,6 +3814,7 @@ free_regexp_stuff(void)
     ga_clear(&backpos);
     vim_free(reg_tofree);
     vim_free(reg_prev_sub);
+    regcache_clear();
 }
 #endif
 
@@ -3770,6 +3977,9 @@ bt_regexec_both(
     if (prog_magic_wrong())
 	goto theend;
 
+    regmemo_ok = (prog->regflags & (RF_NESTED | RF_NOMEMO)) == RF_NESTED;
+    regmemo_steps = 0;
+
     /* If the start column is past the maximum column: no need to try. */
     if (rex.reg_maxcol > 0 && col >= rex.reg_maxcol)
 	goto theend;
@@ -3785,7 +3995,16 @@ bt_regexec_both(
 	rex.reg_icombine = TRUE;
 
     /* If there is a "must appear" string, look for it. */
-    if (prog->regmust != NULL)
+    if (prog->regmust != NULL && !rex.reg_icombine
+				    && (!rex.reg_ic || prog->regmust_icok))
+    {
+	if (reg_find_literal(line + col, prog->regmust, prog->regmlen,
+							   rex.reg_ic) == NULL)
+	    goto theend;
+    }
+    /* With "\Z" composing characters are skipped, cstrncmp() could then
+     * read past the end of the line. */
+    else if (prog->regmust != NULL && !rex.reg_icombine)
     {
 	int c;
 
@@ -3919,6 +4138,7 @@ theend:
 	ga_clear(&regstack);
     if (backpos.ga_maxlen > BACKPOS_INITIAL)
 	ga_clear(&backpos);
+    VIM_CLEAR(regmemo_table);
 
     return retval;
 }
@@ -4726,32 +4946,30 @@ regmatch(
 		 * looping without matching any input.  The second and later
 		 * times a BACK is encountered it fails if the input is still
 		 * at the same position as the previous time.
-		 * The positions are stored in "backpos" and found by the
-		 * current value of "scan", the position in the RE program.
+		 * Every time a BACK is passed the position is appended to
+		 * "backpos", found by the current value of "scan", the
+		 * position in the RE program.  Backtracking truncates
+		 * "backpos", thus the previous position is restored.  Updating
+		 * the entry instead would keep a position of a path that
+		 * failed, which could make "\(a*\)*" loop forever.
 		 */
 		bp = (backpos_T *)backpos.ga_data;
-		for (i = 0; i < backpos.ga_len; ++i)
+		for (i = backpos.ga_len - 1; i >= 0; --i)
 		    if (bp[i].bp_scan == scan)
 			break;
-		if (i == backpos.ga_len)
-		{
-		    /* First time at this BACK, make room to store the pos. */
-		    if (ga_grow(&backpos, 1) == FAIL)
-			status = RA_FAIL;
-		    else
-		    {
-			/* get "ga_data" again, it may have changed */
-			bp = (backpos_T *)backpos.ga_data;
-			bp[i].bp_scan = scan;
-			++backpos.ga_len;
-		    }
-		}
-		else if (reg_save_equal(&bp[i].bp_pos))
+		if (i >= 0 && reg_save_equal(&bp[i].bp_pos))
 		    /* Still at same position as last time, fail. */
 		    status = RA_NOMATCH;
-
-		if (status != RA_FAIL && status != RA_NOMATCH)
-		    reg_save(&bp[i].bp_pos, &backpos);
+		else if (ga_grow(&backpos, 1) == FAIL)
+		    status = RA_FAIL;
+		else
+		{
+		    /* get "ga_data" again, it may have changed */
+		    bp = (backpos_T *)backpos.ga_data;
+		    bp[backpos.ga_len].bp_scan = scan;
+		    reg_save(&bp[backpos.ga_len].bp_pos, &backpos);
+		    ++backpos.ga_len;
+		}
 	    }
 	    break;
 
@@ -4974,6 +5192,9 @@ regmatch(
 #endif
 
 	  case BRANCH:
+	    if (regmemo_ok && regmemo_seen(scan))
+		status = RA_NOMATCH;
+	    else
 	    {
 		if (OP(next) != BRANCH) /* No choice. */
 		    next = OPERAND(scan);	/* Avoid recursion. */
@@ -5081,6 +5302,9 @@ regmatch(
 	  case BRACE_SIMPLE:
 	  case STAR:
 	  case PLUS:
+	    if (regmemo_ok && regmemo_seen(scan))
+		status = RA_NOMATCH;
+	    else
 	    {
 		regstar_T	rst;
 
@@ -7070,6 +7294,118 @@ cstrchr(char_u *s, int c)
     return NULL;
 }
 
+/*
+ * Return TRUE when the literal "lit[len]" can be found with
+ * reg_find_literal() when ignoring case.  Only ASCII is folded there.  Also
+ * not for "i", "k" and "s": the Turkish dotted I, the Kelvin sign and the long
+ * s fold to them.
+ */
+    static int
+reg_literal_icok(char_u *lit, int len)
+{
+    int	    i;
+
+    for (i = 0; i < len; ++i)
+	if (lit[i] >= 0x80 || vim_strchr((char_u *)"iIkKsS", lit[i]) != NULL)
+	    return FALSE;
+    return TRUE;
+}
+
+/*
+ * Return TRUE if "s" starts with "lit[len]".  When "ic" is TRUE ignore case
+ * of ASCII letters.
+ */
+    static int
+reg_literal_equal(char_u *s, char_u *lit, int len, int ic)
+{
+    int	    i;
+
+    if (!ic)
+	return memcmp(s, lit, (size_t)len) == 0;
+    for (i = 0; i < len; ++i)
+	if (s[i] != lit[i] && !(ASCII_ISALPHA(lit[i])
+					     && (s[i] | 0x20) == (lit[i] | 0x20)))
+	    return FALSE;
+    return TRUE;
+}
+
+/*
+ * Find the literal string "lit[len]" in "s".  When "ic" is TRUE ignore case
+ * of ASCII letters, reg_literal_icok() must have returned TRUE for "lit".
+ * Returns a pointer to the first occurrence, NULL when not found.
+ * This is used for every line with ":global" and 'hlsearch', keep it fast!
+ * The end of "s" is found in chunks of growing size, so that the time spent
+ * depends on where "lit" is found and not on the length of "s".  Otherwise
+ * ":s/x/y/g" on a long line would take quadratic time.
+ */
+    static char_u *
+reg_find_literal(char_u *s, char_u *lit, int len, int ic)
+{
+    size_t	known = 0;	    /* no NUL in s[0 .. known - 1] */
+    size_t	chunk = REG_FIND_CHUNK;
+    size_t	lim;		    /* "lit" can start before this */
+    size_t	i = 0;
+    int		at_end = FALSE;
+    char_u	*p;
+    int		first = lit[0];
+    int		last = lit[len - 1];
+    int		fmask = ic && ASCII_ISALPHA(first) ? 0x20 : 0;
+    int		lmask = ic && ASCII_ISALPHA(last) ? 0x20 : 0;
+#ifdef USE_SSE2_SCAN
+    __m128i	vfirst = _mm_set1_epi8((char)(first | fmask));
+    __m128i	vlast = _mm_set1_epi8((char)(last | lmask));
+    __m128i	vfmask = _mm_set1_epi8((char)fmask);
+    __m128i	vlmask = _mm_set1_epi8((char)lmask);
+    int		mask;
+    int		j;
+#endif
+
+    while (!at_end)
+    {
+	p = (char_u *)memchr(s + known, NUL, chunk);
+	if (p != NULL)
+	{
+	    known = (size_t)(p - s);
+	    at_end = TRUE;
+	}
+	else
+	{
+	    known += chunk;
+	    chunk *= 2;
+	}
+	if (known < (size_t)len)
+	    continue;
+	lim = known - len + 1;
+
+#ifdef USE_SSE2_SCAN
+	/* Compare the first and the last byte of "lit" at 16 positions at a
+	 * time, only where both match compare the whole string. */
+	for ( ; i + 16 <= lim; i += 16)
+	{
+	    mask = _mm_movemask_epi8(_mm_and_si128(
+		    _mm_cmpeq_epi8(_mm_or_si128(
+			    _mm_loadu_si128((__m128i *)(s + i)), vfmask),
+								      vfirst),
+		    _mm_cmpeq_epi8(_mm_or_si128(
+			    _mm_loadu_si128((__m128i *)(s + i + len - 1)),
+							      vlmask), vlast)));
+	    for (j = 0; mask != 0; ++j, mask >>= 1)
+		if ((mask & 1) && reg_literal_equal(s + i + j, lit, len, ic))
+		    return s + i + j;
+	}
+	/* The rest is done with the next chunk, unless this is the end. */
+	if (!at_end)
+	    continue;
+#endif
+	for ( ; i < lim; ++i)
+	    if ((s[i] | fmask) == (first | fmask)
+		    && (s[i + len - 1] | lmask) == (last | lmask)
+		    && reg_literal_equal(s + i, lit, len, ic))
+		return s + i;
+    }
+    return NULL;
+}
+
 /***************************************************************
  *		      regsub stuff			       *
  ***************************************************************/
@@ -7930,6 +8266,7 @@ static regengine_T bt_regengine =
 {
     bt_regcomp,
     bt_regfree,
+    bt_regdup,
     bt_regexec_nl,
     bt_regexec_multi,
     (char_u *)""
@@ -7941,6 +8278,7 @@ static regengine_T nfa_regengine =
 {
     nfa_regcomp,
     nfa_regfree,
+    nfa_regdup,
     nfa_regexec_nl,
     nfa_regexec_multi,
     (char_u *)""
@@ -7959,13 +8297,191 @@ static char_u regname[][30] = {
 #endif
 
 /*
- * Compile a regular expression into internal code.
- * Returns the program in allocated memory.
- * Use vim_regfree() to free the memory.
- * Returns NULL for an error.
+ * Cache of compiled programs, so that functions like match() and
+ * substitute() don't compile the same pattern again every time they are
+ * called.  vim_regfree() puts a program in the cache instead of freeing it,
+ * vim_regcomp() takes it out again.  Thus a program that is in use is never
+ * in the cache and can't be handed out twice.
  */
-    regprog_T *
-vim_regcomp(char_u *expr_arg, int re_flags)
+#define REGCACHE_SIZE	32
+
+/*
+ * Everything that the compiled program depends on.
+ */
+struct regcache_key_S
+{
+    hash_T	rk_hash;	/* hash of rk_pat */
+    int		rk_flags;	/* "re_flags" argument of vim_regcomp() */
+    int		rk_engine;	/* 'regexpengine' */
+    int		rk_cpo;		/* relevant 'cpoptions' flags */
+    int		rk_enc;		/* enc_utf8 and enc_dbcs */
+    int		rk_extmatch;	/* reg_do_extmatch */
+    char_u	rk_pat[1];	/* the pattern, actually longer */
+};
+
+/* Most recently used program first. */
+static regprog_T    *regcache[REGCACHE_SIZE];
+static int	    regcache_len = 0;
+
+static long	    regcache_hits = 0;
+static long	    regcache_misses = 0;
+static long	    regcache_evictions = 0;
+
+/*
+ * Return a key for the regexp cache for pattern "expr" compiled with
+ * "re_flags" with the current option values.
+ * Returns NULL when the program can't be cached.
+ */
+    static regcache_key_T *
+regcache_make_key(char_u *expr, int re_flags)
+{
+    regcache_key_T  *key;
+    char_u	    *p;
+
+    /* "~" is replaced with the last substitute string and the backtracking
+     * engine stores the characters of [:keyword:], [:ident:], [:fname:] and
+     * [:print:] when compiling, these depend on more than what is in the
+     * key. */
+    if (vim_strchr(expr, '~') != NULL)
+	return NULL;
+    for (p = expr; (p = vim_strchr(p, '[')) != NULL; ++p)
+	if (STRNCMP(p, "[:keyword:]", 11) == 0
+		|| STRNCMP(p, "[:ident:]", 9) == 0
+		|| STRNCMP(p, "[:fname:]", 9) == 0
+		|| STRNCMP(p, "[:print:]", 9) == 0)
+	    return NULL;
+
+    key = (regcache_key_T *)alloc((unsigned)(sizeof(regcache_key_T)
+							      + STRLEN(expr)));
+    if (key == NULL)
+	return NULL;
+    STRCPY(key->rk_pat, expr);
+    key->rk_hash = hash_hash(key->rk_pat);
+    key->rk_flags = re_flags;
+    key->rk_engine = p_re;
+    key->rk_cpo = (vim_strchr(p_cpo, CPO_LITERAL) != NULL)
+				+ (vim_strchr(p_cpo, CPO_BACKSL) != NULL) * 2;
+    key->rk_enc = enc_utf8 + enc_dbcs * 2;
+#ifdef FEAT_SYN_HL
+    key->rk_extmatch = reg_do_extmatch;
+#else
+    key->rk_extmatch = 0;
+#endif
+    return key;
+}
+
+    static int
+regcache_key_equal(regcache_key_T *k1, regcache_key_T *k2)
+{
+    return k1->rk_hash == k2->rk_hash
+	&& k1->rk_flags == k2->rk_flags
+	&& k1->rk_engine == k2->rk_engine
+	&& k1->rk_cpo == k2->rk_cpo
+	&& k1->rk_enc == k2->rk_enc
+	&& k1->rk_extmatch == k2->rk_extmatch
+	&& STRCMP(k1->rk_pat, k2->rk_pat) == 0;
+}
+
+/*
+ * Find a program for "key" in the cache and remove it from the cache.
+ * Returns NULL when not found.
+ */
+    static regprog_T *
+regcache_lookup(regcache_key_T *key)
+{
+    int		i;
+    regprog_T	*prog;
+
+    for (i = 0; i < regcache_len; ++i)
+	if (regcache_key_equal(regcache[i]->re_cache_key, key))
+	{
+	    prog = regcache[i];
+	    --regcache_len;
+	    mch_memmove(regcache + i, regcache + i + 1,
+					(regcache_len - i) * sizeof(regprog_T *));
+	    ++regcache_hits;
+	    return prog;
+	}
+    ++regcache_misses;
+    return NULL;
+}
+
+/*
+ * Really free compiled program "prog".
+ */
+    static void
+regprog_free(regprog_T *prog)
+{
+    vim_free(prog->re_cache_key);
+    prog->engine->regfree(prog);
+}
+
+/*
+ * Add "prog" to the cache, freeing the least recently used program when the
+ * cache is full.
+ */
+    static void
+regcache_add(regprog_T *prog)
+{
+    if (regcache_len == REGCACHE_SIZE)
+    {
+	regprog_free(regcache[--regcache_len]);
+	++regcache_evictions;
+    }
+    mch_memmove(regcache + 1, regcache, regcache_len * sizeof(regprog_T *));
+    regcache[0] = prog;
+    ++regcache_len;
+}
+
+/*
+ * Give "prog" the cache key "key", replacing the key it had.
+ * When "prog" is NULL "key" is freed.
+ */
+    static void
+regcache_set_key(regprog_T *prog, regcache_key_T *key)
+{
+    if (prog == NULL)
+	vim_free(key);
+    else
+    {
+	vim_free(prog->re_cache_key);
+	prog->re_cache_key = key;
+    }
+}
+
+#if defined(EXITFREE) || defined(PROTO)
+/*
+ * Free all the programs in the regexp cache.
+ */
+    static void
+regcache_clear(void)
+{
+    while (regcache_len > 0)
+	regprog_free(regcache[--regcache_len]);
+}
+#endif
+
+#if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * Add information about the regexp cache to "dict".
+ */
+    void
+regcache_info(dict_T *dict)
+{
+    dict_add_number(dict, "size", REGCACHE_SIZE);
+    dict_add_number(dict, "entries", regcache_len);
+    dict_add_number(dict, "hits", regcache_hits);
+    dict_add_number(dict, "misses", regcache_misses);
+    dict_add_number(dict, "evictions", regcache_evictions);
+}
+#endif
+
+/*
+ * Compile regular expression "expr_arg" with the engine selected by
+ * 'regexpengine' or the "\%#=" prefix, without using the cache.
+ */
+    static regprog_T *
+regcomp_engine(char_u *expr_arg, int re_flags)
 {
     regprog_T   *prog = NULL;
     char_u	*expr = expr_arg;
@@ -8056,16 +8572,92 @@ vim_regcomp(char_u *expr_arg, int re_flags)
     return prog;
 }
 
+/*
+ * Compile a regular expression into internal code.
+ * Returns the program in allocated memory.
+ * Use vim_regfree() to free the memory.
+ * Returns NULL for an error.
+ */
+    regprog_T *
+vim_regcomp(char_u *expr_arg, int re_flags)
+{
+    regprog_T	    *prog;
+    regcache_key_T  *key;
+    int		    save_called_emsg;
+
+    key = regcache_make_key(expr_arg, re_flags);
+    if (key != NULL)
+    {
+	prog = regcache_lookup(key);
+	if (prog != NULL)
+	{
+	    vim_free(key);
+	    return prog;
+	}
+    }
+
+    save_called_emsg = called_emsg;
+    called_emsg = FALSE;
+    prog = regcomp_engine(expr_arg, re_flags);
+    if (prog != NULL)
+    {
+	/* Don't cache when there was an error, the message must be given
+	 * again next time. */
+	prog->re_cache_key = NULL;
+	if (!called_emsg)
+	{
+	    prog->re_cache_key = key;
+	    key = NULL;
+	}
+    }
+    vim_free(key);
+    called_emsg |= save_called_emsg;
+
+    return prog;
+}
+
 /*
  * Free a compiled regexp program, returned by vim_regcomp().
+ * It is kept in the regexp cache for when the same pattern is compiled
+ * again.
  */
     void
 vim_regfree(regprog_T *prog)
 {
-    if (prog != NULL)
-	prog->engine->regfree(prog);
+    if (prog == NULL)
+	return;
+    if (prog->re_cache_key != NULL && !prog->re_in_use)
+	regcache_add(prog);
+    else
+	regprog_free(prog);
 }
 
+#if defined(FEAT_SYN_HL) || defined(PROTO)
+/*
+ * Return a copy of compiled regexp program "prog", for using it while "prog"
+ * is also still used.  Returns NULL when out of memory.
+ */
+    regprog_T *
+vim_regdup(regprog_T *prog)
+{
+    regprog_T	*copy;
+    size_t	len;
+
+    copy = prog->engine->regdup(prog);
+    if (copy == NULL)
+	return NULL;
+    copy->re_in_use = FALSE;
+    if (prog->re_cache_key != NULL)
+    {
+	len = sizeof(regcache_key_T) + STRLEN(prog->re_cache_key->rk_pat);
+	copy->re_cache_key = (regcache_key_T *)alloc((unsigned)len);
+	if (copy->re_cache_key != NULL)
+	    mch_memmove(copy->re_cache_key, prog->re_cache_key, len);
+    }
+    return copy;
+}
+#endif
+
 #ifdef FEAT_EVAL
     static void
 report_re_switch(char_u *pat)
@@ -8092,6 +8684,50 @@ regprog_in_use(regprog_T *prog)
 }
 #endif
 
+#if defined(FEAT_SYN_HL) || defined(FEAT_QUICKFIX) || defined(PROTO)
+/*
+ * Return the literal text that must appear in the line where a match of
+ * "prog" starts, at or after the start column, or NULL when there is none or
+ * it can't be found with a plain byte compare.
+ * "*icp" is the ignore-case flag the program will be used with, it is
+ * updated for "\c" and "\C".  The length of the text is stored in "*lenp".
+ * The text is owned by "prog" and only valid while it is not freed.
+ */
+    char_u *
+vim_regprog_literal(regprog_T *prog, int *icp, int *lenp)
+{
+    char_u  *lit = NULL;
+    int	    icok = FALSE;
+
+    if (prog == NULL || (prog->regflags & RF_ICOMBINE))
+	return NULL;
+    if (prog->regflags & RF_ICASE)
+	*icp = TRUE;
+    else if (prog->regflags & RF_NOICASE)
+	*icp = FALSE;
+
+    if (prog->engine == &bt_regengine)
+    {
+	bt_regprog_T *bt = (bt_regprog_T *)prog;
+
+	lit = bt->regmust;
+	*lenp = bt->regmlen;
+	icok = bt->regmust_icok;
+    }
+    else if (prog->engine == &nfa_regengine)
+    {
+	nfa_regprog_T *nfa = (nfa_regprog_T *)prog;
+
+	lit = nfa->reglit;
+	*lenp = nfa->reglitlen;
+	icok = nfa->reglit_icok;
+    }
+    if (lit == NULL || *lenp <= 0 || (*icp && !icok))
+	return NULL;
+    return lit;
+}
+#endif
+
 /*
  * Match a regexp against a string.
  * "rmp->regprog" is a compiled regexp as returned by vim_regcomp().
@@ -8140,8 +8776,11 @@ vim_regexec_string(
 	int    save_p_re = p_re;
 	int    re_flags = rmp->regprog->re_flags;
 	char_u *pat = vim_strsave(((nfa_regprog_T *)rmp->regprog)->pattern);
+	regcache_key_T *key = rmp->regprog->re_cache_key;
 
 	p_re = BACKTRACKING_ENGINE;
+	// Don't cache the slow program, cache the new one with its key.
+	rmp->regprog->re_cache_key = NULL;
 	vim_regfree(rmp->regprog);
 	if (pat != NULL)
 	{
@@ -8149,6 +8788,7 @@ vim_regexec_string(
 	    report_re_switch(pat);
 #endif
 	    rmp->regprog = vim_regcomp(pat, re_flags);
+	    regcache_set_key(rmp->regprog, key);
 	    if (rmp->regprog != NULL)
 	    {
 		rmp->regprog->re_in_use = TRUE;
@@ -8157,6 +8797,8 @@ vim_regexec_string(
 	    }
 	    vim_free(pat);
 	}
+	else
+	    vim_free(key);
 
 	p_re = save_p_re;
     }
@@ -8260,8 +8902,11 @@ vim_regexec_multi(
 	int    save_p_re = p_re;
 	int    re_flags = rmp->regprog->re_flags;
 	char_u *pat = vim_strsave(((nfa_regprog_T *)rmp->regprog)->pattern);
+	regcache_key_T *key = rmp->regprog->re_cache_key;
 
 	p_re = BACKTRACKING_ENGINE;
+	// Don't cache the slow program, cache the new one with its key.
+	rmp->regprog->re_cache_key = NULL;
 	vim_regfree(rmp->regprog);
 	if (pat != NULL)
 	{
@@ -8277,6 +8922,7 @@ vim_regexec_multi(
 #ifdef FEAT_SYN_HL
 	    reg_do_extmatch = 0;
 #endif
+	    regcache_set_key(rmp->regprog, key);
 
 	    if (rmp->regprog != NULL)
 	    {
@@ -8287,6 +8933,8 @@ vim_regexec_multi(
 	    }
 	    vim_free(pat);
 	}
+	else
+	    vim_free(key);
 	p_re = save_p_re;
     }
 
@@ -40,6 +40,7 @@
 #define	    NFA_ENGINE		2
 
 typedef struct regengine regengine_T;
+typedef struct regcache_key_S regcache_key_T;
 
 /*
  * Structure returned by vim_regcomp() to pass on to vim_regexec().
@@ -53,6 +54,7 @@ typedef struct regprog
     unsigned		re_engine;   // automatic, backtracking or nfa engine
     unsigned		re_flags;    // second argument for vim_regcomp()
     int			re_in_use;   // prog is being executed
+    regcache_key_T	*re_cache_key; // key for the regexp cache or NULL
 } regprog_T;
 
 /*
@@ -68,11 +70,14 @@ typedef struct
     unsigned		re_engine;
     unsigned		re_flags;
     int			re_in_use;
+    regcache_key_T	*re_cache_key;
 
+    long		regsize;	/* size of program[] */
     int			regstart;
     char_u		reganch;
     char_u		*regmust;
     int			regmlen;
+    char_u		regmust_icok;	/* regmust works when ignoring case */
 #ifdef FEAT_SYN_HL
     char_u		reghasz;
 #endif
@@ -105,18 +110,27 @@ typedef struct
     unsigned		re_engine;
     unsigned		re_flags;
     int			re_in_use;
+    regcache_key_T	*re_cache_key;
 
     nfa_state_T		*start;		/* points into state[] */
 
     int			reganch;	/* pattern starts with ^ */
     int			regstart;	/* char at start of pattern */
     char_u		*match_text;	/* plain text to match with */
+    char_u		*reglit;	/* literal text that must appear in a
+					 * match or NULL */
+    int			reglitlen;	/* length of "reglit" */
+    int			reglit_icok;	/* "reglit" works when ignoring case */
+    int			reglit_start;	/* match starts with "reglit" */
 
     int			has_zend;	/* pattern contains \ze */
     int			has_backref;	/* pattern contains \1 .. \9 */
 #ifdef FEAT_SYN_HL
     int			reghasz;
 #endif
+    int			dfa_flags;	/* DFA_ flags, zero when the DFA can't
+					 * be used for this pattern */
+    struct nfa_dfa_S	*dfa;		/* lazily built DFA or NULL */
     char_u		*pattern;
     int			nsubexp;	/* number of () */
     int			nstate;
@@ -168,6 +182,7 @@ struct regengine
 {
     regprog_T	*(*regcomp)(char_u*, int);
     void	(*regfree)(regprog_T *);
+    regprog_T	*(*regdup)(regprog_T *);
     int		(*regexec_nl)(regmatch_T *, char_u *, colnr_T, int);
     long	(*regexec_multi)(regmmatch_T *, win_T *, buf_T *, linenr_T, colnr_T, proftime_T *, int *);
     char_u	*expr;
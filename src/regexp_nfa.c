@@ -501,6 +501,228 @@ nfa_get_match_text(nfa_state_T *start)
     return ret;
 }
 
+/*
+ * Store the states that directly follow "p" when matching in "next[]", skip
+ * over the contents of collections and of look-ahead and look-behind.
+ * Returns the number of states, -1 when "p" can match a line break.
+ */
+    static int
+nfa_lit_next(nfa_state_T *p, nfa_state_T **next)
+{
+    switch (p->c)
+    {
+	case NFA_MATCH:
+	    return 0;
+
+	case NFA_SPLIT:
+	    next[0] = p->out;
+	    next[1] = p->out1;
+	    return 2;
+
+	case NFA_NEWL:
+	    return -1;
+
+	case NFA_START_COLL:
+	case NFA_START_NEG_COLL:
+	case NFA_START_INVISIBLE:
+	case NFA_START_INVISIBLE_FIRST:
+	case NFA_START_INVISIBLE_NEG:
+	case NFA_START_INVISIBLE_NEG_FIRST:
+	case NFA_START_INVISIBLE_BEFORE:
+	case NFA_START_INVISIBLE_BEFORE_FIRST:
+	case NFA_START_INVISIBLE_BEFORE_NEG:
+	case NFA_START_INVISIBLE_BEFORE_NEG_FIRST:
+	case NFA_START_PATTERN:
+	case NFA_COMPOSING:
+	    /* out1 is the matching end state */
+	    next[0] = p->out1->out;
+	    return 1;
+
+	default:
+	    if (p->out == NULL)
+		return 0;
+	    next[0] = p->out;
+	    return 1;
+    }
+}
+
+/*
+ * Return TRUE when NFA_MATCH can be reached from "start" without going
+ * through state "avoid".  "seen" and "stack" have room for all states.
+ */
+    static int
+nfa_lit_match_avoiding(
+    nfa_regprog_T	*prog,
+    nfa_state_T		*avoid,
+    char_u		*seen,
+    nfa_state_T		**stack)
+{
+    int		sp = 0;
+    int		n, i;
+    nfa_state_T	*p;
+    nfa_state_T	*next[2];
+
+    vim_memset(seen, 0, (size_t)prog->nstate);
+    seen[avoid - prog->state] = TRUE;
+    seen[prog->start - prog->state] = TRUE;
+    stack[sp++] = prog->start;
+    while (sp > 0)
+    {
+	p = stack[--sp];
+	if (p->c == NFA_MATCH)
+	    return TRUE;
+	n = nfa_lit_next(p, next);
+	for (i = 0; i < n; ++i)
+	    if (!seen[next[i] - prog->state])
+	    {
+		seen[next[i] - prog->state] = TRUE;
+		stack[sp++] = next[i];
+	    }
+    }
+    return FALSE;
+}
+
+/*
+ * Skip over states that don't consume a character and have only one
+ * following state, starting at "p".
+ */
+    static nfa_state_T *
+nfa_lit_skip_zero_width(nfa_state_T *p)
+{
+    for (;;)
+    {
+	switch (p->c)
+	{
+	    case NFA_EMPTY:
+	    case NFA_BOL:
+	    case NFA_EOL:
+	    case NFA_BOW:
+	    case NFA_EOW:
+	    case NFA_BOF:
+	    case NFA_EOF:
+	    case NFA_ZSTART:
+	    case NFA_ZEND:
+	    case NFA_NOPEN:
+	    case NFA_NCLOSE:
+		p = p->out;
+		continue;
+	}
+	if (p->c >= NFA_MOPEN && p->c <= NFA_MCLOSE9)
+	    p = p->out;
+#ifdef FEAT_SYN_HL
+	else if (p->c >= NFA_ZOPEN && p->c <= NFA_ZCLOSE9)
+	    p = p->out;
+#endif
+	else
+	    return p;
+    }
+}
+
+/* Don't spend time on finding a literal in very big patterns. */
+#define NFA_LIT_MAX_STATES  500
+/* Maximum length of the literal, in bytes. */
+#define NFA_LIT_MAX_LEN	    200
+
+/*
+ * Find the longest literal string that must appear in every match of "prog"
+ * and store it in prog->reglit.  This also works when there are several
+ * ways through the pattern, e.g. "baz" is found for "\(foo\|bar\)baz".
+ * Not when the pattern can match a line break, the string may be in another
+ * line then.
+ */
+    static void
+nfa_get_literal(nfa_regprog_T *prog)
+{
+    char_u	*seen;
+    nfa_state_T	**stack;
+    nfa_state_T	**lits;
+    nfa_state_T	*next[2];
+    nfa_state_T	*p;
+    int		sp = 0;
+    int		nlits = 0;
+    int		n, i;
+    char_u	buf[NFA_LIT_MAX_LEN + MB_MAXBYTES + 1];
+    char_u	best[NFA_LIT_MAX_LEN + MB_MAXBYTES + 1];
+    int		len;
+    int		bestlen = 0;
+    nfa_state_T	*beststate = NULL;
+    unsigned	size = (unsigned)(prog->nstate * sizeof(nfa_state_T *));
+
+    prog->reglit = NULL;
+    prog->reglitlen = 0;
+    prog->reglit_icok = FALSE;
+    prog->reglit_start = FALSE;
+    if (prog->nstate > NFA_LIT_MAX_STATES)
+	return;
+    seen = alloc_clear((unsigned)prog->nstate);
+    stack = (nfa_state_T **)alloc(size);
+    lits = (nfa_state_T **)alloc(size);
+    if (seen == NULL || stack == NULL || lits == NULL)
+	goto theend;
+
+    /* Find the characters that can be matched. */
+    seen[prog->start - prog->state] = TRUE;
+    stack[sp++] = prog->start;
+    while (sp > 0)
+    {
+	p = stack[--sp];
+	if (p->c > 0)
+	    lits[nlits++] = p;
+	n = nfa_lit_next(p, next);
+	if (n < 0)
+	    goto theend;
+	for (i = 0; i < n; ++i)
+	    if (!seen[next[i] - prog->state])
+	    {
+		seen[next[i] - prog->state] = TRUE;
+		stack[sp++] = next[i];
+	    }
+    }
+
+    for (i = 0; i < nlits; ++i)
+    {
+	/* Skip characters that a match doesn't need to go through. */
+	if (nfa_lit_match_avoiding(prog, lits[i], seen, stack))
+	    continue;
+
+	/* The characters that directly follow are also in every match. */
+	len = 0;
+	for (p = lits[i]; p->c > 0 && len < NFA_LIT_MAX_LEN;
+					  p = nfa_lit_skip_zero_width(p->out))
+	{
+	    if (has_mbyte)
+		len += (*mb_char2bytes)(p->c, buf + len);
+	    else
+		buf[len++] = p->c;
+	}
+	if (len > bestlen)
+	{
+	    bestlen = len;
+	    mch_memmove(best, buf, (size_t)len);
+	    beststate = lits[i];
+	}
+    }
+
+    if (bestlen > 0)
+    {
+	prog->reglit = vim_strnsave(best, bestlen);
+	if (prog->reglit != NULL)
+	{
+	    prog->reglitlen = bestlen;
+	    prog->reglit_icok = reg_literal_icok(best, bestlen);
+	    /* When the match always starts with the literal a search can skip
+	     * ahead to it. */
+	    prog->reglit_start =
+		     nfa_lit_skip_zero_width(prog->start) == beststate;
+	}
+    }
+
+theend:
+    vim_free(seen);
+    vim_free(stack);
+    vim_free(lits);
+}
+
 /*
  * Allocate more space for post_start.  Called when
  * running above the estimated number of states.
@@ -6969,6 +7191,606 @@ theend:
     return nfa_match;
 }
 
+/*
+ * Lazy DFA.
+ *
+ * For a pattern without backreferences, look-around, composing characters,
+ * line breaks and position items like "\%V" a DFA is built while matching.
+ * A DFA state is the set of NFA states reached after consuming a character.
+ * The start state is implicitly added at every position, thus the DFA finds
+ * a match anywhere in the line.  Zero-width items ("^", "$", "\<" and "\>")
+ * depend on the next character, therefore the closure over the NFA states is
+ * computed when making a transition, not when creating a DFA state.
+ *
+ * The DFA only finds out whether the line contains a match and the column
+ * where the leftmost match can start at the earliest.  It does not keep
+ * submatches, nfa_regmatch() is used for that, starting at that column.
+ * When there is no match nfa_regmatch() is not used at all.
+ *
+ * Transitions are cached for ASCII characters, other characters are
+ * computed every time.  When there are too many states the cache is flushed.
+ */
+
+#define DFA_USABLE	1	/* pattern can use the DFA */
+#define DFA_USE_BOL	2	/* pattern contains "^" */
+#define DFA_USE_CLASS	4	/* pattern contains "\<" or "\>" */
+#define DFA_USE_ISK	8	/* pattern depends on 'iskeyword' */
+
+#define DFA_NCHARS	128	/* number of cached transitions per state */
+#define DFA_HASH_SIZE	256	/* number of hash buckets, power of two */
+#define DFA_MAX_STATES	400	/* flush the cache when reaching this */
+#define DFA_MAX_FAILED	5	/* stop using the DFA after this many */
+
+/* Return values of nfa_dfa_search() */
+#define DFA_NOMATCH	0	/* there is no match in the line */
+#define DFA_MATCH	1	/* there is a match in the line */
+#define DFA_UNKNOWN	2	/* DFA gave up, use the NFA */
+
+typedef struct nfa_dfa_state_S nfa_dfa_state_T;
+struct nfa_dfa_state_S
+{
+    nfa_dfa_state_T *next[DFA_NCHARS];	/* cached transitions or NULL */
+    nfa_dfa_state_T *hash_next;		/* next state in the hash bucket */
+    int		    at_bol;		/* at the start of the line */
+    int		    prev_class;		/* class of the previous character */
+    int		    nids;		/* number of entries in ids[] */
+    int		    ids[1];		/* NFA state indexes, sorted,
+					   actually longer */
+};
+
+typedef struct nfa_dfa_S nfa_dfa_T;
+struct nfa_dfa_S
+{
+    nfa_dfa_state_T *hash[DFA_HASH_SIZE];
+    int		    nstates;		/* number of states in hash[] */
+    nfa_dfa_state_T *matched;		/* result of a transition where the
+					   pattern matches, not in hash[] */
+    int		    reg_ic;		/* "rex.reg_ic" used for the states */
+    char_u	    chartab[32];	/* b_chartab used for the states */
+    int		    flushes;		/* number of times hash[] was flushed */
+    long	    scanned;		/* characters scanned since the last
+					   check for too many flushes */
+    int		    failed;		/* number of times the DFA gave up */
+    unsigned	    gen;		/* current generation in mark[] */
+    unsigned	    *mark;		/* closure generation per NFA state */
+    unsigned	    *next_mark;		/* next set generation per NFA state */
+    int		    *stack;		/* closure stack */
+    int		    *ids;		/* NFA states of the next DFA state */
+};
+
+/*
+ * Check whether the DFA can be used for "prog".
+ * Returns DFA_ flags, zero when the pattern contains an item the DFA can't
+ * handle.
+ */
+    static int
+nfa_dfa_flags(nfa_regprog_T *prog)
+{
+    int		flags = DFA_USABLE;
+    char_u	*seen;
+    nfa_state_T	**stack;
+    int		sp = 0;
+    nfa_state_T	*state;
+
+    if (prog->has_backref || prog->nstate == 0)
+	return 0;
+    seen = alloc_clear((unsigned)prog->nstate);
+    stack = (nfa_state_T **)alloc(
+			       (unsigned)(prog->nstate * sizeof(nfa_state_T *)));
+    if (seen == NULL || stack == NULL)
+    {
+	vim_free(seen);
+	vim_free(stack);
+	return 0;
+    }
+
+    seen[prog->start - prog->state] = TRUE;
+    stack[sp++] = prog->start;
+    while (sp > 0 && flags != 0)
+    {
+	state = stack[--sp];
+	switch (state->c)
+	{
+	    case NFA_BOL:
+		flags |= DFA_USE_BOL;
+		break;
+
+	    case NFA_BOW:
+	    case NFA_EOW:
+		flags |= DFA_USE_CLASS | DFA_USE_ISK;
+		break;
+
+	    case NFA_KWORD:
+	    case NFA_SKWORD:
+	    case NFA_CLASS_KEYWORD:
+		flags |= DFA_USE_ISK;
+		break;
+
+	    case NFA_SPLIT:
+	    case NFA_MATCH:
+	    case NFA_EMPTY:
+	    case NFA_EOL:
+	    case NFA_ZSTART:
+	    case NFA_ZEND:
+	    case NFA_NOPEN:
+	    case NFA_NCLOSE:
+	    case NFA_START_COLL:
+	    case NFA_START_NEG_COLL:
+	    case NFA_END_COLL:
+	    case NFA_RANGE_MIN:
+	    case NFA_RANGE_MAX:
+	    case NFA_ANY:
+		break;
+
+	    /* Depend on options other than 'iskeyword'. */
+	    case NFA_IDENT:
+	    case NFA_SIDENT:
+	    case NFA_FNAME:
+	    case NFA_SFNAME:
+	    case NFA_PRINT:
+	    case NFA_SPRINT:
+	    case NFA_CLASS_IDENT:
+	    case NFA_CLASS_FNAME:
+	    case NFA_CLASS_PRINT:
+		flags = 0;
+		break;
+
+	    default:
+		if (state->c >= 0
+			|| (state->c >= NFA_MOPEN && state->c <= NFA_MCLOSE9)
+#ifdef FEAT_SYN_HL
+			|| (state->c >= NFA_ZOPEN && state->c <= NFA_ZCLOSE9)
+#endif
+			|| (state->c >= NFA_WHITE && state->c <= NFA_NUPPER_IC)
+			|| (state->c >= NFA_CLASS_ALNUM
+					       && state->c <= NFA_CLASS_FNAME))
+		    break;
+		/* Backreferences, look-around, composing characters, line
+		 * breaks, line and column numbers, marks, etc. */
+		flags = 0;
+		break;
+	}
+
+	if (state->out != NULL && !seen[state->out - prog->state])
+	{
+	    seen[state->out - prog->state] = TRUE;
+	    stack[sp++] = state->out;
+	}
+	if (state->out1 != NULL && !seen[state->out1 - prog->state])
+	{
+	    seen[state->out1 - prog->state] = TRUE;
+	    stack[sp++] = state->out1;
+	}
+    }
+
+    vim_free(seen);
+    vim_free(stack);
+    return flags;
+}
+
+/*
+ * Free all the states of "dfa".
+ */
+    static void
+nfa_dfa_flush(nfa_dfa_T *dfa)
+{
+    int			i;
+    nfa_dfa_state_T	*ds;
+
+    for (i = 0; i < DFA_HASH_SIZE; ++i)
+	while (dfa->hash[i] != NULL)
+	{
+	    ds = dfa->hash[i];
+	    dfa->hash[i] = ds->hash_next;
+	    vim_free(ds);
+	}
+    dfa->nstates = 0;
+    ++dfa->flushes;
+}
+
+    static void
+nfa_dfa_free(nfa_dfa_T *dfa)
+{
+    if (dfa == NULL)
+	return;
+    nfa_dfa_flush(dfa);
+    vim_free(dfa->matched);
+    vim_free(dfa->mark);
+    vim_free(dfa->next_mark);
+    vim_free(dfa->stack);
+    vim_free(dfa->ids);
+    vim_free(dfa);
+}
+
+    static nfa_dfa_T *
+nfa_dfa_new(nfa_regprog_T *prog)
+{
+    nfa_dfa_T	*dfa;
+    unsigned	size = (unsigned)((prog->nstate + 1) * sizeof(int));
+
+    dfa = (nfa_dfa_T *)alloc_clear((unsigned)sizeof(nfa_dfa_T));
+    if (dfa == NULL)
+	return NULL;
+    dfa->matched = (nfa_dfa_state_T *)alloc_clear(
+					   (unsigned)sizeof(nfa_dfa_state_T));
+    dfa->mark = (unsigned *)alloc_clear(size);
+    dfa->next_mark = (unsigned *)alloc_clear(size);
+    dfa->stack = (int *)alloc(size);
+    dfa->ids = (int *)alloc(size);
+    if (dfa->matched == NULL || dfa->mark == NULL || dfa->next_mark == NULL
+				      || dfa->stack == NULL || dfa->ids == NULL)
+    {
+	nfa_dfa_free(dfa);
+	return NULL;
+    }
+    return dfa;
+}
+
+/*
+ * Find or add the DFA state with NFA states dfa->ids[n].
+ * Returns NULL when out of memory.
+ */
+    static nfa_dfa_state_T *
+nfa_dfa_lookup(nfa_dfa_T *dfa, int n, int at_bol, int prev_class)
+{
+    long_u		hash = (long_u)prev_class * 31 + at_bol;
+    int			i;
+    nfa_dfa_state_T	*ds;
+
+    for (i = 0; i < n; ++i)
+	hash = hash * 67 + dfa->ids[i];
+    hash &= DFA_HASH_SIZE - 1;
+
+    for (ds = dfa->hash[hash]; ds != NULL; ds = ds->hash_next)
+	if (ds->nids == n && ds->at_bol == at_bol
+		&& ds->prev_class == prev_class
+		&& memcmp(ds->ids, dfa->ids, n * sizeof(int)) == 0)
+	    return ds;
+
+    ds = (nfa_dfa_state_T *)alloc_clear((unsigned)(sizeof(nfa_dfa_state_T)
+						       + n * sizeof(int)));
+    if (ds == NULL)
+	return NULL;
+    ds->at_bol = at_bol;
+    ds->prev_class = prev_class;
+    ds->nids = n;
+    mch_memmove(ds->ids, dfa->ids, n * sizeof(int));
+    ds->hash_next = dfa->hash[hash];
+    dfa->hash[hash] = ds;
+    ++dfa->nstates;
+    return ds;
+}
+
+/*
+ * Return the class of the character at "p" the way NFA_BOW and NFA_EOW use
+ * it: 0 for blank and NUL, 1 for punctuation, 2 or more for word characters.
+ */
+    static int
+nfa_dfa_class(char_u *p)
+{
+    if (has_mbyte)
+	return mb_get_class_buf(p, rex.reg_buf);
+    if (*p == NUL)
+	return 0;
+    return vim_iswordc_buf(*p, rex.reg_buf) ? 2 : 1;
+}
+
+/*
+ * Return TRUE if NFA state "state", which consumes a character, matches
+ * character "c" at "p".
+ */
+    static int
+nfa_dfa_char_match(nfa_state_T *state, int c, char_u *p)
+{
+    nfa_state_T	*s;
+    int		c1, c2;
+
+    switch (state->c)
+    {
+	case NFA_START_COLL:
+	case NFA_START_NEG_COLL:
+	    for (s = state->out; s->c != NFA_END_COLL; s = s->out)
+	    {
+		if (s->c == NFA_RANGE_MIN)
+		{
+		    c1 = s->val;
+		    s = s->out;
+		    c2 = s->val;
+		    if (c >= c1 && c <= c2)
+			break;
+		    if (rex.reg_ic)
+		    {
+			int c_low = MB_TOLOWER(c);
+
+			for ( ; c1 <= c2; ++c1)
+			    if (MB_TOLOWER(c1) == c_low)
+				break;
+			if (c1 <= c2)
+			    break;
+		    }
+		}
+		else if (s->c < 0 ? check_char_class(s->c, c)
+			: (c == s->c || (rex.reg_ic
+				       && MB_TOLOWER(c) == MB_TOLOWER(s->c))))
+		    break;
+	    }
+	    return (s->c == NFA_END_COLL) == (state->c == NFA_START_NEG_COLL);
+
+	case NFA_ANY:	    return TRUE;
+	case NFA_KWORD:	    return vim_iswordp_buf(p, rex.reg_buf);
+	case NFA_SKWORD:    return !VIM_ISDIGIT(c)
+					    && vim_iswordp_buf(p, rex.reg_buf);
+	case NFA_WHITE:	    return VIM_ISWHITE(c);
+	case NFA_NWHITE:    return !VIM_ISWHITE(c);
+	case NFA_DIGIT:	    return ri_digit(c);
+	case NFA_NDIGIT:    return !ri_digit(c);
+	case NFA_HEX:	    return ri_hex(c);
+	case NFA_NHEX:	    return !ri_hex(c);
+	case NFA_OCTAL:	    return ri_octal(c);
+	case NFA_NOCTAL:    return !ri_octal(c);
+	case NFA_WORD:	    return ri_word(c);
+	case NFA_NWORD:	    return !ri_word(c);
+	case NFA_HEAD:	    return ri_head(c);
+	case NFA_NHEAD:	    return !ri_head(c);
+	case NFA_ALPHA:	    return ri_alpha(c);
+	case NFA_NALPHA:    return !ri_alpha(c);
+	case NFA_LOWER:	    return ri_lower(c);
+	case NFA_NLOWER:    return !ri_lower(c);
+	case NFA_UPPER:	    return ri_upper(c);
+	case NFA_NUPPER:    return !ri_upper(c);
+	case NFA_LOWER_IC:  return ri_lower(c) || (rex.reg_ic && ri_upper(c));
+	case NFA_NLOWER_IC: return !(ri_lower(c) || (rex.reg_ic
+							      && ri_upper(c)));
+	case NFA_UPPER_IC:  return ri_upper(c) || (rex.reg_ic && ri_lower(c));
+	case NFA_NUPPER_IC: return !(ri_upper(c) || (rex.reg_ic
+							      && ri_lower(c)));
+	default:
+	    return c == state->c
+		    || (rex.reg_ic && MB_TOLOWER(c) == MB_TOLOWER(state->c));
+    }
+}
+
+/*
+ * Compute the transition from DFA state "ds" on character "c" at "p".
+ * "c" is NUL at the end of the line.
+ * Returns dfa->matched when the pattern matches before "c", NULL when out of
+ * memory.
+ */
+    static nfa_dfa_state_T *
+nfa_dfa_step(
+    nfa_regprog_T	*prog,
+    nfa_dfa_state_T	*ds,
+    int			c,
+    char_u		*p)
+{
+    nfa_dfa_T		*dfa = prog->dfa;
+    int			cur_class = 0;
+    int			sp = 0;
+    int			n = 0;
+    int			i, j;
+    unsigned		gen;
+    int			idx;
+    nfa_state_T		*state;
+    nfa_state_T		*target;
+    nfa_dfa_state_T	*next;
+
+    if (prog->dfa_flags & DFA_USE_CLASS)
+	cur_class = nfa_dfa_class(p);
+    if (++dfa->gen == 0)
+    {
+	/* Wrapped around: clear the marks, a stale one could match. */
+	vim_memset(dfa->mark, 0, (prog->nstate + 1) * sizeof(unsigned));
+	vim_memset(dfa->next_mark, 0, (prog->nstate + 1) * sizeof(unsigned));
+	dfa->gen = 1;
+    }
+    gen = dfa->gen;
+
+#define DFA_PUSH(s) \
+    do { \
+	idx = (int)((s) - prog->state); \
+	if (dfa->mark[idx] != gen) \
+	{ \
+	    dfa->mark[idx] = gen; \
+	    dfa->stack[sp++] = idx; \
+	} \
+    } while (0)
+
+    /* The start state is added at every position. */
+    DFA_PUSH(prog->start);
+    for (i = 0; i < ds->nids; ++i)
+	DFA_PUSH(&prog->state[ds->ids[i]]);
+
+    while (sp > 0)
+    {
+	state = &prog->state[dfa->stack[--sp]];
+	target = NULL;
+	switch (state->c)
+	{
+	    case NFA_MATCH:
+		return dfa->matched;
+
+	    case NFA_SPLIT:
+		DFA_PUSH(state->out1);
+		DFA_PUSH(state->out);
+		break;
+
+	    case NFA_BOL:
+		if (ds->at_bol)
+		    DFA_PUSH(state->out);
+		break;
+
+	    case NFA_EOL:
+		if (c == NUL)
+		    DFA_PUSH(state->out);
+		break;
+
+	    case NFA_BOW:
+		if (cur_class >= 2 && cur_class != ds->prev_class)
+		    DFA_PUSH(state->out);
+		break;
+
+	    case NFA_EOW:
+		if (ds->prev_class >= 2 && cur_class != ds->prev_class)
+		    DFA_PUSH(state->out);
+		break;
+
+	    case NFA_START_COLL:
+	    case NFA_START_NEG_COLL:
+		if (c != NUL && nfa_dfa_char_match(state, c, p))
+		    target = state->out1->out;
+		break;
+
+	    default:
+		if (state->c >= 0 || (state->c >= NFA_ANY
+					       && state->c <= NFA_NUPPER_IC))
+		{
+		    if (c != NUL && nfa_dfa_char_match(state, c, p))
+			target = state->out;
+		}
+		else
+		    /* NFA_EMPTY, NFA_MOPEN, NFA_MCLOSE, NFA_ZSTART, etc. */
+		    DFA_PUSH(state->out);
+		break;
+	}
+
+	if (target != NULL)
+	{
+	    idx = (int)(target - prog->state);
+	    if (dfa->next_mark[idx] != gen)
+	    {
+		dfa->next_mark[idx] = gen;
+		dfa->ids[n++] = idx;
+	    }
+	}
+    }
+#undef DFA_PUSH
+
+    /* Sort the NFA states, so that equal sets compare equal. */
+    for (i = 1; i < n; ++i)
+    {
+	idx = dfa->ids[i];
+	for (j = i; j > 0 && dfa->ids[j - 1] > idx; --j)
+	    dfa->ids[j] = dfa->ids[j - 1];
+	dfa->ids[j] = idx;
+    }
+
+    if (dfa->nstates >= DFA_MAX_STATES)
+    {
+	/* "ds" becomes invalid, don't cache the transition in it. */
+	nfa_dfa_flush(dfa);
+	ds = NULL;
+    }
+    next = nfa_dfa_lookup(dfa, n, FALSE, cur_class);
+    if (ds != NULL && c < DFA_NCHARS)
+	ds->next[c] = next;
+    return next;
+}
+
+/*
+ * Use the DFA to check whether there is a match in rex.line at or after
+ * "*colp".  When there is a match "*colp" is advanced to where the leftmost
+ * match can start at the earliest.
+ * Returns DFA_MATCH, DFA_NOMATCH or DFA_UNKNOWN.
+ */
+    static int
+nfa_dfa_search(nfa_regprog_T *prog, colnr_T *colp)
+{
+    nfa_dfa_T		*dfa = prog->dfa;
+    nfa_dfa_state_T	*ds;
+    nfa_dfa_state_T	*next;
+    char_u		*p = rex.line + *colp;
+    char_u		*restart = p;
+    int			c;
+    int			clen;
+    int			prev_class = 0;
+    int			flushes;
+
+    if (dfa == NULL)
+    {
+	dfa = prog->dfa = nfa_dfa_new(prog);
+	if (dfa == NULL)
+	    return DFA_UNKNOWN;
+	dfa->reg_ic = rex.reg_ic;
+	mch_memmove(dfa->chartab, rex.reg_buf->b_chartab, 32);
+    }
+    else if (dfa->reg_ic != rex.reg_ic || ((prog->dfa_flags & DFA_USE_ISK)
+		  && memcmp(dfa->chartab, rex.reg_buf->b_chartab, 32) != 0))
+    {
+	/* Cached transitions depend on 'ignorecase' and 'iskeyword'. */
+	nfa_dfa_flush(dfa);
+	dfa->reg_ic = rex.reg_ic;
+	mch_memmove(dfa->chartab, rex.reg_buf->b_chartab, 32);
+    }
+
+    if (prog->dfa_flags & DFA_USE_CLASS)
+	prev_class = p == rex.line ? -1
+		 : nfa_dfa_class(p - 1 - (*mb_head_off)(rex.line, p - 1));
+    ds = nfa_dfa_lookup(dfa, 0,
+		  (prog->dfa_flags & DFA_USE_BOL) && p == rex.line, prev_class);
+    if (ds == NULL)
+	return DFA_UNKNOWN;
+    flushes = dfa->flushes;
+
+    for (;;)
+    {
+	c = *p;
+	if (c < DFA_NCHARS)
+	{
+	    clen = 1;
+	    next = ds->next[c];
+	    if (next == NULL)
+		next = nfa_dfa_step(prog, ds, c, p);
+	}
+	else
+	{
+	    if (has_mbyte)
+	    {
+		c = (*mb_ptr2char)(p);
+		clen = (*mb_ptr2len)(p);
+		/* The NFA handles a composing character differently for
+		 * different items, leave that to the NFA. */
+		if (enc_utf8 && (utf_iscomposing(c)
+					       || clen != utf_ptr2len(p)))
+		    return DFA_UNKNOWN;
+	    }
+	    else
+		clen = 1;
+	    next = nfa_dfa_step(prog, ds, c, p);
+	}
+
+	if (next == NULL)
+	    return DFA_UNKNOWN;
+	if (next == dfa->matched)
+	{
+	    *colp = (colnr_T)(restart - rex.line);
+	    return DFA_MATCH;
+	}
+	if (c == NUL)
+	    return DFA_NOMATCH;
+
+	if (dfa->flushes != flushes)
+	{
+	    /* Too many states were created for too little text: the NFA
+	     * is probably faster. */
+	    if (dfa->scanned < DFA_MAX_STATES * 10L)
+	    {
+		if (++dfa->failed >= DFA_MAX_FAILED)
+		    prog->dfa_flags = 0;
+		return DFA_UNKNOWN;
+	    }
+	    flushes = dfa->flushes;
+	    dfa->scanned = 0;
+	}
+	++dfa->scanned;
+
+	ds = next;
+	p += clen;
+	/* When no NFA state is left all matches start here or later. */
+	if (ds->nids == 0)
+	    restart = p;
+    }
+}
+
 /*
  * Try match of "prog" with at rex.line["col"].
  * Returns <= 0 for failure, number of lines contained in the match otherwise.
@@ -7187,6 +8009,20 @@ nfa_regexec_both(
     }
 #endif
 
+    /* If there is a literal string that must appear, look for it.  When
+     * the match starts with it skip ahead to where it is. */
+    if (prog->reglit != NULL && !rex.reg_icombine
+				       && (!rex.reg_ic || prog->reglit_icok))
+    {
+	char_u *s = reg_find_literal(rex.line + col, prog->reglit,
+						prog->reglitlen, rex.reg_ic);
+
+	if (s == NULL)
+	    return 0L;
+	if (prog->reglit_start)
+	    col = (colnr_T)(s - rex.line);
+    }
+
     if (prog->regstart != NUL)
     {
 	/* Skip ahead until a character we know the match must start with.
@@ -7200,6 +8036,12 @@ nfa_regexec_both(
 	    return find_match_text(col, prog->regstart, prog->match_text);
     }
 
+    /* Use the DFA to find out quickly whether there is a match at all and
+     * where it can start. */
+    if (prog->dfa_flags != 0 && !rex.reg_line_lbr && !rex.reg_icombine
+			       && nfa_dfa_search(prog, &col) == DFA_NOMATCH)
+	goto theend;
+
     /* If the start column is past the maximum column: no need to try. */
     if (rex.reg_maxcol > 0 && col >= rex.reg_maxcol)
 	goto theend;
@@ -7301,10 +8143,13 @@ nfa_regcomp(char_u *expr, int re_flags)
     prog->nsubexp = regnpar;
 
     nfa_postprocess(prog);
+    prog->dfa = NULL;
+    prog->dfa_flags = nfa_dfa_flags(prog);
 
     prog->reganch = nfa_get_reganch(prog->start, 0);
     prog->regstart = nfa_get_regstart(prog->start, 0);
     prog->match_text = nfa_get_match_text(prog->start);
+    nfa_get_literal(prog);
 
 #ifdef ENABLE_LOG
     nfa_postfix_dump(expr, OK);
@@ -7344,12 +8189,59 @@ nfa_regfree(regprog_T *prog)
 {
     if (prog != NULL)
     {
+	nfa_dfa_free(((nfa_regprog_T *)prog)->dfa);
 	vim_free(((nfa_regprog_T *)prog)->match_text);
+	vim_free(((nfa_regprog_T *)prog)->reglit);
 	vim_free(((nfa_regprog_T *)prog)->pattern);
 	vim_free(prog);
     }
 }
 
+/*
+ * Return a copy of a compiled regexp program, returned by nfa_regcomp().
+ * The DFA is not copied, it is built again when needed.
+ */
+    static regprog_T *
+nfa_regdup(regprog_T *prog)
+{
+    nfa_regprog_T   *p = (nfa_regprog_T *)prog;
+    nfa_regprog_T   *copy;
+    long	    prog_size;
+    int		    i;
+
+    prog_size = sizeof(nfa_regprog_T) + sizeof(nfa_state_T) * (p->nstate - 1);
+    copy = (nfa_regprog_T *)lalloc(prog_size, TRUE);
+    if (copy == NULL)
+	return NULL;
+    mch_memmove(copy, p, (size_t)prog_size);
+
+    /* The states point into the state[] array. */
+    copy->start = copy->state + (p->start - p->state);
+    for (i = 0; i < p->nstate; ++i)
+    {
+	if (p->state[i].out != NULL)
+	    copy->state[i].out = copy->state + (p->state[i].out - p->state);
+	if (p->state[i].out1 != NULL)
+	    copy->state[i].out1 = copy->state + (p->state[i].out1 - p->state);
+    }
+    copy->dfa = NULL;
+    copy->match_text = NULL;
+    copy->reglit = NULL;
+    copy->pattern = vim_strsave(p->pattern);
+    if (p->match_text != NULL)
+	copy->match_text = vim_strsave(p->match_text);
+    if (p->reglit != NULL)
+	copy->reglit = vim_strnsave(p->reglit, p->reglitlen);
+    if (copy->pattern == NULL
+	    || (p->match_text != NULL && copy->match_text == NULL)
+	    || (p->reglit != NULL && copy->reglit == NULL))
+    {
+	nfa_regfree((regprog_T *)copy);
+	return NULL;
+    }
+    return (regprog_T *)copy;
+}
+
 /*
  * Match a regexp against a string.
  * "rmp->regprog" is a compiled regexp as returned by nfa_regcomp().
@@ -89,6 +89,13 @@
 
 #include "vim.h"
 
+/* SSE2 is always there on x86_64, use it to compare 16 screen cells at a
+ * time. */
+#if defined(__SSE2__) && !defined(PROTO)
+# include <emmintrin.h>
+# define USE_SSE2_SCAN
+#endif
+
 #define MB_FILLER_CHAR '<'  /* character used when a double-width character
 			     * doesn't fit. */
 
@@ -116,6 +123,14 @@ static int compute_foldcolumn(win_T *wp, int col);
  * loop. */
 static int redrawing_for_callback = 0;
 
+#ifdef FEAT_TIMERS
+/* With 'redrawrate' set: the time when the next redraw for a callback may be
+ * done and whether a redraw was postponed until then. */
+static proftime_T callback_frame_due;
+static int	callback_frame_pending = FALSE;
+static int	callback_frame_update = FALSE;
+#endif
+
 /*
  * Buffer for one screen line (characters and attributes).
  */
@@ -130,6 +145,14 @@ static void fill_foldcolumn(char_u *p, win_T *wp, int closed, linenr_T lnum);
 static void copy_text_attr(int off, char_u *buf, int len, int attr);
 #endif
 static int win_line(win_T *, linenr_T, int, int, int nochange, int number_only);
+static int line_cache_usable(win_T *wp, linenr_T lnum);
+static wlcache_T *line_cache_entry(win_T *wp, linenr_T lnum, int alloc);
+static long line_cache_relnum(win_T *wp, linenr_T lnum);
+static void line_cache_arrays(wlcache_T *lc, schar_T **lines, sattr_T **attrs, u8char_T **lines_uc);
+static int line_cache_draw(win_T *wp, linenr_T lnum, int row);
+static void line_cache_store(win_T *wp, linenr_T lnum, int row);
+static void line_cache_clear(win_T *wp);
+static void line_cache_invalidate(win_T *wp, linenr_T lnum);
 static void draw_vsep_win(win_T *wp, int row);
 #ifdef FEAT_STL_OPT
 static void redraw_custom_statusline(win_T *wp);
@@ -268,9 +291,13 @@ redraw_buf_line_later(buf_T *buf, linenr_T lnum)
     win_T	*wp;
 
     FOR_ALL_WINDOWS(wp)
-	if (wp->w_buffer == buf && lnum >= wp->w_topline
-						  && lnum < wp->w_botline)
-	    redrawWinline(wp, lnum);
+	if (wp->w_buffer == buf)
+	{
+	    if (lnum >= wp->w_topline && lnum < wp->w_botline)
+		redrawWinline(wp, lnum);
+	    else
+		line_cache_invalidate(wp, lnum);
+	}
 }
 #endif
 
@@ -444,6 +471,29 @@ redraw_asap(int type)
     void
 redraw_after_callback(int call_update_screen)
 {
+#ifdef FEAT_TIMERS
+    if (p_rdr > 0)
+    {
+	proftime_T  now;
+
+	/* Redrew less than a frame ago: postpone, the changes pile up until
+	 * redraw_postponed_callback() finds that the frame is due. */
+	profile_start(&now);
+	if (proftime_time_left(&callback_frame_due, &now) > 0)
+	{
+	    callback_frame_pending = TRUE;
+	    if (call_update_screen)
+		callback_frame_update = TRUE;
+	    return;
+	}
+	if (callback_frame_pending && callback_frame_update)
+	    call_update_screen = TRUE;
+	profile_setlimit(1000L / p_rdr, &callback_frame_due);
+    }
+    callback_frame_pending = FALSE;
+    callback_frame_update = FALSE;
+#endif
+
     ++redrawing_for_callback;
 
     if (State == HITRETURN || State == ASKMORE)
@@ -486,6 +536,29 @@ redraw_after_callback(int call_update_screen)
     --redrawing_for_callback;
 }
 
+#if defined(FEAT_TIMERS) || defined(PROTO)
+/*
+ * Do the redraw for a callback that was postponed because of 'redrawrate'
+ * when it is due.
+ * Return the time in msec until it is due, -1 if there is nothing to do.
+ */
+    long
+redraw_postponed_callback(void)
+{
+    proftime_T	now;
+    long	left;
+
+    if (!callback_frame_pending)
+	return -1;
+    profile_start(&now);
+    left = p_rdr > 0 ? proftime_time_left(&callback_frame_due, &now) : 0;
+    if (left > 0)
+	return left;
+    redraw_after_callback(callback_frame_update);
+    return -1;
+}
+#endif
+
 /*
  * Changed something in the current window, at buffer line "lnum", that
  * requires that line and possibly other lines to be redrawn.
@@ -503,6 +576,7 @@ redrawWinline(
 	wp->w_redraw_top = lnum;
     if (wp->w_redraw_bot == 0 || wp->w_redraw_bot < lnum)
 	wp->w_redraw_bot = lnum;
+    line_cache_invalidate(wp, lnum);
     redraw_win_later(wp, VALID);
 }
 
@@ -555,6 +629,9 @@ update_screen(int type_arg)
     int		gui_cursor_row;
 #endif
     int		no_update = FALSE;
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = 0;
+#endif
 
     /* Don't do anything if the screen structures are (not yet) valid. */
     if (!screen_valid(TRUE))
@@ -598,6 +675,12 @@ update_screen(int type_arg)
     }
 
     updating_screen = TRUE;
+#ifdef FEAT_PROFILE
+    rendertime_log_frame(TRUE);
+    if (rendertime_on)
+	rt_start = profile_nsec();
+#endif
+    out_frame_start();
 #ifdef FEAT_SYN_HL
     ++display_tick;	    /* let syntax code know we're in a next round of
 			     * display updating */
@@ -802,6 +885,7 @@ update_screen(int type_arg)
     if (!did_intro)
 	maybe_intro_message();
     did_intro = TRUE;
+    out_frame_end();
 
 #ifdef FEAT_GUI
     /* Redraw the cursor and update the scrollbars when all screen updating is
@@ -828,6 +912,10 @@ update_screen(int type_arg)
 	    out_flush();
 	gui_update_scrollbars(FALSE);
     }
+#endif
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_UPDATE_SCREEN, NULL, rt_start);
 #endif
     return OK;
 }
@@ -1088,6 +1176,9 @@ win_update(win_T *wp)
 #ifdef SYN_TIME_LIMIT
     proftime_T	syntax_tm;
 #endif
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = 0;
+#endif
 
     type = wp->w_redr_type;
 
@@ -1097,6 +1188,11 @@ win_update(win_T *wp)
 	wp->w_lines_valid = 0;
     }
 
+    /* Anything may have changed that the cached lines depend on, e.g.
+     * highlighting or options, only use them for less invasive updates. */
+    if (type >= SOME_VALID)
+	line_cache_clear(wp);
+
     /* Window is zero-height: nothing to draw. */
     if (wp->w_height + WINBAR_HEIGHT(wp) == 0)
     {
@@ -1128,6 +1224,10 @@ win_update(win_T *wp)
     }
 #endif
 
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rt_start = profile_nsec();
+#endif
 #ifdef FEAT_SEARCH_EXTRA
     init_search_hl(wp);
 #endif
@@ -2043,6 +2143,21 @@ win_update(win_T *wp)
 		 * will draw "@  " lines below. */
 		row = wp->w_height + 1;
 	    }
+	    else if (type < SOME_VALID
+		    && (mod_top == 0 || lnum < mod_top || lnum >= mod_bot)
+		    && line_cache_usable(wp, lnum)
+		    && line_cache_draw(wp, lnum, srow))
+	    {
+		/* The unchanged line was put back from the line cache. */
+		row = srow + 1;
+#ifdef FEAT_FOLDING
+		wp->w_lines[idx].wl_folded = FALSE;
+		wp->w_lines[idx].wl_lastlnum = lnum;
+#endif
+#ifdef FEAT_SYN_HL
+		did_update = DID_NONE;
+#endif
+	    }
 	    else
 	    {
 #ifdef FEAT_SEARCH_EXTRA
@@ -2060,6 +2175,8 @@ win_update(win_T *wp)
 		 */
 		row = win_line(wp, lnum, srow, wp->w_height,
 							  mod_top == 0, FALSE);
+		if (row == srow + 1 && line_cache_usable(wp, lnum))
+		    line_cache_store(wp, lnum, srow);
 
 #ifdef FEAT_FOLDING
 		wp->w_lines[idx].wl_folded = FALSE;
@@ -2302,6 +2419,10 @@ win_update(win_T *wp)
     if (!got_int)
 	got_int = save_got_int;
 #endif
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_WIN_UPDATE, wp, rt_start);
+#endif
 }
 
 /*
@@ -2596,6 +2717,9 @@ fold_line(
     int		txtcol;
     int		off = (int)(current_ScreenLine - ScreenLines);
     int		ri;
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = rendertime_on ? profile_nsec() : 0;
+#endif
 
     /* Build the fold line:
      * 1. Add the cmdwin_type for the command-line window
@@ -2887,6 +3011,10 @@ fold_line(
 	curwin->w_cline_folded = TRUE;
 	curwin->w_valid |= (VALID_CHEIGHT|VALID_CROW);
     }
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_FOLD_LINE, wp, rt_start);
+#endif
 }
 
 /*
@@ -2992,6 +3120,221 @@ text_prop_compare(const void *s1, const void *s2)
 }
 #endif
 
+/*
+ * Return TRUE if line "lnum" of window "wp" may be taken from or stored in
+ * the line cache.  The cursor line is always drawn, it depends on too much
+ * state ('cursorline', 'concealcursor', w_cline_row).  Visual mode, incsearch
+ * highlighting and spell checking change without the line changing.
+ */
+    static int
+line_cache_usable(win_T *wp, linenr_T lnum)
+{
+    return enc_dbcs == 0
+	    && lnum != wp->w_cursor.lnum
+	    && !(VIsual_active && wp->w_buffer == curwin->w_buffer)
+	    && !highlight_match
+#ifdef FEAT_SPELL
+	    && !wp->w_p_spell
+#endif
+#ifdef FEAT_DIFF
+	    && !wp->w_p_diff
+#endif
+#ifdef FEAT_QUICKFIX
+	    && !bt_quickfix(wp->w_buffer)
+#endif
+#ifdef FEAT_TERMINAL
+	    && !bt_terminal(wp->w_buffer)
+#endif
+	    ;
+}
+
+/*
+ * Return the entry in the line cache of window "wp" for line "lnum".
+ * Allocates the cache when "alloc" is TRUE.  Returns NULL when there is no
+ * cache.
+ */
+    static wlcache_T *
+line_cache_entry(win_T *wp, linenr_T lnum, int alloc)
+{
+    if (wp->w_line_cache == NULL)
+    {
+	if (!alloc)
+	    return NULL;
+	wp->w_line_cache = (wlcache_T *)alloc_clear(
+					 (unsigned)(Rows * 2 * sizeof(wlcache_T)));
+	if (wp->w_line_cache == NULL)
+	    return NULL;
+	wp->w_line_cache_len = Rows * 2;
+    }
+    return &wp->w_line_cache[lnum % wp->w_line_cache_len];
+}
+
+/*
+ * Return the distance of line "lnum" to the cursor line, as used for
+ * 'relativenumber'.  Zero when 'relativenumber' is not set.
+ */
+    static long
+line_cache_relnum(win_T *wp, linenr_T lnum)
+{
+    return wp->w_p_rnu ? (long)(lnum - wp->w_cursor.lnum) : 0L;
+}
+
+/*
+ * Get pointers to the cell arrays of line cache entry "lc".
+ */
+    static void
+line_cache_arrays(
+    wlcache_T	*lc,
+    schar_T	**lines,
+    sattr_T	**attrs,
+    u8char_T	**lines_uc)
+{
+    int		width = lc->lc_width;
+
+    /* The 32 bit arrays go first to keep them aligned. */
+    *lines_uc = (u8char_T *)lc->lc_cells;
+    if (lc->lc_mco >= 0)
+	*attrs = (sattr_T *)(*lines_uc + width * (1 + lc->lc_mco));
+    else
+	*attrs = (sattr_T *)*lines_uc;
+    *lines = (schar_T *)(*attrs + width);
+}
+
+/*
+ * Put the cached cells for line "lnum" of window "wp" in window row "row".
+ * Returns FALSE when the line is not in the cache, it must be drawn with
+ * win_line() then.
+ */
+    static int
+line_cache_draw(win_T *wp, linenr_T lnum, int row)
+{
+    wlcache_T	*lc = line_cache_entry(wp, lnum, FALSE);
+    unsigned	off = (unsigned)(current_ScreenLine - ScreenLines);
+    int		width = wp->w_width;
+    schar_T	*lines;
+    sattr_T	*attrs;
+    u8char_T	*lines_uc;
+    int		i;
+
+    if (lc == NULL
+	    || lc->lc_lnum != lnum
+	    || lc->lc_fnum != wp->w_buffer->b_fnum
+	    || lc->lc_changedtick != CHANGEDTICK(wp->w_buffer)
+	    || lc->lc_width != width
+	    || lc->lc_mco != (enc_utf8 ? Screen_mco : -1)
+	    || lc->lc_leftcol != (wp->w_p_wrap ? 0 : wp->w_leftcol)
+#ifdef FEAT_SYN_HL
+	    || lc->lc_virtcol != (wp->w_p_cuc ? wp->w_virtcol : 0)
+#endif
+	    || lc->lc_relnum != line_cache_relnum(wp, lnum))
+	return FALSE;
+
+    line_cache_arrays(lc, &lines, &attrs, &lines_uc);
+    mch_memmove(ScreenLines + off, lines, (size_t)width * sizeof(schar_T));
+    mch_memmove(ScreenAttrs + off, attrs, (size_t)width * sizeof(sattr_T));
+    if (enc_utf8)
+    {
+	mch_memmove(ScreenLinesUC + off, lines_uc,
+					     (size_t)width * sizeof(u8char_T));
+	for (i = 0; i < Screen_mco; ++i)
+	    mch_memmove(ScreenLinesC[i] + off, lines_uc + width * (i + 1),
+					     (size_t)width * sizeof(u8char_T));
+    }
+    screen_line(W_WINROW(wp) + row, wp->w_wincol, width, width, FALSE);
+    return TRUE;
+}
+
+/*
+ * Store the cells of line "lnum" of window "wp", which was just drawn in
+ * window row "row", in the line cache.
+ */
+    static void
+line_cache_store(win_T *wp, linenr_T lnum, int row)
+{
+    wlcache_T	*lc = line_cache_entry(wp, lnum, TRUE);
+    unsigned	off;
+    int		width = wp->w_width;
+    int		mco = enc_utf8 ? Screen_mco : -1;
+    schar_T	*lines;
+    sattr_T	*attrs;
+    u8char_T	*lines_uc;
+    int		i;
+
+    if (lc == NULL || W_WINROW(wp) + row >= Rows)
+	return;
+    if (lc->lc_cells == NULL || lc->lc_width != width || lc->lc_mco != mco)
+    {
+	vim_free(lc->lc_cells);
+	lc->lc_lnum = 0;
+	lc->lc_cells = alloc((unsigned)(width * (sizeof(schar_T)
+			 + sizeof(sattr_T) + (mco + 1) * sizeof(u8char_T))));
+	if (lc->lc_cells == NULL)
+	    return;
+	lc->lc_width = width;
+	lc->lc_mco = mco;
+    }
+
+    off = LineOffset[W_WINROW(wp) + row] + wp->w_wincol;
+    line_cache_arrays(lc, &lines, &attrs, &lines_uc);
+    mch_memmove(lines, ScreenLines + off, (size_t)width * sizeof(schar_T));
+    mch_memmove(attrs, ScreenAttrs + off, (size_t)width * sizeof(sattr_T));
+    if (enc_utf8)
+    {
+	mch_memmove(lines_uc, ScreenLinesUC + off,
+					     (size_t)width * sizeof(u8char_T));
+	for (i = 0; i < Screen_mco; ++i)
+	    mch_memmove(lines_uc + width * (i + 1), ScreenLinesC[i] + off,
+					     (size_t)width * sizeof(u8char_T));
+    }
+
+    lc->lc_lnum = lnum;
+    lc->lc_fnum = wp->w_buffer->b_fnum;
+    lc->lc_changedtick = CHANGEDTICK(wp->w_buffer);
+    lc->lc_leftcol = wp->w_p_wrap ? 0 : wp->w_leftcol;
+#ifdef FEAT_SYN_HL
+    lc->lc_virtcol = wp->w_p_cuc ? wp->w_virtcol : 0;
+#endif
+    lc->lc_relnum = line_cache_relnum(wp, lnum);
+}
+
+/*
+ * Forget the cached lines of window "wp", keep the memory.
+ */
+    static void
+line_cache_clear(win_T *wp)
+{
+    int		i;
+
+    for (i = 0; i < wp->w_line_cache_len; ++i)
+	wp->w_line_cache[i].lc_lnum = 0;
+}
+
+/*
+ * Forget the cached cells of line "lnum" in window "wp".
+ */
+    static void
+line_cache_invalidate(win_T *wp, linenr_T lnum)
+{
+    wlcache_T	*lc = line_cache_entry(wp, lnum, FALSE);
+
+    if (lc != NULL && lc->lc_lnum == lnum)
+	lc->lc_lnum = 0;
+}
+
+/*
+ * Free the line cache of window "wp".
+ */
+    void
+line_cache_free(win_T *wp)
+{
+    int		i;
+
+    for (i = 0; i < wp->w_line_cache_len; ++i)
+	vim_free(wp->w_line_cache[i].lc_cells);
+    VIM_CLEAR(wp->w_line_cache);
+    wp->w_line_cache_len = 0;
+}
+
 /*
  * Display line "lnum" of window 'wp' on the screen.
  * Start at row "startrow", stop when "endrow" is reached.
@@ -3202,10 +3545,17 @@ win_line(
     }
 #else
 # define VCOL_HLC (vcol)
+#endif
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = 0;
 #endif
 
     if (startrow > endrow)		/* past the end already! */
 	return startrow;
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rt_start = profile_nsec();
+#endif
 
     row = startrow;
     screen_row = row + W_WINROW(wp);
@@ -6002,6 +6352,10 @@ win_line(
 #endif
 
     vim_free(p_extra_free);
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_WIN_LINE, wp, rt_start);
+#endif
     return row;
 }
 
@@ -6054,6 +6408,88 @@ char_needs_redraw(int off_from, int off_to, int cols)
     return FALSE;
 }
 
+#ifdef USE_SSE2_SCAN
+/*
+ * Combine the results of four 32 bit compares into one byte per item.
+ */
+    static __m128i
+screen_pack32(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    return _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+#endif
+
+/*
+ * Return the number of cells at the start of the "len" cells at "off_from"
+ * and "off_to" that are equal in ScreenLines[], ScreenAttrs[] and, for UTF-8,
+ * ScreenLinesUC[].  Composing characters are only compared for cells with a
+ * multi-byte character.
+ * Not to be used for a double-byte encoding.
+ */
+    static int
+screen_cells_same(unsigned off_from, unsigned off_to, int len)
+{
+    int		n = 0;
+#ifdef USE_SSE2_SCAN
+    __m128i	zero = _mm_setzero_si128();
+    __m128i	eq;
+    __m128i	*pf;
+    __m128i	*pt;
+    int		same;	/* bit set for each equal cell */
+    int		multi;	/* bit set for each cell with a multi-byte char */
+    int		i;
+
+    for ( ; n + 16 <= len; n += 16)
+    {
+	eq = _mm_cmpeq_epi8(
+		_mm_loadu_si128((__m128i *)(ScreenLines + off_from + n)),
+		_mm_loadu_si128((__m128i *)(ScreenLines + off_to + n)));
+	pf = (__m128i *)(ScreenAttrs + off_from + n);
+	pt = (__m128i *)(ScreenAttrs + off_to + n);
+	eq = _mm_and_si128(eq, _mm_packs_epi16(
+		_mm_cmpeq_epi16(_mm_loadu_si128(pf), _mm_loadu_si128(pt)),
+		_mm_cmpeq_epi16(_mm_loadu_si128(pf + 1),
+						      _mm_loadu_si128(pt + 1))));
+	multi = 0;
+	if (enc_utf8)
+	{
+	    pf = (__m128i *)(ScreenLinesUC + off_from + n);
+	    pt = (__m128i *)(ScreenLinesUC + off_to + n);
+	    eq = _mm_and_si128(eq, screen_pack32(
+		 _mm_cmpeq_epi32(_mm_loadu_si128(pf), _mm_loadu_si128(pt)),
+		 _mm_cmpeq_epi32(_mm_loadu_si128(pf + 1),
+						     _mm_loadu_si128(pt + 1)),
+		 _mm_cmpeq_epi32(_mm_loadu_si128(pf + 2),
+						     _mm_loadu_si128(pt + 2)),
+		 _mm_cmpeq_epi32(_mm_loadu_si128(pf + 3),
+						   _mm_loadu_si128(pt + 3))));
+	    multi = ~_mm_movemask_epi8(screen_pack32(
+			_mm_cmpeq_epi32(_mm_loadu_si128(pf), zero),
+			_mm_cmpeq_epi32(_mm_loadu_si128(pf + 1), zero),
+			_mm_cmpeq_epi32(_mm_loadu_si128(pf + 2), zero),
+			_mm_cmpeq_epi32(_mm_loadu_si128(pf + 3), zero)))
+									& 0xffff;
+	}
+	same = _mm_movemask_epi8(eq);
+	for (i = 0; i < 16 && (same & (1 << i)) != 0; ++i)
+	    if ((multi & (1 << i)) != 0
+			 && comp_char_differs(off_from + n + i, off_to + n + i))
+		break;
+	if (i < 16)
+	    return n + i;
+    }
+#endif
+    for ( ; n < len; ++n)
+	if (ScreenLines[off_from + n] != ScreenLines[off_to + n]
+		|| ScreenAttrs[off_from + n] != ScreenAttrs[off_to + n]
+		|| (enc_utf8
+		    && (ScreenLinesUC[off_from + n] != ScreenLinesUC[off_to + n]
+			|| (ScreenLinesUC[off_from + n] != 0
+			    && comp_char_differs(off_from + n, off_to + n)))))
+	    break;
+    return n;
+}
+
 #if defined(FEAT_TERMINAL) || defined(PROTO)
 /*
  * Return the index in ScreenLines[] for the current screen line.
@@ -6145,6 +6581,39 @@ screen_line(
 
     while (col < endcol)
     {
+	/* Skip over cells that are unchanged in one go.  Stop one cell
+	 * before the first changed one, it may be the first half of a
+	 * double-width character. */
+	if (!redraw_next && !force && !p_wiv && enc_dbcs == 0
+							 && col + 2 < endcol)
+	{
+	    int	    skip = screen_cells_same(off_from, off_to, endcol - col);
+
+	    if (skip < endcol - col)
+	    {
+		--skip;
+		/* Don't stop on the second half of a double-width
+		 * character. */
+		if (skip > 0 && has_mbyte
+			&& (*mb_off2cells)(off_from + skip - 1,
+							    max_off_from) == 2)
+		    --skip;
+	    }
+	    if (skip > 0)
+	    {
+		off_to += skip;
+		off_from += skip;
+		col += skip;
+		if (col >= endcol)
+		{
+		    redraw_this = FALSE;
+		    break;
+		}
+		redraw_next = char_needs_redraw(off_from, off_to,
+								endcol - col);
+	    }
+	}
+
 	if (has_mbyte && (col + 1 < endcol))
 	    char_cells = (*mb_off2cells)(off_from, max_off_from);
 	else
@@ -7778,6 +8247,9 @@ next_search_hl(
     colnr_T	matchcol;
     long	nmatched;
     int		save_called_emsg = called_emsg;
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = 0;
+#endif
 
     // for :{range}s/pat only highlight inside the range
     if (lnum < search_first_line || lnum > search_last_line)
@@ -7799,6 +8271,10 @@ next_search_hl(
 	else if (lnum < l || shl->rm.endpos[0].col > mincol)
 	    return;
     }
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rt_start = profile_nsec();
+#endif
 
     /*
      * Repeat searching for a match until one is found that includes "mincol"
@@ -7904,6 +8380,10 @@ next_search_hl(
 
     // Restore called_emsg for assert_fails().
     called_emsg = save_called_emsg;
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_SEARCH_HL, win, rt_start);
+#endif
 }
 
 /*
@@ -9116,6 +9596,7 @@ windgoto(int row, int col)
     int		    noinvcurs;
     char_u	    *bs;
     int		    goto_cost;
+    int		    use_cri;
     int		    attr;
 
 #define GOTO_COST   7	/* assume a term_windgoto() takes about 7 chars */
@@ -9144,7 +9625,25 @@ windgoto(int row, int col)
 	    noinvcurs = HIGHL_COST;
 	else
 	    noinvcurs = 0;
-	goto_cost = GOTO_COST + noinvcurs;
+	/* Use the actual length of the cursor positioning code, it's short
+	 * near the top of the screen. */
+	use_cri = row == screen_cur_row && col > screen_cur_col
+							    && *T_CRI != NUL;
+	if (*T_CM != NUL)
+	{
+	    goto_cost = term_windgoto_len(row, col);
+	    if (use_cri)
+	    {
+		i = term_cursor_right_len(col - screen_cur_col);
+		if (i < goto_cost)
+		    goto_cost = i;
+		else
+		    use_cri = FALSE;
+	    }
+	}
+	else
+	    goto_cost = GOTO_COST;
+	goto_cost += noinvcurs;
 
 	/*
 	 * Plan how to do the positioning:
@@ -9337,8 +9836,7 @@ windgoto(int row, int col)
 	{
 	    if (noinvcurs)
 		screen_stop_highlight();
-	    if (row == screen_cur_row && (col > screen_cur_col)
-							     && *T_CRI != NUL)
+	    if (use_cri)
 		term_cursor_right(col - screen_cur_col);
 	    else
 		term_windgoto(row, col);
@@ -11028,3 +11526,201 @@ screen_screenrow(void)
     return screen_cur_row;
 }
 #endif
+
+#if defined(FEAT_PROFILE) || defined(PROTO)
+static render_time_T render_time[RT_COUNT];	/* ":rendertime" results */
+static render_time_T render_time_logged[RT_COUNT]; /* render_time[] when the
+						    * last frame started */
+static varnumber_T render_log_start = 0;    /* when logging frames started */
+static varnumber_T render_frame_start = 0;  /* when the last frame started */
+static long	render_frame_nr = 0;	    /* nr of frames logged */
+
+static char *render_part_names[RT_COUNT] = {
+    "update_screen",
+    "win_update",
+    "win_line",
+    "get_syntax_attr",
+    "next_search_hl",
+    "fold_line",
+    "out_flush",
+};
+
+/*
+ * Add a call of the redrawing part "part" that started at "start", as
+ * returned by profile_nsec(), to the ":rendertime" results.  "wp" is the
+ * window being redrawn, NULL when the part is not for one window.
+ */
+    void
+rendertime_add(int part, win_T *wp, varnumber_T start)
+{
+    varnumber_T	nsec;
+
+    if (start == 0)	/* timing was switched on halfway */
+	return;
+    nsec = profile_nsec() - start;
+    ++render_time[part].count;
+    render_time[part].total += nsec;
+    if (wp != NULL)
+    {
+	++wp->w_render_time[part].count;
+	wp->w_render_time[part].total += nsec;
+    }
+}
+
+/*
+ * Write a line to "rendertime_fd" for the frame that started last, with the
+ * number of calls and the time of each part since then.  Thus the output
+ * flushed after update_screen() returned is included.
+ * When "start" is TRUE a new frame starts, otherwise Vim is exiting.
+ */
+    void
+rendertime_log_frame(int start)
+{
+    varnumber_T	now;
+    int		i;
+
+    if (rendertime_fd == NULL)
+	return;
+    now = profile_nsec();
+    if (render_log_start == 0)
+    {
+	render_log_start = now;
+	fprintf(rendertime_fd, "\n\ntimes in msec\n");
+	fprintf(rendertime_fd, "for each part: number of calls and time including the parts it calls\n\n");
+	fprintf(rendertime_fd, "%6s %10s", "frame", "clock");
+	for (i = 0; i < RT_COUNT; ++i)
+	    fprintf(rendertime_fd, " %16s", render_part_names[i]);
+	fprintf(rendertime_fd, "\n");
+    }
+    if (render_frame_start != 0)
+    {
+	fprintf(rendertime_fd, "%6ld %10.3f", ++render_frame_nr,
+		      (double)(render_frame_start - render_log_start) / 1e6);
+	for (i = 0; i < RT_COUNT; ++i)
+	    fprintf(rendertime_fd, " %6ld %9.3f",
+		    render_time[i].count - render_time_logged[i].count,
+		    (double)(render_time[i].total
+					    - render_time_logged[i].total) / 1e6);
+	fprintf(rendertime_fd, "\n");
+	fflush(rendertime_fd);
+    }
+    mch_memmove(render_time_logged, render_time, sizeof(render_time));
+    render_frame_start = start ? now : 0;
+}
+
+/*
+ * Clear the ":rendertime" results, also for each window.
+ */
+    static void
+rendertime_clear(void)
+{
+    tabpage_T	*tp;
+    win_T	*wp;
+
+    vim_memset(render_time, 0, sizeof(render_time));
+    vim_memset(render_time_logged, 0, sizeof(render_time_logged));
+    FOR_ALL_TAB_WINDOWS(tp, wp)
+	vim_memset(wp->w_render_time, 0, sizeof(wp->w_render_time));
+}
+
+/*
+ * Return a time in "nsec" nanoseconds as seconds for ":rendertime report".
+ */
+    static char *
+rendertime_msg(varnumber_T nsec)
+{
+    static char buf[50];
+
+    sprintf(buf, "%3ld.%06ld", (long)(nsec / 1000000000),
+					      (long)(nsec % 1000000000 / 1000));
+    return buf;
+}
+
+/*
+ * List the ":rendertime" results of all windows.
+ */
+    static void
+rendertime_report(void)
+{
+    int		i;
+
+    msg_puts_title(_("  TOTAL      COUNT    AVERAGE   PART"));
+    msg_puts("\n");
+    for (i = 0; i < RT_COUNT && !got_int; ++i)
+    {
+	msg_puts(rendertime_msg(render_time[i].total));
+	msg_puts(" ");
+	msg_advance(13);
+	msg_outnum(render_time[i].count);
+	msg_puts(" ");
+	msg_advance(20);
+	msg_puts(rendertime_msg(render_time[i].count == 0 ? 0
+			       : render_time[i].total / render_time[i].count));
+	msg_puts(" ");
+	msg_advance(34);
+	msg_puts(render_part_names[i]);
+	msg_puts("\n");
+    }
+}
+
+/*
+ * ":rendertime".
+ */
+    void
+ex_rendertime(exarg_T *eap)
+{
+    if (STRCMP(eap->arg, "on") == 0)
+	rendertime_on = TRUE;
+    else if (STRCMP(eap->arg, "off") == 0)
+	rendertime_on = FALSE;
+    else if (STRCMP(eap->arg, "clear") == 0)
+	rendertime_clear();
+    else if (STRCMP(eap->arg, "report") == 0)
+	rendertime_report();
+    else
+	semsg(_(e_invarg2), eap->arg);
+}
+
+# if defined(FEAT_CMDL_COMPL) || defined(PROTO)
+/*
+ * Function given to ExpandGeneric() to obtain the possible arguments of the
+ * ":rendertime {on,off,clear,report}" command.
+ */
+    char_u *
+get_rendertime_arg(expand_T *xp UNUSED, int idx)
+{
+    switch (idx)
+    {
+	case 0: return (char_u *)"on";
+	case 1: return (char_u *)"off";
+	case 2: return (char_u *)"clear";
+	case 3: return (char_u *)"report";
+    }
+    return NULL;
+}
+# endif
+
+# if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * Add an entry to "dict" for each part of redrawing with the ":rendertime"
+ * results of window "wp", or of all windows when "wp" is NULL.
+ * For rendertime_info().
+ */
+    void
+rendertime_dict(dict_T *dict, win_T *wp)
+{
+    render_time_T   *rt = wp == NULL ? render_time : wp->w_render_time;
+    dict_T	    *part_dict;
+    int		    i;
+
+    for (i = 0; i < RT_COUNT; ++i)
+    {
+	if ((part_dict = dict_alloc()) == NULL
+		|| dict_add_dict(dict, render_part_names[i], part_dict) == FAIL)
+	    return;
+	dict_add_number(part_dict, "count", rt[i].count);
+	dict_add_number(part_dict, "total", rt[i].total);
+    }
+}
+# endif
+#endif
@@ -473,10 +473,18 @@ typedef struct mf_hashtab_S
  * The used list is a doubly linked list, most recently used block first.
  *	The blocks in the used list have a block of memory allocated.
  *	mf_used_count is the number of pages in the used list.
+ *	The list is split in two parts: first the protected blocks, which
+ *	were used more than once since they were loaded, then the blocks
+ *	that were used only once.  Blocks are released from the end, thus a
+ *	sweep over many blocks doesn't push out the often used ones.
  * The hash lists are used to quickly find a block in the used list.
  * The free list is a single linked list, not sorted.
  *	The blocks in the free list have no block of memory allocated and
  *	the contents of the block in the file (if any) is irrelevant.
+ * The compressed list is a doubly linked list, not sorted.
+ *	When there is no swap file, blocks that would be released are
+ *	compressed and moved from the used list to the compressed list.
+ *	They are also kept in the hash lists.
  */
 
 struct block_hdr
@@ -488,10 +496,14 @@ struct block_hdr
     bhdr_T	*bh_prev;	    /* previous block_hdr in used list */
     char_u	*bh_data;	    /* pointer to memory (for used block) */
     int		bh_page_count;	    /* number of pages in this block */
+    int		bh_comp_size;	    /* size of bh_data when compressed */
 
 #define BH_DIRTY    1
 #define BH_LOCKED   2
-    char	bh_flags;	    /* BH_DIRTY or BH_LOCKED */
+#define BH_PROTECTED 4		    /* in protected part of used list */
+#define BH_COMPRESSED 8		    /* in compressed list */
+#define BH_NOCOMPRESS 16	    /* compressing didn't make it smaller */
+    char	bh_flags;	    /* BH_ flags above */
 };
 
 /*
@@ -608,6 +620,18 @@ struct memfile
     bhdr_T	*mf_used_last;		/* lru block_hdr in used list */
     unsigned	mf_used_count;		/* number of pages in used list */
     unsigned	mf_used_count_max;	/* maximum number of pages in memory */
+    bhdr_T	*mf_prot_last;		/* last protected block in used list */
+    unsigned	mf_prot_count;		/* number of protected pages */
+    long	mf_hits;		/* nr of times a block was in memory */
+    long	mf_misses;		/* nr of times a block was read */
+    long	mf_evictions;		/* nr of blocks released from memory */
+    bhdr_T	*mf_comp_first;		/* first block_hdr in compressed list */
+    long	mf_comp_pages;		/* nr of pages in compressed list */
+    long	mf_comp_bytes;		/* size of compressed blocks */
+    long	mf_decompressions;	/* nr of blocks decompressed */
+#ifdef FEAT_RELTIME
+    proftime_T	mf_decomp_time;		/* time spent decompressing */
+#endif
     mf_hashtab_T mf_hash;		/* hash lists */
     mf_hashtab_T mf_trans;		/* trans lists */
     blocknr_T	mf_blocknr_max;		/* highest positive block number + 1*/
@@ -689,6 +713,9 @@ typedef struct memline
     chunksize_T *ml_chunksize;
     int		ml_numchunks;
     int		ml_usedchunks;
+    chunksize_T *ml_chunktree;	/* Fenwick tree over ml_chunksize[], has
+				   ml_numchunks + 1 entries */
+    int		ml_chunktree_valid; /* ml_chunktree[] is up to date */
 #endif
 } memline_T;
 
@@ -1901,15 +1928,51 @@ typedef struct qf_info_S qf_info_T;
 #endif
 
 #ifdef FEAT_PROFILE
+# define SYN_TIME_BUCKETS	160	/* buckets for the time of a call */
+# define SYN_TIME_LEN_BUCKETS	9	/* buckets for the line length */
+
+/*
+ * Histograms for :syntime, only allocated for a pattern that was used while
+ * timing is on.  Times are in nanoseconds.
+ */
+typedef struct {
+    long	sh_count[SYN_TIME_BUCKETS];	    /* nr of calls per time */
+    long	sh_len_count[SYN_TIME_LEN_BUCKETS]; /* nr of calls per length */
+    varnumber_T	sh_len_total[SYN_TIME_LEN_BUCKETS]; /* time per length */
+} syn_hist_T;
+
 /*
  * Used for :syntime: timing of executing a syntax pattern.
  */
 typedef struct {
-    proftime_T	total;		/* total time used */
-    proftime_T	slowest;	/* time of slowest call */
+    varnumber_T	total;		/* total time used in nsec */
+    varnumber_T	slowest;	/* time of slowest call in nsec */
     long	count;		/* nr of times used */
     long	match;		/* nr of times matched */
+    syn_hist_T	*hist;		/* histograms or NULL */
 } syn_time_T;
+
+/*
+ * Parts of redrawing timed with ":rendertime", index in a render_time_T
+ * array.
+ */
+# define RT_UPDATE_SCREEN	0	/* update_screen() */
+# define RT_WIN_UPDATE		1	/* win_update() */
+# define RT_WIN_LINE		2	/* win_line() */
+# define RT_SYNTAX		3	/* get_syntax_attr() */
+# define RT_SEARCH_HL		4	/* next_search_hl() */
+# define RT_FOLD_LINE		5	/* fold_line() */
+# define RT_OUT_FLUSH		6	/* out_flush() */
+# define RT_COUNT		7
+
+/*
+ * Used for :rendertime: number of calls and time spent in one part of
+ * redrawing.  The time includes the parts called from it.
+ */
+typedef struct {
+    long	count;		/* nr of calls */
+    varnumber_T	total;		/* total time used in nsec */
+} render_time_T;
 #endif
 
 #ifdef FEAT_CRYPT
@@ -1934,6 +1997,8 @@ typedef struct {
 #endif
 
 
+typedef struct synlits_S synlits_T;	// defined in syntax.c
+
 /*
  * These are items normally related to a buffer.  But when using ":ownsyntax"
  * a window may have its own instance.
@@ -1949,6 +2014,7 @@ typedef struct {
     int		b_syn_ic;		/* ignore case for :syn cmds */
     int		b_syn_spell;		/* SYNSPL_ values */
     garray_T	b_syn_patterns;		/* table for syntax patterns */
+    synlits_T	*b_syn_lits;		/* literals of b_syn_patterns or NULL */
     garray_T	b_syn_clusters;		/* table for syntax clusters */
     int		b_spell_cluster_id;	/* @Spell cluster ID or 0 */
     int		b_nospell_cluster_id;	/* @NoSpell cluster ID or 0 */
@@ -1986,6 +2052,7 @@ typedef struct {
      * b_sst_freecount	number of free entries in b_sst_array[]
      * b_sst_check_lnum	entries after this lnum need to be checked for
      *			validity (MAXLNUM means no check needed)
+     * b_sst_idle_lnum	syntax was parsed up to this line while idle
      */
     synstate_T	*b_sst_array;
     int		b_sst_len;
@@ -1994,6 +2061,7 @@ typedef struct {
     int		b_sst_freecount;
     linenr_T	b_sst_check_lnum;
     short_u	b_sst_lasttick;	/* last display tick */
+    linenr_T	b_sst_idle_lnum;
 #endif /* FEAT_SYN_HL */
 
 #ifdef FEAT_SPELL
@@ -2102,6 +2170,12 @@ struct file_buffer
     long	b_mtime_read;	/* last change time when reading */
     off_T	b_orig_size;	/* size of original file in bytes */
     int		b_orig_mode;	/* mode of original file */
+#ifdef USE_INOTIFY
+    int		b_watch_wd;	/* inotify watch of the directory of the file,
+				   zero when not watched */
+    char_u	*b_watch_fname;	/* file name when the watch was added */
+    int		b_watch_changed; /* file may have changed since last check */
+#endif
 #ifdef FEAT_VIMINFO
     time_T	b_last_used;	/* time when the buffer was last used; used
 				 * for viminfo */
@@ -2619,6 +2693,27 @@ typedef struct w_line
 #endif
 } wline_T;
 
+/*
+ * Structure to cache the screen cells of a displayed line in w_line_cache[].
+ * Only lines that take one screen row are cached.  The cells are what
+ * win_line() produced, they can be put back on the screen without rendering
+ * the line again when it is displayed in another row, e.g. after scrolling.
+ * The cells are valid as long as the buffer line is unchanged (b:changedtick)
+ * and the window isn't redrawn with SOME_VALID or higher.
+ */
+typedef struct w_line_cache
+{
+    linenr_T	lc_lnum;	/* buffer line number, zero when unused */
+    int		lc_fnum;	/* buffer number */
+    varnumber_T	lc_changedtick;	/* b:changedtick when the line was drawn */
+    colnr_T	lc_leftcol;	/* w_leftcol when the line was drawn */
+    colnr_T	lc_virtcol;	/* w_virtcol for 'cursorcolumn' */
+    long	lc_relnum;	/* distance to the cursor for 'relativenumber' */
+    int		lc_width;	/* number of cells */
+    int		lc_mco;		/* Screen_mco when allocated, -1 if not utf-8 */
+    char_u	*lc_cells;	/* allocated cell contents */
+} wlcache_T;
+
 /*
  * Windows are kept in a tree of frames.  Each frame has a column (FR_COL)
  * or row (FR_ROW) layout or is a leaf, which has a window.
@@ -2863,6 +2958,17 @@ struct window_S
     int		w_lines_valid;	    /* number of valid entries */
     wline_T	*w_lines;
 
+    /*
+     * Cached screen cells of lines that were displayed in the window,
+     * indexed by the line number modulo w_line_cache_len.  Allocated when
+     * first used.
+     */
+    wlcache_T	*w_line_cache;
+    int		w_line_cache_len;
+#ifdef FEAT_PROFILE
+    render_time_T w_render_time[RT_COUNT]; /* ":rendertime" for this window */
+#endif
+
 #ifdef FEAT_FOLDING
     garray_T	w_folds;	    /* array of nested folds */
     char	w_fold_manual;	    /* when TRUE: some folds are opened/closed
@@ -163,6 +163,11 @@ typedef struct syn_pattern
     struct sp_syn sp_syn;		/* struct passed to in_id_list() */
     char_u	*sp_pattern;		/* regexp to match, pattern */
     regprog_T	*sp_prog;		/* regexp to match, program */
+    char_u	*sp_lit;		/* literal that a match must contain or
+					   NULL, see vim_regprog_literal() */
+    int		 sp_litlen;		/* length of sp_lit */
+    int		 sp_lit_ic;		/* ignore case for sp_lit */
+    int		 sp_lit_idx;		/* index in b_syn_lits or -1 */
 #ifdef FEAT_PROFILE
     syn_time_T	 sp_time;
 #endif
@@ -182,6 +187,37 @@ typedef struct syn_pattern
 
 #define SYN_ITEMS(buf)	((synpat_T *)((buf)->b_syn_patterns.ga_data))
 
+/*
+ * The literals of the match and start patterns of a synblock_T, used to avoid
+ * trying patterns that can't match in the current line.  The literals are
+ * hashed on their first two bytes, folded to lower case, so that all of them
+ * can be found with one pass over the line.
+ */
+typedef struct
+{
+    char_u	*sl_text;	/* literal, points into sp_lit */
+    int		sl_len;		/* length of sl_text */
+    int		sl_ic;		/* ignore case */
+    int		sl_next;	/* next literal in the same bucket or -1 */
+    int		sl_col;		/* last column in the line where sl_text
+				   starts, -1 when it doesn't appear */
+} synlit_T;
+
+#define SYNLIT_HASH_SIZE 1024
+#define SYNLIT_HASH(c1, c2) \
+	    ((((unsigned)(c1) << 4) ^ (unsigned)(c2)) & (SYNLIT_HASH_SIZE - 1))
+
+struct synlits_S
+{
+    garray_T	sls_lits;	/* synlit_T items */
+    int		sls_line_id;	/* current_line_id for the sl_col values */
+    int		sls_head1[256];	/* first one-byte literal for a byte */
+    int		sls_head[SYNLIT_HASH_SIZE]; /* first longer literal in a
+					       bucket */
+};
+
+#define SYN_LITS(sls)	((synlit_T *)((sls)->sls_lits.ga_data))
+
 #define NONE_IDX	-2	/* value of sp_sync_idx for "NONE" */
 
 /*
@@ -407,6 +443,7 @@ static int push_current_state(int idx);
 static void pop_current_state(void);
 #ifdef FEAT_PROFILE
 static void syn_clear_time(syn_time_T *tt);
+static void syn_time_add(syn_time_T *st, varnumber_T nsec, linenr_T lnum, int matched);
 static void syntime_clear(void);
 static void syntime_report(void);
 static int syn_time_on = FALSE;
@@ -425,6 +462,9 @@ static void syn_add_end_off(lpos_T *result, regmmatch_T *regmatch, synpat_T *spp
 static void syn_add_start_off(lpos_T *result, regmmatch_T *regmatch, synpat_T *spp, int idx, int extra);
 static char_u *syn_getcurline(void);
 static int syn_regexec(regmmatch_T *rmp, linenr_T lnum, colnr_T col, syn_time_T *st);
+static void syn_lits_free(synblock_T *block);
+static synlits_T *syn_lits_get(synblock_T *block);
+static int syn_lit_in_line(synlits_T *sls, int lit_idx, int col);
 static int check_keyword_id(char_u *line, int startcol, int *endcol, long *flags, short **next_list, stateitem_T *cur_si, int *ccharp);
 static void syn_remove_pattern(synblock_T *block, int idx);
 static void syn_clear_pattern(synblock_T *block, int i);
@@ -642,6 +682,67 @@ syntax_start(win_T *wp, linenr_T lnum)
     syn_start_line();
 }
 
+#define SYN_IDLE_MSEC	10L	/* time to parse for syn_idle_parse() */
+
+/*
+ * Parse syntax in the current window below the displayed lines, so that
+ * states are stored in b_sst_array[] and jumping to a line further down
+ * later only needs to parse from a nearby state.  Used when Vim is idle, see
+ * 'synidlemem'.  Parses for about SYN_IDLE_MSEC msec, the caller checks for
+ * typeahead in between.
+ * Returns TRUE when there is more to parse.
+ */
+    int
+syn_idle_parse(void)
+{
+    win_T	*wp = curwin;
+    linenr_T	lnum;
+    linenr_T	end;
+#ifdef FEAT_RELTIME
+    proftime_T	tm;
+#else
+    int		count = 0;
+#endif
+
+    if (p_sim <= 0
+	    || updating_screen
+	    || wp->w_buffer->b_ml.ml_mfp == NULL
+	    || wp->w_s->b_syn_slow
+	    || !syntax_present(wp))
+	return FALSE;
+    end = wp->w_buffer->b_ml.ml_line_count;
+    lnum = wp->w_s->b_sst_idle_lnum;
+    if (lnum < wp->w_botline)
+	lnum = wp->w_botline;
+    if (lnum >= end)
+	return FALSE;
+
+#ifdef FEAT_RELTIME
+    profile_setlimit(SYN_IDLE_MSEC, &tm);
+#endif
+    while (lnum < end)
+    {
+	lnum += SST_DIST;
+	if (lnum > end)
+	    lnum = end;
+	syntax_start(wp, lnum);
+	if (got_int)
+	{
+	    /* The state is wrong when interrupted. */
+	    invalidate_current_state();
+	    return FALSE;
+	}
+	wp->w_s->b_sst_idle_lnum = lnum;
+#ifdef FEAT_RELTIME
+	if (profile_passed_limit(&tm))
+#else
+	if (++count == 20)
+#endif
+	    break;
+    }
+    return lnum < end;
+}
+
 /*
  * We cannot simply discard growarrays full of state_items or buf_states; we
  * have to manually release their extmatch pointers first.
@@ -1152,6 +1253,7 @@ syn_stack_free_block(synblock_T *block)
 	block->b_sst_first = NULL;
 	block->b_sst_len = 0;
     }
+    block->b_sst_idle_lnum = 0;
 }
 /*
  * Free b_sst_array[] for buffer "buf".
@@ -1186,14 +1288,25 @@ syn_stack_free_all(synblock_T *block)
 syn_stack_alloc(void)
 {
     long	len;
+    long	maxlen = SST_MAX_ENTRIES;
     synstate_T	*to, *from;
     synstate_T	*sstp;
 
+    /* 'synidlemem' allows for more entries, so that the states parsed while
+     * idle are closer together. */
+    if (p_sim > 0)
+    {
+	len = p_sim > SST_IDLE_MAX_KB ? SST_IDLE_MAX_KB : p_sim;
+	len = len * 1024 / (long)sizeof(synstate_T);
+	if (len > maxlen)
+	    maxlen = len;
+    }
+
     len = syn_buf->b_ml.ml_line_count / SST_DIST + Rows * 2;
     if (len < SST_MIN_ENTRIES)
 	len = SST_MIN_ENTRIES;
-    else if (len > SST_MAX_ENTRIES)
-	len = SST_MAX_ENTRIES;
+    else if (len > maxlen)
+	len = maxlen;
     if (syn_block->b_sst_len > len * 2 || syn_block->b_sst_len < len)
     {
 	/* Allocate 50% too much, to avoid reallocating too often. */
@@ -1201,8 +1314,8 @@ syn_stack_alloc(void)
 	len = (len + len / 2) / SST_DIST + Rows * 2;
 	if (len < SST_MIN_ENTRIES)
 	    len = SST_MIN_ENTRIES;
-	else if (len > SST_MAX_ENTRIES)
-	    len = SST_MAX_ENTRIES;
+	else if (len > maxlen)
+	    len = maxlen;
 
 	if (syn_block->b_sst_array != NULL)
 	{
@@ -1281,6 +1394,10 @@ syn_stack_apply_changes_block(synblock_T *block, buf_T *buf)
     synstate_T	*p, *prev, *np;
     linenr_T	n;
 
+    /* Parsing while idle continues at the change. */
+    if (block->b_sst_idle_lnum > buf->b_mod_top)
+	block->b_sst_idle_lnum = buf->b_mod_top;
+
     prev = NULL;
     for (p = block->b_sst_first; p != NULL; )
     {
@@ -1803,6 +1920,9 @@ get_syntax_attr(
     int		keep_state)	/* keep state of char at "col" */
 {
     int	    attr = 0;
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = 0;
+#endif
 
     if (can_spell != NULL)
 	/* Default: Only do spelling when there is no @Spell cluster or when
@@ -1830,6 +1950,10 @@ get_syntax_attr(
 	return 0;
     }
 
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rt_start = profile_nsec();
+#endif
     /* Make sure current_state is valid */
     if (INVALID_STATE(&current_state))
 	validate_current_state();
@@ -1844,6 +1968,10 @@ get_syntax_attr(
 	++current_col;
     }
 
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_SYNTAX, syn_win, rt_start);
+#endif
     return attr;
 }
 
@@ -1866,6 +1994,7 @@ syn_current_attr(
     int		end_idx;	/* group ID for end pattern */
     int		idx;
     synpat_T	*spp;
+    synlits_T	*sls;
     stateitem_T	*cur_si, *sip = NULL;
     int		startcol;
     int		endcol;
@@ -2052,6 +2181,7 @@ syn_current_attr(
 		     */
 		    next_match_idx = 0;		/* no match in this line yet */
 		    next_match_col = MAXCOL;
+		    sls = syn_lits_get(syn_block);
 		    for (idx = syn_block->b_syn_patterns.ga_len; --idx >= 0; )
 		    {
 			spp = &(SYN_ITEMS(syn_block)[idx]);
@@ -2082,6 +2212,16 @@ syn_current_attr(
 			    if (lc_col < 0)
 				lc_col = 0;
 
+			    /* A match must contain the literal of the pattern,
+			     * no need to try when it's not in the line. */
+			    if (sls != NULL && spp->sp_lit_idx >= 0
+				    && !syn_lit_in_line(sls, spp->sp_lit_idx,
+									lc_col))
+			    {
+				spp->sp_startcol = MAXCOL;
+				continue;
+			    }
+
 			    regmatch.rmm_ic = spp->sp_ic;
 			    regmatch.regprog = spp->sp_prog;
 			    r = syn_regexec(&regmatch,
@@ -3257,6 +3397,145 @@ syn_getcurline(void)
     return ml_get_buf(syn_buf, current_lnum, FALSE);
 }
 
+/*
+ * Free the literals index of "block", after its patterns changed.
+ */
+    static void
+syn_lits_free(synblock_T *block)
+{
+    if (block->b_syn_lits != NULL)
+    {
+	ga_clear(&block->b_syn_lits->sls_lits);
+	VIM_CLEAR(block->b_syn_lits);
+    }
+}
+
+/*
+ * Get the literals index of "block", building it when needed.
+ * Sets sp_lit_idx of every pattern.  Returns NULL when out of memory.
+ */
+    static synlits_T *
+syn_lits_get(synblock_T *block)
+{
+    synlits_T	*sls = block->b_syn_lits;
+    synpat_T	*spp;
+    synlit_T	*slp;
+    int		*headp;
+    int		idx;
+    int		i;
+
+    if (sls != NULL)
+	return sls;
+
+    for (idx = 0; idx < block->b_syn_patterns.ga_len; ++idx)
+	SYN_ITEMS(block)[idx].sp_lit_idx = -1;
+    sls = (synlits_T *)alloc(sizeof(synlits_T));
+    if (sls == NULL)
+	return NULL;
+    ga_init2(&sls->sls_lits, sizeof(synlit_T), 16);
+    sls->sls_line_id = -1;
+    for (i = 0; i < 256; ++i)
+	sls->sls_head1[i] = -1;
+    for (i = 0; i < SYNLIT_HASH_SIZE; ++i)
+	sls->sls_head[i] = -1;
+
+    for (idx = 0; idx < block->b_syn_patterns.ga_len; ++idx)
+    {
+	spp = &(SYN_ITEMS(block)[idx]);
+	if (spp->sp_lit == NULL || (spp->sp_type != SPTYPE_MATCH
+					   && spp->sp_type != SPTYPE_START))
+	    continue;
+
+	if (spp->sp_litlen == 1)
+	    headp = &sls->sls_head1[TOLOWER_ASC(spp->sp_lit[0])];
+	else
+	    headp = &sls->sls_head[SYNLIT_HASH(TOLOWER_ASC(spp->sp_lit[0]),
+						 TOLOWER_ASC(spp->sp_lit[1]))];
+
+	/* Several patterns often have the same literal, share it. */
+	for (i = *headp; i >= 0; i = slp->sl_next)
+	{
+	    slp = &SYN_LITS(sls)[i];
+	    if (slp->sl_len == spp->sp_litlen && slp->sl_ic == spp->sp_lit_ic
+		    && STRNCMP(slp->sl_text, spp->sp_lit, slp->sl_len) == 0)
+		break;
+	}
+	if (i < 0)
+	{
+	    if (ga_grow(&sls->sls_lits, 1) == FAIL)
+	    {
+		ga_clear(&sls->sls_lits);
+		vim_free(sls);
+		for (i = 0; i < idx; ++i)
+		    SYN_ITEMS(block)[i].sp_lit_idx = -1;
+		return NULL;
+	    }
+	    i = sls->sls_lits.ga_len++;
+	    slp = &SYN_LITS(sls)[i];
+	    slp->sl_text = spp->sp_lit;
+	    slp->sl_len = spp->sp_litlen;
+	    slp->sl_ic = spp->sp_lit_ic;
+	    slp->sl_next = *headp;
+	    *headp = i;
+	}
+	spp->sp_lit_idx = i;
+    }
+
+    block->b_syn_lits = sls;
+    return sls;
+}
+
+/*
+ * Return TRUE if literal "lit_idx" of "sls" appears in the current line at
+ * or after column "col".  The first call for a line finds all the literals in
+ * it with one pass over the text.
+ */
+    static int
+syn_lit_in_line(synlits_T *sls, int lit_idx, int col)
+{
+    synlit_T	*lits = SYN_LITS(sls);
+    synlit_T	*slp;
+    char_u	*line;
+    char_u	*p;
+    int		c1, c2;
+    int		i, j;
+
+    if (sls->sls_line_id != current_line_id)
+    {
+	sls->sls_line_id = current_line_id;
+	for (i = 0; i < sls->sls_lits.ga_len; ++i)
+	    lits[i].sl_col = -1;
+
+	line = syn_getcurline();
+	for (p = line; *p != NUL; ++p)
+	{
+	    c1 = TOLOWER_ASC(*p);
+	    for (i = sls->sls_head1[c1]; i >= 0; i = slp->sl_next)
+	    {
+		slp = &lits[i];
+		if (slp->sl_ic || *p == *slp->sl_text)
+		    slp->sl_col = (int)(p - line);
+	    }
+	    if (p[1] == NUL)
+		break;
+	    c2 = TOLOWER_ASC(p[1]);
+	    for (i = sls->sls_head[SYNLIT_HASH(c1, c2)]; i >= 0;
+							   i = slp->sl_next)
+	    {
+		slp = &lits[i];
+		for (j = 0; j < slp->sl_len; ++j)
+		    if (slp->sl_ic ? TOLOWER_ASC(p[j])
+					       != TOLOWER_ASC(slp->sl_text[j])
+						 : p[j] != slp->sl_text[j])
+			break;
+		if (j == slp->sl_len)
+		    slp->sl_col = (int)(p - line);
+	    }
+	}
+    }
+    return lits[lit_idx].sl_col >= col;
+}
+
 /*
  * Call vim_regexec() to find a match with "rmp" in "syn_buf".
  * Returns TRUE when there is a match.
@@ -3273,10 +3552,10 @@ syn_regexec(
     int timed_out = FALSE;
 #endif
 #ifdef FEAT_PROFILE
-    proftime_T	pt;
+    varnumber_T	start = 0;
 
     if (syn_time_on)
-	profile_start(&pt);
+	start = profile_nsec();
 #endif
 
     if (rmp->regprog == NULL)
@@ -3296,15 +3575,7 @@ syn_regexec(
 
 #ifdef FEAT_PROFILE
     if (syn_time_on)
-    {
-	profile_end(&pt);
-	profile_add(&st->total, &pt);
-	if (profile_cmp(&pt, &st->slowest) < 0)
-	    st->slowest = pt;
-	++st->count;
-	if (r > 0)
-	    ++st->match;
-    }
+	syn_time_add(st, profile_nsec() - start, lnum, r > 0);
 #endif
 #ifdef FEAT_RELTIME
     if (timed_out && !syn_win->w_s->b_syn_slow)
@@ -3589,6 +3860,7 @@ syntax_clear(synblock_T *block)
     for (i = block->b_syn_patterns.ga_len; --i >= 0; )
 	syn_clear_pattern(block, i);
     ga_clear(&block->b_syn_patterns);
+    syn_lits_free(block);
 
     /* free the syntax clusters */
     for (i = block->b_syn_clusters.ga_len; --i >= 0; )
@@ -3605,6 +3877,9 @@ syntax_clear(synblock_T *block)
     vim_regfree(block->b_syn_linecont_prog);
     block->b_syn_linecont_prog = NULL;
     VIM_CLEAR(block->b_syn_linecont_pat);
+#ifdef FEAT_PROFILE
+    VIM_CLEAR(block->b_syn_linecont_time.hist);
+#endif
 #ifdef FEAT_FOLDING
     block->b_syn_folditems = 0;
 #endif
@@ -3653,6 +3928,9 @@ syntax_sync_clear(void)
     vim_regfree(curwin->w_s->b_syn_linecont_prog);
     curwin->w_s->b_syn_linecont_prog = NULL;
     VIM_CLEAR(curwin->w_s->b_syn_linecont_pat);
+#ifdef FEAT_PROFILE
+    VIM_CLEAR(curwin->w_s->b_syn_linecont_time.hist);
+#endif
     clear_string_option(&curwin->w_s->b_syn_isk);
 
     syn_stack_free_all(curwin->w_s);	/* Need to recompute all syntax. */
@@ -3688,6 +3966,11 @@ syn_clear_pattern(synblock_T *block, int i)
 {
     vim_free(SYN_ITEMS(block)[i].sp_pattern);
     vim_regfree(SYN_ITEMS(block)[i].sp_prog);
+    vim_free(SYN_ITEMS(block)[i].sp_lit);
+#ifdef FEAT_PROFILE
+    vim_free(SYN_ITEMS(block)[i].sp_time.hist);
+#endif
+    syn_lits_free(block);
     /* Only free sp_cont_list and sp_next_list of first start pattern */
     if (i == 0 || SYN_ITEMS(block)[i - 1].sp_type != SPTYPE_START)
     {
@@ -5058,6 +5341,7 @@ syn_cmd_match(
 		++curwin->w_s->b_syn_folditems;
 #endif
 
+	    syn_lits_free(curwin->w_s);
 	    redraw_curbuf_later(SOME_VALID);
 	    syn_stack_free_all(curwin->w_s);	/* Need to recompute all syntax. */
 	    return;	/* don't free the progs and patterns now */
@@ -5069,6 +5353,7 @@ syn_cmd_match(
      */
     vim_regfree(item.sp_prog);
     vim_free(item.sp_pattern);
+    vim_free(item.sp_lit);
     vim_free(syn_opt_arg.cont_list);
     vim_free(syn_opt_arg.cont_in_list);
     vim_free(syn_opt_arg.next_list);
@@ -5310,6 +5595,7 @@ syn_cmd_region(
 		}
 	    }
 
+	    syn_lits_free(curwin->w_s);
 	    redraw_curbuf_later(SOME_VALID);
 	    syn_stack_free_all(curwin->w_s);	/* Need to recompute all syntax. */
 	    success = TRUE;	    /* don't free the progs and patterns now */
@@ -5326,6 +5612,7 @@ syn_cmd_region(
 	    {
 		vim_regfree(ppp->pp_synp->sp_prog);
 		vim_free(ppp->pp_synp->sp_pattern);
+		vim_free(ppp->pp_synp->sp_lit);
 	    }
 	    vim_free(ppp->pp_synp);
 	    ppp_next = ppp->pp_next;
@@ -5698,6 +5985,7 @@ get_syn_pattern(char_u *arg, synpat_T *ci)
     int		*p;
     int		idx;
     char_u	*cpo_save;
+    char_u	*lit;
 
     /* need at least three chars */
     if (arg == NULL || arg[0] == NUL || arg[1] == NUL || arg[2] == NUL)
@@ -5722,6 +6010,10 @@ get_syn_pattern(char_u *arg, synpat_T *ci)
     if (ci->sp_prog == NULL)
 	return NULL;
     ci->sp_ic = curwin->w_s->b_syn_ic;
+    ci->sp_lit_ic = ci->sp_ic;
+    lit = vim_regprog_literal(ci->sp_prog, &ci->sp_lit_ic, &ci->sp_litlen);
+    if (lit != NULL)
+	ci->sp_lit = vim_strnsave(lit, ci->sp_litlen);
 #ifdef FEAT_PROFILE
     syn_clear_time(&ci->sp_time);
 #endif
@@ -6350,6 +6642,555 @@ ex_syntax(exarg_T *eap)
     }
 }
 
+/*
+ * Cache of the syntax items that were loaded for a 'syntax' value, used when
+ * 'syncache' is set.  Another buffer that sets 'syntax' to the same value
+ * gets a copy of the items instead of sourcing the syntax files again.  The
+ * copy is only used when the files that were sourced have the same contents
+ * and the options and variables that a syntax file may check did not change.
+ */
+typedef struct
+{
+    char_u	*scf_fname;	/* name of a sourced file */
+    hash_T	scf_hash;	/* hash of the file contents */
+    off_T	scf_size;	/* size of the file, -1 when not readable */
+    long	scf_mtime;	/* last modification time of the file */
+} syn_cache_file_T;
+
+typedef struct syn_cache_S syn_cache_T;
+struct syn_cache_S
+{
+    syn_cache_T	*sc_next;
+    char_u	*sc_name;	/* value of 'syntax' */
+    char_u	*sc_key;	/* option values the items depend on */
+    hash_T	sc_vars;	/* hash of the g: and b: variables */
+    garray_T	sc_files;	/* syn_cache_file_T items */
+    int		sc_valid;	/* FALSE when the items can't be cached */
+    char_u	*sc_current_syntax; /* value of b:current_syntax */
+    int		sc_inc_tag;	/* running_syn_inc_tag after loading */
+    synblock_T	sc_block;	/* copy of the syntax items */
+};
+
+#ifdef FEAT_EVAL
+static syn_cache_T *syn_cache_first = NULL;
+static syn_cache_T *syn_cache_loading = NULL; /* entry for items being
+						 loaded or NULL */
+
+/*
+ * Copy the keywords in hashtable "from" to hashtable "to".
+ */
+    static int
+syn_copy_keywtab(hashtab_T *to, hashtab_T *from)
+{
+    hashitem_T	*hi;
+    int		todo;
+    keyentry_T	*kp;
+    keyentry_T	*np;
+    keyentry_T	*first;
+    keyentry_T	**npp;
+    size_t	len;
+    int		ret = OK;
+
+    todo = (int)from->ht_used;
+    for (hi = from->ht_array; todo > 0 && ret == OK; ++hi)
+    {
+	if (HASHITEM_EMPTY(hi))
+	    continue;
+	--todo;
+	first = NULL;
+	npp = &first;
+	for (kp = HI2KE(hi); kp != NULL; kp = kp->ke_next)
+	{
+	    len = sizeof(keyentry_T) + STRLEN(kp->keyword);
+	    np = (keyentry_T *)alloc((unsigned)len);
+	    if (np == NULL)
+	    {
+		ret = FAIL;
+		break;
+	    }
+	    mch_memmove(np, kp, len);
+	    np->ke_next = NULL;
+	    np->k_syn.cont_in_list = copy_id_list(kp->k_syn.cont_in_list);
+	    np->next_list = copy_id_list(kp->next_list);
+	    *npp = np;
+	    npp = &np->ke_next;
+	    if ((kp->k_syn.cont_in_list != NULL
+					   && np->k_syn.cont_in_list == NULL)
+		    || (kp->next_list != NULL && np->next_list == NULL))
+	    {
+		ret = FAIL;
+		break;
+	    }
+	}
+	if (first != NULL && hash_add_item(to, hash_lookup(to, first->keyword,
+			     hi->hi_hash), first->keyword, hi->hi_hash) == FAIL)
+	{
+	    for (kp = first; kp != NULL; kp = np)
+	    {
+		np = kp->ke_next;
+		vim_free(kp->next_list);
+		vim_free(kp->k_syn.cont_in_list);
+		vim_free(kp);
+	    }
+	    ret = FAIL;
+	}
+    }
+    return ret;
+}
+
+/*
+ * Copy an ID list of pattern "idx" in "from" that may be shared with the
+ * previous pattern, see syn_clear_pattern().
+ */
+#define SYN_COPY_LIST(field) \
+    if (idx > 0 && SYN_ITEMS(from)[idx - 1].sp_type == SPTYPE_START) \
+	tp->field = fp->field == NULL ? NULL : SYN_ITEMS(to)[idx - 1].field; \
+    else if ((tp->field = copy_id_list(fp->field)) == NULL \
+							 && fp->field != NULL) \
+	return FAIL;
+
+/*
+ * Copy the syntax items of "from" to "to", which must be empty.
+ * When failing "to" may have been partly filled, use syntax_clear().
+ */
+    static int
+syn_copy_block(synblock_T *to, synblock_T *from)
+{
+    int		idx;
+    synpat_T	*fp;
+    synpat_T	*tp;
+    syn_cluster_T *fcp;
+    syn_cluster_T *tcp;
+
+    to->b_syn_patterns.ga_itemsize = sizeof(synpat_T);
+    to->b_syn_patterns.ga_growsize = 10;
+    to->b_syn_clusters.ga_itemsize = sizeof(syn_cluster_T);
+    to->b_syn_clusters.ga_growsize = 10;
+    to->b_syn_ic = from->b_syn_ic;
+    to->b_syn_spell = from->b_syn_spell;
+    to->b_syn_containedin = from->b_syn_containedin;
+    to->b_spell_cluster_id = from->b_spell_cluster_id;
+    to->b_nospell_cluster_id = from->b_nospell_cluster_id;
+    to->b_syn_sync_flags = from->b_syn_sync_flags;
+    to->b_syn_sync_id = from->b_syn_sync_id;
+    to->b_syn_sync_minlines = from->b_syn_sync_minlines;
+    to->b_syn_sync_maxlines = from->b_syn_sync_maxlines;
+    to->b_syn_sync_linebreaks = from->b_syn_sync_linebreaks;
+    to->b_syn_topgrp = from->b_syn_topgrp;
+# ifdef FEAT_CONCEAL
+    to->b_syn_conceal = from->b_syn_conceal;
+# endif
+# ifdef FEAT_FOLDING
+    to->b_syn_folditems = from->b_syn_folditems;
+# endif
+    mch_memmove(to->b_syn_chartab, from->b_syn_chartab,
+						   sizeof(to->b_syn_chartab));
+    if (from->b_syn_isk != NULL && from->b_syn_isk != empty_option)
+    {
+	to->b_syn_isk = vim_strsave(from->b_syn_isk);
+	if (to->b_syn_isk == NULL)
+	    return FAIL;
+    }
+
+    if (syn_copy_keywtab(&to->b_keywtab, &from->b_keywtab) == FAIL
+	    || syn_copy_keywtab(&to->b_keywtab_ic, &from->b_keywtab_ic) == FAIL)
+	return FAIL;
+
+    if (ga_grow(&to->b_syn_patterns, from->b_syn_patterns.ga_len) == FAIL)
+	return FAIL;
+    for (idx = 0; idx < from->b_syn_patterns.ga_len; ++idx)
+    {
+	fp = &SYN_ITEMS(from)[idx];
+	tp = &SYN_ITEMS(to)[idx];
+	*tp = *fp;
+	tp->sp_pattern = NULL;
+	tp->sp_prog = NULL;
+	tp->sp_lit = NULL;
+	tp->sp_lit_idx = -1;
+	tp->sp_line_id = 0;
+	tp->sp_startcol = 0;
+# ifdef FEAT_PROFILE
+	syn_clear_time(&tp->sp_time);
+# endif
+	tp->sp_cont_list = NULL;
+	tp->sp_next_list = NULL;
+	tp->sp_syn.cont_in_list = NULL;
+	++to->b_syn_patterns.ga_len;
+
+	SYN_COPY_LIST(sp_cont_list);
+	SYN_COPY_LIST(sp_next_list);
+	SYN_COPY_LIST(sp_syn.cont_in_list);
+	tp->sp_pattern = vim_strsave(fp->sp_pattern);
+	if (fp->sp_prog != NULL)
+	    tp->sp_prog = vim_regdup(fp->sp_prog);
+	if (fp->sp_lit != NULL)
+	    tp->sp_lit = vim_strnsave(fp->sp_lit, fp->sp_litlen);
+	if (tp->sp_pattern == NULL
+		|| (fp->sp_prog != NULL && tp->sp_prog == NULL)
+		|| (fp->sp_lit != NULL && tp->sp_lit == NULL))
+	    return FAIL;
+    }
+
+    if (ga_grow(&to->b_syn_clusters, from->b_syn_clusters.ga_len) == FAIL)
+	return FAIL;
+    for (idx = 0; idx < from->b_syn_clusters.ga_len; ++idx)
+    {
+	fcp = &SYN_CLSTR(from)[idx];
+	tcp = &SYN_CLSTR(to)[idx];
+	tcp->scl_name = vim_strsave(fcp->scl_name);
+	tcp->scl_name_u = vim_strsave(fcp->scl_name_u);
+	tcp->scl_list = copy_id_list(fcp->scl_list);
+	++to->b_syn_clusters.ga_len;
+	if (tcp->scl_name == NULL || tcp->scl_name_u == NULL
+		|| (fcp->scl_list != NULL && tcp->scl_list == NULL))
+	    return FAIL;
+    }
+
+    if (from->b_syn_linecont_pat != NULL)
+    {
+	to->b_syn_linecont_pat = vim_strsave(from->b_syn_linecont_pat);
+	if (to->b_syn_linecont_pat == NULL)
+	    return FAIL;
+	to->b_syn_linecont_ic = from->b_syn_linecont_ic;
+	if (from->b_syn_linecont_prog != NULL)
+	{
+	    to->b_syn_linecont_prog = vim_regdup(from->b_syn_linecont_prog);
+	    if (to->b_syn_linecont_prog == NULL)
+		return FAIL;
+	}
+# ifdef FEAT_PROFILE
+	syn_clear_time(&to->b_syn_linecont_time);
+# endif
+    }
+    return OK;
+}
+
+/*
+ * Return a hash of the names and values of the variables in "ht".  Only the
+ * type of a List or Dictionary is used.  The order of the items does not
+ * matter.
+ */
+    static hash_T
+syn_cache_hash_vars(hashtab_T *ht)
+{
+    hashitem_T	*hi;
+    int		todo;
+    dictitem_T	*di;
+    hash_T	hash = 0;
+    hash_T	h;
+
+    todo = (int)ht->ht_used;
+    for (hi = ht->ht_array; todo > 0; ++hi)
+    {
+	if (HASHITEM_EMPTY(hi))
+	    continue;
+	--todo;
+	di = HI2DI(hi);
+	/* b:changedtick changes all the time, b:current_syntax is set by the
+	 * syntax file itself. */
+	if (ht != &globvardict.dv_hashtab
+		&& (STRCMP(di->di_key, "changedtick") == 0
+		    || STRCMP(di->di_key, "current_syntax") == 0))
+	    continue;
+	h = hi->hi_hash * 101 + di->di_tv.v_type;
+	if (di->di_tv.v_type == VAR_NUMBER || di->di_tv.v_type == VAR_SPECIAL)
+	    h = h * 101 + (hash_T)di->di_tv.vval.v_number;
+	else if (di->di_tv.v_type == VAR_STRING
+					 && di->di_tv.vval.v_string != NULL)
+	    h = h * 101 + hash_hash(di->di_tv.vval.v_string);
+	hash += h;
+    }
+    return hash;
+}
+
+/*
+ * Compute the hash and size of the contents of file "fname".
+ */
+    static void
+syn_cache_hash_file(char_u *fname, hash_T *hashp, off_T *sizep)
+{
+    FILE	*fd;
+    char_u	buf[8192];
+    size_t	len;
+    size_t	i;
+    hash_T	hash = 0;
+    off_T	size = 0;
+
+    *hashp = 0;
+    *sizep = -1;
+    fd = mch_fopen((char *)fname, READBIN);
+    if (fd == NULL)
+	return;
+    while ((len = fread(buf, 1, sizeof(buf), fd)) > 0)
+    {
+	for (i = 0; i < len; ++i)
+	    hash = hash * 101 + buf[i];
+	size += len;
+    }
+    fclose(fd);
+    *hashp = hash;
+    *sizep = size;
+}
+
+/*
+ * Return the option values the syntax items for "name" in the current buffer
+ * may depend on, in allocated memory.
+ */
+    static char_u *
+syn_cache_make_key(char_u *name)
+{
+    garray_T	ga;
+
+    ga_init2(&ga, 1, 200);
+    ga_concat(&ga, name);
+    ga_append(&ga, '\n');
+    ga_concat(&ga, curbuf->b_p_ft);
+    ga_append(&ga, '\n');
+    ga_concat(&ga, curbuf->b_p_isk);
+    ga_append(&ga, '\n');
+    ga_concat(&ga, p_bg);
+    ga_append(&ga, '\n');
+    ga_concat(&ga, p_cpo);
+    ga_append(&ga, '\n');
+    ga_concat(&ga, p_enc);
+    ga_append(&ga, '\n');
+    ga_concat(&ga, p_rtp);
+    ga_append(&ga, NUL);
+    return (char_u *)ga.ga_data;
+}
+
+/*
+ * Return the last modification time of file "fname", zero when it can't be
+ * found or the size is not "size".
+ */
+    static long
+syn_cache_mtime(char_u *fname, off_T size)
+{
+    stat_T	st;
+
+    if (mch_stat((char *)fname, &st) < 0 || (off_T)st.st_size != size)
+	return 0;
+    return (long)st.st_mtime;
+}
+
+/*
+ * Return TRUE when the files sourced for "sc" still have the same contents.
+ * The contents is only read again when the size or modification time
+ * changed.
+ */
+    static int
+syn_cache_files_same(syn_cache_T *sc)
+{
+    int		    i;
+    syn_cache_file_T *scf;
+    hash_T	    hash;
+    off_T	    size;
+    long	    mtime;
+
+    for (i = 0; i < sc->sc_files.ga_len; ++i)
+    {
+	scf = ((syn_cache_file_T *)sc->sc_files.ga_data) + i;
+	mtime = syn_cache_mtime(scf->scf_fname, scf->scf_size);
+	if (mtime != 0 && mtime == scf->scf_mtime)
+	    continue;
+	syn_cache_hash_file(scf->scf_fname, &hash, &size);
+	if (hash != scf->scf_hash || size != scf->scf_size)
+	    return FALSE;
+	scf->scf_mtime = mtime;
+    }
+    return TRUE;
+}
+
+/*
+ * Free cache entry "sc".
+ */
+    static void
+syn_cache_free(syn_cache_T *sc)
+{
+    int		i;
+    int		save_inc_tag = running_syn_inc_tag;
+
+    if (sc == NULL)
+	return;
+    vim_free(sc->sc_name);
+    vim_free(sc->sc_key);
+    for (i = 0; i < sc->sc_files.ga_len; ++i)
+	vim_free(((syn_cache_file_T *)sc->sc_files.ga_data)[i].scf_fname);
+    ga_clear(&sc->sc_files);
+    vim_free(sc->sc_current_syntax);
+    syntax_clear(&sc->sc_block);
+    running_syn_inc_tag = save_inc_tag;
+    vim_free(sc);
+}
+
+/*
+ * Use the syntax items of cache entry "sc" for the current buffer, like the
+ * syntax file had been sourced.
+ */
+    static int
+syn_cache_use(syn_cache_T *sc)
+{
+    synblock_T	*block = &curbuf->b_s;
+
+    syntax_clear(block);
+    if (syn_copy_block(block, &sc->sc_block) == FAIL)
+    {
+	syntax_clear(block);
+	return FAIL;
+    }
+    running_syn_inc_tag = sc->sc_inc_tag;
+    do_unlet((char_u *)"w:current_syntax", TRUE);
+    set_internal_string_var((char_u *)"b:current_syntax",
+						       sc->sc_current_syntax);
+    redraw_curbuf_later(SOME_VALID);
+    syn_stack_free_all(block);
+    return OK;
+}
+#endif
+
+/*
+ * Apply the Syntax autocommands for "name" in the current buffer.  When
+ * 'syncache' is set and the syntax items for "name" were loaded before, use
+ * a copy of them instead, when possible.
+ */
+    void
+syn_apply_autocmds(char_u *name, int force)
+{
+#ifdef FEAT_EVAL
+    buf_T	*buf = curbuf;
+    syn_cache_T	*sc;
+    syn_cache_T	*new_sc;
+    syn_cache_T	**scp;
+    char_u	*key;
+    char_u	*p;
+    hash_T	vars;
+    int		save_called_emsg;
+
+    if (syn_cache_loading != NULL)
+	/* Loading syntax items recursively, can't cache them. */
+	syn_cache_loading->sc_valid = FALSE;
+    else if (p_syc && force && *name != NUL
+	    && STRCMP(name, "ON") != 0 && STRCMP(name, "OFF") != 0
+	    && curwin->w_s == &buf->b_s
+	    && !event_ignored(EVENT_SYNTAX)
+	    && !is_autocmd_blocked()
+	    && has_autocmd(EVENT_SYNTAX, name, buf))
+    {
+	key = syn_cache_make_key(name);
+	if (key == NULL)
+	    return;
+	vars = syn_cache_hash_vars(&globvardict.dv_hashtab)
+			       + syn_cache_hash_vars(&buf->b_vars->dv_hashtab);
+
+	for (scp = &syn_cache_first; *scp != NULL; scp = &(*scp)->sc_next)
+	    if (STRCMP((*scp)->sc_name, name) == 0)
+		break;
+	sc = *scp;
+	if (sc != NULL && sc->sc_vars == vars && STRCMP(sc->sc_key, key) == 0
+		&& syn_cache_files_same(sc) && syn_cache_use(sc) == OK)
+	{
+	    vim_free(key);
+	    return;
+	}
+
+	new_sc = (syn_cache_T *)alloc_clear((unsigned)sizeof(syn_cache_T));
+	if (new_sc == NULL)
+	{
+	    vim_free(key);
+	    return;
+	}
+	new_sc->sc_name = vim_strsave(name);
+	new_sc->sc_key = key;
+	new_sc->sc_vars = vars;
+	new_sc->sc_valid = new_sc->sc_name != NULL;
+	ga_init2(&new_sc->sc_files, sizeof(syn_cache_file_T), 4);
+	hash_init(&new_sc->sc_block.b_keywtab);
+	hash_init(&new_sc->sc_block.b_keywtab_ic);
+
+	save_called_emsg = called_emsg;
+	called_emsg = FALSE;
+	syn_cache_loading = new_sc;
+	apply_autocmds(EVENT_SYNTAX, name, buf->b_fname, force, buf);
+	syn_cache_loading = NULL;
+
+	/* Only cache the items when loading went fine, in the same buffer. */
+	if (new_sc->sc_valid && !called_emsg && new_sc->sc_files.ga_len > 0
+		&& curbuf == buf && curwin->w_s == &buf->b_s
+		&& (p = get_var_value((char_u *)"b:current_syntax")) != NULL
+		&& (new_sc->sc_current_syntax = vim_strsave(p)) != NULL
+		&& syn_copy_block(&new_sc->sc_block, &buf->b_s) == OK)
+	{
+	    new_sc->sc_inc_tag = running_syn_inc_tag;
+	    /* The list may have changed, find the old entry again. */
+	    for (scp = &syn_cache_first; *scp != NULL; scp = &(*scp)->sc_next)
+		if (STRCMP((*scp)->sc_name, name) == 0)
+		{
+		    sc = *scp;
+		    *scp = sc->sc_next;
+		    syn_cache_free(sc);
+		    break;
+		}
+	    new_sc->sc_next = syn_cache_first;
+	    syn_cache_first = new_sc;
+	}
+	else
+	    syn_cache_free(new_sc);
+	called_emsg |= save_called_emsg;
+	return;
+    }
+#endif
+    apply_autocmds(EVENT_SYNTAX, name, curbuf->b_fname, force, curbuf);
+}
+
+/*
+ * Called when file "fname" is sourced, remember it when loading syntax
+ * items that are going to be cached.
+ */
+    void
+syn_cache_sourced(char_u *fname)
+{
+#ifdef FEAT_EVAL
+    syn_cache_file_T	*scf;
+
+    if (syn_cache_loading == NULL || !syn_cache_loading->sc_valid)
+	return;
+    if (ga_grow(&syn_cache_loading->sc_files, 1) == FAIL)
+    {
+	syn_cache_loading->sc_valid = FALSE;
+	return;
+    }
+    scf = ((syn_cache_file_T *)syn_cache_loading->sc_files.ga_data)
+					    + syn_cache_loading->sc_files.ga_len;
+    scf->scf_fname = vim_strsave(fname);
+    if (scf->scf_fname == NULL)
+    {
+	syn_cache_loading->sc_valid = FALSE;
+	return;
+    }
+    syn_cache_hash_file(fname, &scf->scf_hash, &scf->scf_size);
+    scf->scf_mtime = syn_cache_mtime(fname, scf->scf_size);
+    ++syn_cache_loading->sc_files.ga_len;
+#endif
+}
+
+/*
+ * Forget all the cached syntax items.
+ */
+    void
+syn_cache_clear(void)
+{
+#ifdef FEAT_EVAL
+    syn_cache_T	*sc;
+
+    while (syn_cache_first != NULL)
+    {
+	sc = syn_cache_first;
+	syn_cache_first = sc->sc_next;
+	syn_cache_free(sc);
+    }
+#endif
+}
+
     void
 ex_ownsyntax(exarg_T *eap)
 {
@@ -6642,13 +7483,146 @@ ex_syntime(exarg_T *eap)
 	semsg(_(e_invarg2), eap->arg);
 }
 
+/*
+ * Initialize the timing in "st".  Does not free the histograms.
+ */
     static void
 syn_clear_time(syn_time_T *st)
 {
-    profile_zero(&st->total);
-    profile_zero(&st->slowest);
+    st->total = 0;
+    st->slowest = 0;
     st->count = 0;
     st->match = 0;
+    st->hist = NULL;
+}
+
+/*
+ * Return the index in sh_count[] for a call that took "nsec" nanoseconds.
+ * There are four buckets for every power of two.
+ */
+    static int
+syn_time_bucket(varnumber_T nsec)
+{
+    int		e = 2;
+    int		idx;
+
+    if (nsec < 4)
+	return nsec < 0 ? 0 : (int)nsec;
+    while ((nsec >> (e + 1)) != 0)
+	++e;
+    idx = (e - 1) * 4 + (int)((nsec >> (e - 2)) & 3);
+    return idx < SYN_TIME_BUCKETS ? idx : SYN_TIME_BUCKETS - 1;
+}
+
+/*
+ * Return the highest number of nanoseconds in sh_count[idx].
+ */
+    static varnumber_T
+syn_time_bucket_max(int idx)
+{
+    if (idx < 4)
+	return idx;
+    return ((varnumber_T)(5 + idx % 4) << (idx / 4 - 1)) - 1;
+}
+
+/*
+ * Return the index in sh_len_count[] for a line of "len" bytes:
+ * 0 - 31, 32 - 63, 64 - 127, etc.
+ */
+    static int
+syn_len_bucket(long len)
+{
+    int		idx = 0;
+
+    while (len >= 32 && idx < SYN_TIME_LEN_BUCKETS - 1)
+    {
+	len >>= 1;
+	++idx;
+    }
+    return idx;
+}
+
+/*
+ * Add a call of syn_regexec() for line "lnum" that took "nsec" nanoseconds
+ * to "st".
+ */
+    static void
+syn_time_add(
+    syn_time_T	*st,
+    varnumber_T	nsec,
+    linenr_T	lnum,
+    int		matched)
+{
+    /* Remember the length of the last line, patterns are tried on the
+     * same line many times. */
+    static buf_T	*len_buf = NULL;
+    static linenr_T	len_lnum = 0;
+    static varnumber_T	len_tick = 0;
+    static int		len_idx = 0;
+
+    st->total += nsec;
+    if (nsec > st->slowest)
+	st->slowest = nsec;
+    ++st->count;
+    if (matched)
+	++st->match;
+
+    if (st->hist == NULL)
+	st->hist = (syn_hist_T *)alloc_clear((unsigned)sizeof(syn_hist_T));
+    if (st->hist == NULL)
+	return;
+    if (syn_buf != len_buf || lnum != len_lnum
+				  || CHANGEDTICK(syn_buf) != len_tick)
+    {
+	len_buf = syn_buf;
+	len_lnum = lnum;
+	len_tick = CHANGEDTICK(syn_buf);
+	len_idx = syn_len_bucket((long)STRLEN(ml_get_buf(syn_buf, lnum,
+								     FALSE)));
+    }
+    ++st->hist->sh_count[syn_time_bucket(nsec)];
+    ++st->hist->sh_len_count[len_idx];
+    st->hist->sh_len_total[len_idx] += nsec;
+}
+
+/*
+ * Return an estimate of the time in nanoseconds that "percent" percent of
+ * the calls in "st" did not exceed.
+ */
+    static varnumber_T
+syn_time_percentile(syn_time_T *st, int percent)
+{
+    varnumber_T	need = ((varnumber_T)st->count * percent + 99) / 100;
+    varnumber_T	seen = 0;
+    varnumber_T	nsec;
+    int		idx;
+
+    if (st->hist == NULL)
+	return 0;
+    for (idx = 0; idx < SYN_TIME_BUCKETS; ++idx)
+    {
+	seen += st->hist->sh_count[idx];
+	if (seen >= need)
+	{
+	    nsec = syn_time_bucket_max(idx);
+	    return nsec < st->slowest ? nsec : st->slowest;
+	}
+    }
+    return st->slowest;
+}
+
+/*
+ * Return "nsec" nanoseconds as seconds in a static buffer, like
+ * profile_msg().
+ */
+    static char *
+syn_time_msg(varnumber_T nsec)
+{
+    static char buf[50];
+
+    sprintf(buf, "%3ld.%06ld", (long)(nsec / 1000000000),
+					      (long)(nsec % 1000000000 / 1000));
+    return buf;
 }
 
 /*
@@ -6668,6 +7642,7 @@ syntime_clear(void)
     for (idx = 0; idx < curwin->w_s->b_syn_patterns.ga_len; ++idx)
     {
 	spp = &(SYN_ITEMS(curwin->w_s)[idx]);
+	vim_free(spp->sp_time.hist);
 	syn_clear_time(&spp->sp_time);
     }
 }
@@ -6693,11 +7668,11 @@ get_syntime_arg(expand_T *xp UNUSED, int idx)
 
 typedef struct
 {
-    proftime_T	total;
+    varnumber_T	total;
     int		count;
     int		match;
-    proftime_T	slowest;
-    proftime_T	average;
+    varnumber_T	slowest;
+    varnumber_T	average;
     int		id;
     char_u	*pattern;
 } time_entry_T;
@@ -6711,7 +7686,7 @@ syn_compare_syntime(const void *v1, const void *v2)
     const time_entry_T	*s1 = v1;
     const time_entry_T	*s2 = v2;
 
-    return profile_cmp(&s1->total, &s2->total);
+    return s1->total > s2->total ? -1 : s1->total < s2->total ? 1 : 0;
 }
 
 /*
@@ -6722,11 +7697,8 @@ syntime_report(void)
 {
     int		idx;
     synpat_T	*spp;
-# ifdef FEAT_FLOAT
-    proftime_T	tm;
-# endif
     int		len;
-    proftime_T	total_total;
+    varnumber_T	total_total = 0;
     int		total_count = 0;
     garray_T    ga;
     time_entry_T *p;
@@ -6738,7 +7710,6 @@ syntime_report(void)
     }
 
     ga_init2(&ga, sizeof(time_entry_T), 50);
-    profile_zero(&total_total);
     for (idx = 0; idx < curwin->w_s->b_syn_patterns.ga_len; ++idx)
     {
 	spp = &(SYN_ITEMS(curwin->w_s)[idx]);
@@ -6747,15 +7718,12 @@ syntime_report(void)
 	    (void)ga_grow(&ga, 1);
 	    p = ((time_entry_T *)ga.ga_data) + ga.ga_len;
 	    p->total = spp->sp_time.total;
-	    profile_add(&total_total, &spp->sp_time.total);
+	    total_total += spp->sp_time.total;
 	    p->count = spp->sp_time.count;
 	    p->match = spp->sp_time.match;
 	    total_count += spp->sp_time.count;
 	    p->slowest = spp->sp_time.slowest;
-# ifdef FEAT_FLOAT
-	    profile_divide(&spp->sp_time.total, spp->sp_time.count, &tm);
-	    p->average = tm;
-# endif
+	    p->average = spp->sp_time.total / spp->sp_time.count;
 	    p->id = spp->sp_syn.id;
 	    p->pattern = spp->sp_pattern;
 	    ++ga.ga_len;
@@ -6774,7 +7742,7 @@ syntime_report(void)
     {
 	p = ((time_entry_T *)ga.ga_data) + idx;
 
-	msg_puts(profile_msg(&p->total));
+	msg_puts(syn_time_msg(p->total));
 	msg_puts(" "); /* make sure there is always a separating space */
 	msg_advance(13);
 	msg_outnum(p->count);
@@ -6783,13 +7751,11 @@ syntime_report(void)
 	msg_outnum(p->match);
 	msg_puts(" ");
 	msg_advance(26);
-	msg_puts(profile_msg(&p->slowest));
+	msg_puts(syn_time_msg(p->slowest));
 	msg_puts(" ");
 	msg_advance(38);
-# ifdef FEAT_FLOAT
-	msg_puts(profile_msg(&p->average));
+	msg_puts(syn_time_msg(p->average));
 	msg_puts(" ");
-# endif
 	msg_advance(50);
 	msg_outtrans(HL_TABLE()[p->id - 1].sg_name);
 	msg_puts(" ");
@@ -6808,12 +7774,66 @@ syntime_report(void)
     if (!got_int)
     {
 	msg_puts("\n");
-	msg_puts(profile_msg(&total_total));
+	msg_puts(syn_time_msg(total_total));
 	msg_advance(13);
 	msg_outnum(total_count);
 	msg_puts("\n");
     }
 }
+
+# if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * Add a Dictionary with the ":syntime" results of each pattern in the current
+ * buffer that was used to "list".  For syntime_list().
+ */
+    void
+syntime_list(list_T *list)
+{
+    int		idx;
+    int		i;
+    synpat_T	*spp;
+    syn_time_T	*st;
+    dict_T	*dict;
+    dict_T	*len_dict;
+    list_T	*len_list;
+
+    for (idx = 0; idx < curwin->w_s->b_syn_patterns.ga_len; ++idx)
+    {
+	spp = &(SYN_ITEMS(curwin->w_s)[idx]);
+	st = &spp->sp_time;
+	if (st->count == 0)
+	    continue;
+	if ((dict = dict_alloc()) == NULL || list_append_dict(list, dict) == FAIL)
+	{
+	    dict_unref(dict);
+	    return;
+	}
+	dict_add_string(dict, "name", HL_TABLE()[spp->sp_syn.id - 1].sg_name);
+	dict_add_string(dict, "pattern", spp->sp_pattern);
+	dict_add_number(dict, "count", st->count);
+	dict_add_number(dict, "match", st->match);
+	dict_add_number(dict, "total", st->total);
+	dict_add_number(dict, "max", st->slowest);
+	dict_add_number(dict, "p50", syn_time_percentile(st, 50));
+	dict_add_number(dict, "p99", syn_time_percentile(st, 99));
+
+	if ((len_list = list_alloc()) == NULL)
+	    return;
+	dict_add_list(dict, "linelen", len_list);
+	for (i = 0; i < SYN_TIME_LEN_BUCKETS; ++i)
+	{
+	    if ((len_dict = dict_alloc()) == NULL)
+		return;
+	    list_append_dict(len_list, len_dict);
+	    dict_add_number(len_dict, "minlen", i == 0 ? 0 : 16L << i);
+	    dict_add_number(len_dict, "count",
+			      st->hist == NULL ? 0 : st->hist->sh_len_count[i]);
+	    dict_add_number(len_dict, "total",
+			      st->hist == NULL ? 0 : st->hist->sh_len_total[i]);
+	}
+    }
+}
+# endif
 #endif
 
 #endif /* FEAT_SYN_HL */
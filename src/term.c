@@ -1619,6 +1619,7 @@ get_term_entries(int *height, int *width)
 			{KS_CPS, "PS"}, {KS_CPE, "PE"},
 			{KS_CST, "ST"}, {KS_CRT, "RT"},
 			{KS_SSI, "Si"}, {KS_SRI, "Ri"},
+			{KS_CBS, "BS"}, {KS_CES, "ES"},
 			{(enum SpecialKey)0, NULL}
 		    };
     int		    i;
@@ -2548,6 +2549,94 @@ termcapinit(char_u *name)
 static char_u		out_buf[OUT_SIZE + 1];
 static int		out_pos = 0;	/* number of chars in out_buf */
 
+/*
+ * While drawing a frame, see out_frame_start(), output that doesn't fit in
+ * out_buf is kept in "out_ga", so that the whole frame is written at once.
+ */
+static garray_T		out_ga = {0, 0, 1, 4096, NULL};
+static int		out_frame = 0;	/* nesting of out_frame_start() */
+static int		out_frame_sync = -1; /* pending output after t_BS or
+						-1 */
+
+static void out_buf_full(void);
+
+/*
+ * Put terminal code "s" in the output buffer, without padding.
+ */
+    static void
+out_frame_code(char_u *s)
+{
+    if (out_pos > OUT_SIZE - 20)  /* avoid terminal strings being split up */
+	out_buf_full();
+    while (*s != NUL)
+    {
+	out_buf[out_pos++] = *s++;
+	if (out_pos >= OUT_SIZE)
+	    out_buf_full();
+    }
+}
+
+/*
+ * Output the begin synchronized update code when drawing a frame.
+ */
+    static void
+out_frame_sync_start(void)
+{
+    if (*T_BS != NUL && *T_ES != NUL)
+    {
+	out_frame_code(T_BS);
+	out_frame_sync = out_ga.ga_len + out_pos;
+    }
+}
+
+/*
+ * Output the end synchronized update code when drawing a frame.  When nothing
+ * was output since the begin code, drop that instead.
+ */
+    static void
+out_frame_sync_end(void)
+{
+    int	    len;
+    int	    empty;
+
+    if (out_frame_sync < 0)
+	return;
+    empty = out_ga.ga_len + out_pos == out_frame_sync;
+    /* reset before output, to avoid recursiveness */
+    out_frame_sync = -1;
+    if (empty)
+    {
+	len = (int)STRLEN(T_BS);
+	if (out_pos >= len)
+	    out_pos -= len;
+	else
+	{
+	    out_ga.ga_len -= len - out_pos;
+	    out_pos = 0;
+	}
+    }
+    else
+	out_frame_code(T_ES);
+}
+
+/*
+ * Called when out_buf is full: flush it, or when drawing a frame append it
+ * to "out_ga".
+ */
+    static void
+out_buf_full(void)
+{
+    if (out_frame > 0 && !p_wd && ga_grow(&out_ga, out_pos + 1) == OK)
+    {
+	mch_memmove((char_u *)out_ga.ga_data + out_ga.ga_len, out_buf,
+							     (size_t)out_pos);
+	out_ga.ga_len += out_pos;
+	out_pos = 0;
+    }
+    else
+	out_flush();
+}
+
 /*
  * out_flush(): flush the output buffer
  */
@@ -2555,7 +2644,37 @@ static int		out_pos = 0;	/* number of chars in out_buf */
 out_flush(void)
 {
     int	    len;
+    int	    sync = out_frame_sync >= 0;
+#ifdef FEAT_PROFILE
+    varnumber_T	rt_start = 0;
+
+    /* Only count a call that writes something. */
+    if (rendertime_on && (sync || out_ga.ga_len > 0 || out_pos != 0))
+	rt_start = profile_nsec();
+#endif
 
+    if (sync)
+	/* Terminate the synchronized update, the terminal will show what was
+	 * drawn so far. */
+	out_frame_sync_end();
+    if (out_ga.ga_len > 0)
+    {
+	/* Write "out_ga" and out_buf with one call.  One byte extra for
+	 * mch_write() in os_win32.c to append a NUL. */
+	if (ga_grow(&out_ga, out_pos + 1) == OK)
+	{
+	    mch_memmove((char_u *)out_ga.ga_data + out_ga.ga_len, out_buf,
+							     (size_t)out_pos);
+	    out_ga.ga_len += out_pos;
+	    out_pos = 0;
+	}
+	len = out_ga.ga_len;
+	out_ga.ga_len = 0;
+	ui_write((char_u *)out_ga.ga_data, len);
+	/* Don't keep a lot of memory after drawing a big frame. */
+	if (out_ga.ga_maxlen > 100000)
+	    ga_clear(&out_ga);
+    }
     if (out_pos != 0)
     {
 	/* set out_pos to 0 before ui_write, to avoid recursiveness */
@@ -2563,6 +2682,45 @@ out_flush(void)
 	out_pos = 0;
 	ui_write(out_buf, len);
     }
+    if (sync && out_frame > 0)
+	out_frame_sync_start();
+#ifdef FEAT_PROFILE
+    if (rendertime_on)
+	rendertime_add(RT_OUT_FLUSH, NULL, rt_start);
+#endif
+}
+
+/*
+ * Start drawing a frame: until the matching out_frame_end() the output is
+ * only written when out_flush() is called, not when out_buf is full.  Thus
+ * updating the screen usually results in one write.  When 't_BS' and 't_ES'
+ * are set the frame is sent as a synchronized update.
+ * Calls can be nested.
+ */
+    void
+out_frame_start(void)
+{
+#ifdef FEAT_GUI
+    if (gui.in_use)
+	return;
+#endif
+    if (out_frame++ == 0 && termcap_active)
+	out_frame_sync_start();
+}
+
+/*
+ * End drawing a frame, see out_frame_start().  The output remains in the
+ * buffer until out_flush() is called.
+ */
+    void
+out_frame_end(void)
+{
+#ifdef FEAT_GUI
+    if (gui.in_use)
+	return;
+#endif
+    if (out_frame > 0 && --out_frame == 0)
+	out_frame_sync_end();
 }
 
 /*
@@ -2595,7 +2753,7 @@ out_flush_cursor(
 out_flush_check(void)
 {
     if (enc_dbcs != 0 && out_pos >= OUT_SIZE - MB_MAXBYTES)
-	out_flush();
+	out_buf_full();
 }
 
 #ifdef FEAT_GUI
@@ -2606,6 +2764,7 @@ out_flush_check(void)
 out_trash(void)
 {
     out_pos = 0;
+    out_ga.ga_len = 0;
 }
 #endif
 
@@ -2626,8 +2785,10 @@ out_char(unsigned c)
     out_buf[out_pos++] = c;
 
     /* For testing we flush each time. */
-    if (out_pos >= OUT_SIZE || p_wd)
+    if (p_wd)
 	out_flush();
+    else if (out_pos >= OUT_SIZE)
+	out_buf_full();
 }
 
 static void out_char_nf(unsigned);
@@ -2646,7 +2807,7 @@ out_char_nf(unsigned c)
     out_buf[out_pos++] = c;
 
     if (out_pos >= OUT_SIZE)
-	out_flush();
+	out_buf_full();
 }
 
 #if defined(FEAT_TITLE) || defined(FEAT_MOUSE_TTY) || defined(FEAT_GUI) \
@@ -2664,7 +2825,7 @@ out_char_nf(unsigned c)
 out_str_nf(char_u *s)
 {
     if (out_pos > OUT_SIZE - 20)  /* avoid terminal strings being split up */
-	out_flush();
+	out_buf_full();
     while (*s)
 	out_char_nf(*s++);
 
@@ -2698,7 +2859,7 @@ out_str_cf(char_u *s)
 	}
 #endif
 	if (out_pos > OUT_SIZE - 20)
-	    out_flush();
+	    out_buf_full();
 #ifdef HAVE_TGETENT
 	for (p = s; *s; ++s)
 	{
@@ -2766,7 +2927,7 @@ out_str(char_u *s)
 #endif
 	/* avoid terminal strings being split up */
 	if (out_pos > OUT_SIZE - 20)
-	    out_flush();
+	    out_buf_full();
 #ifdef HAVE_TGETENT
 	tputs((char *)s, 1, TPUTSFUNCAST out_char_nf);
 #else
@@ -2795,6 +2956,24 @@ term_cursor_right(int i)
     OUT_STR(tgoto((char *)T_CRI, 0, i));
 }
 
+/*
+ * Return the number of bytes term_windgoto() outputs.
+ */
+    int
+term_windgoto_len(int row, int col)
+{
+    return (int)STRLEN(tgoto((char *)T_CM, col, row));
+}
+
+/*
+ * Return the number of bytes term_cursor_right() outputs.
+ */
+    int
+term_cursor_right_len(int i)
+{
+    return (int)STRLEN(tgoto((char *)T_CRI, 0, i));
+}
+
     void
 term_append_lines(int line_count)
 {
@@ -105,10 +105,12 @@ enum SpecialKey
     KS_CST,	/* save window title */
     KS_CRT,	/* restore window title */
     KS_SSI,	/* save icon text */
-    KS_SRI	/* restore icon text */
+    KS_SRI,	/* restore icon text */
+    KS_CBS,	/* begin synchronized update */
+    KS_CES	/* end synchronized update */
 };
 
-#define KS_LAST	    KS_SRI
+#define KS_LAST	    KS_CES
 
 /*
  * the terminal capabilities are stored in this array
@@ -204,6 +206,8 @@ extern char_u *(term_strings[]);    /* current terminal strings */
 #define T_CRT	(TERM_STR(KS_CRT))	/* restore window title */
 #define T_SSI	(TERM_STR(KS_SSI))	/* save icon text */
 #define T_SRI	(TERM_STR(KS_SRI))	/* restore icon text */
+#define T_BS	(TERM_STR(KS_CBS))	/* begin synchronized update */
+#define T_ES	(TERM_STR(KS_CES))	/* end synchronized update */
 
 #define TMODE_COOK  0	/* terminal mode for external cmds and Ex mode */
 #define TMODE_SLEEP 1	/* terminal mode for sleeping (cooked but no echo) */
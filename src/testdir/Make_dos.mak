@@ -101,13 +101,23 @@ nolog:
 	-if exist messages del messages
 
 benchmark:
-	bench_re_freeze.out
+	bench_re_freeze.out bench_readfile.out bench_redraw.out
 
 bench_re_freeze.out: bench_re_freeze.vim
 	-if exist benchmark.out del benchmark.out
 	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
 	@IF EXIST benchmark.out ( type benchmark.out )
 
+bench_readfile.out: bench_readfile.vim
+	-if exist benchmark.out del benchmark.out
+	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
+	@IF EXIST benchmark.out ( type benchmark.out )
+
+bench_redraw.out: bench_redraw.vim
+	-if exist benchmark.out del benchmark.out
+	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
+	@IF EXIST benchmark.out ( type benchmark.out )
+
 # New style of tests uses Vim script with assert calls.  These are easier
 # to write and a lot easier to read and debug.
 # Limitation: Only works with the +eval feature.
@@ -35,7 +35,7 @@ include Make_all.mak
 
 SCRIPTS = $(SCRIPTS_ALL) $(SCRIPTS_MORE1) $(SCRIPTS_MORE4) $(SCRIPTS_WIN32)
 
-SCRIPTS_BENCH = bench_re_freeze.out
+SCRIPTS_BENCH = bench_re_freeze.out bench_readfile.out bench_redraw.out
 
 # Must run test1 first to create small.vim.
 $(SCRIPTS) $(SCRIPTS_GUI) $(SCRIPTS_WIN32) $(NEW_TESTS_RES): $(SCRIPTS_FIRST)
@@ -115,6 +115,16 @@ bench_re_freeze.out: bench_re_freeze.vim
 	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
 	$(CAT) benchmark.out
 
+bench_readfile.out: bench_readfile.vim
+	-$(DEL) benchmark.out
+	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
+	$(CAT) benchmark.out
+
+bench_redraw.out: bench_redraw.vim
+	-$(DEL) benchmark.out
+	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
+	$(CAT) benchmark.out
+
 # New style of tests uses Vim script with assert calls.  These are easier
 # to write and a lot easier to read and debug.
 # Limitation: Only works with the +eval feature.
@@ -0,0 +1,29 @@
+" Benchmark for reading files, reports the throughput in Mbyte per second
+
+so small.vim
+if !has("reltime") || !has("float") | finish | endif
+
+" Read a file with many lines of "text" in 'fileformat' "ff" three times.
+func! MeasureRead(name, text, ff)
+  let save_enc = &encoding
+  let save_fencs = &fileencodings
+  set encoding=utf-8 fileencodings=utf-8,latin1
+
+  let fname = 'Xbench_readfile'
+  let eol = a:ff == 'dos' ? "\r" : ''
+  call writefile(map(range(500000), 'v:val . a:text . eol'), fname)
+  let size = getfsize(fname)
+  for i in range(3)
+    let start = reltime()
+    exe 'noswapfile split ' . fname
+    let time = reltimefloat(reltime(start))
+    let ff = &fileformat
+    bwipe!
+    $put =printf('file: %s %s, size: %d, time: %.3f, MB/s: %.1f',
+	  \ a:name, ff, size, time, size / time / 1000000.0)
+  endfor
+
+  call delete(fname)
+  let &encoding = save_enc
+  let &fileencodings = save_fencs
+endfunc
@@ -0,0 +1,59 @@
+" Benchmark for redrawing the screen, reports the number of screen cells
+" updated per second
+
+so small.vim
+if !has("reltime") || !has("float") || !has("vertsplit") | finish | endif
+
+" Redraw a 400 column screen with four windows side by side, first with all
+" text unchanged, then while scrolling in one direction and back and forth.
+func! MeasureRedraw(name, text)
+  let save_enc = &encoding
+  let save_lines = &lines
+  let save_columns = &columns
+  set encoding=utf-8
+  set lines=100 columns=400
+
+  let results = []
+  tabnew
+  call setline(1, map(range(5000), 'v:val . repeat(a:text, 5)'))
+  vsplit
+  vsplit
+  vsplit
+  let cells = &lines * &columns
+  redraw
+
+  let start = reltime()
+  for i in range(100)
+    " Setting 'listchars' makes all windows to be redrawn.
+    let &listchars = &listchars
+    redraw
+  endfor
+  let time = reltimefloat(reltime(start))
+  call add(results, printf('text: %s, unchanged, time: %.3f, cells/s: %.0f',
+	\ a:name, time, cells * 100 / time))
+
+  let start = reltime()
+  for i in range(100)
+    windo exe "normal! \<C-E>"
+    redraw
+  endfor
+  let time = reltimefloat(reltime(start))
+  call add(results, printf('text: %s, scrolling, time: %.3f, cells/s: %.0f',
+	\ a:name, time, cells * 100 / time))
+
+  " Scroll back and forth, the lines coming back into view are unchanged.
+  let start = reltime()
+  for i in range(100)
+    windo exe "normal! " . (i % 20 < 10 ? "\<C-E>" : "\<C-Y>")
+    redraw
+  endfor
+  let time = reltimefloat(reltime(start))
+  call add(results, printf('text: %s, back and forth, time: %.3f, cells/s: %.0f',
+	\ a:name, time, cells * 100 / time))
+
+  bwipe!
+  let &columns = save_columns
+  let &lines = save_lines
+  let &encoding = save_enc
+  call append('$', results)
+endfunc
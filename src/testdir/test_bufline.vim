@@ -139,3 +139,36 @@ func Test_deletebufline()
   call assert_equal(['b', 'c'], getbufline(b, 1, 2))
   exe "bwipe! " . b
 endfunc
+
+func Test_read_filter_delete_many_lines()
+  let lines = map(range(1, 10000), 'v:val . repeat("x", v:val % 37)')
+  call writefile(lines, 'Xmanylines')
+  new
+  read Xmanylines
+  1delete
+  call assert_equal(lines, getline(1, '$'))
+  call assert_equal(1 + len(join(lines[:4999], "\n")) + 1, line2byte(5001))
+
+  if executable('cat')
+    1,5000!cat
+    call assert_equal(lines, getline(1, '$'))
+    call assert_equal(1 + len(join(lines, "\n")) + 1, line2byte(10001))
+  endif
+
+  " start a new undo block
+  let &undolevels = &undolevels
+  100,8000delete
+  call assert_equal(lines[:98] + lines[8000:], getline(1, '$'))
+  call assert_equal(1 + len(join(lines[:98], "\n")) + 1, line2byte(100))
+  call assert_equal(1 + len(join(lines[:98] + lines[8000:], "\n")) + 1,
+	\ line2byte(line('$') + 1))
+  undo
+  call assert_equal(lines, getline(1, '$'))
+
+  %delete
+  call assert_equal([''], getline(1, '$'))
+  call assert_equal(1, line2byte(1))
+
+  bwipe!
+  call delete('Xmanylines')
+endfunc
@@ -139,3 +139,44 @@ function Test_get_win_options()
     set foldlevel=0
   endif
 endfunc
+
+func Test_getbufinfo_memfile()
+  new
+  call setline(1, range(1, 10000))
+  let info = getbufinfo('%')[0].memfile
+  call assert_true(info.pages > 0)
+  call assert_true(info.maxpages > 0)
+  let hits = info.hits
+  call getline(1, '$')
+  call assert_true(getbufinfo('%')[0].memfile.hits > hits)
+  bwipe!
+
+  badd Xnotloaded
+  call assert_false(has_key(getbufinfo('Xnotloaded')[0], 'memfile'))
+  bwipe Xnotloaded
+endfunc
+
+func Test_getbufinfo_memfile_compressed()
+  let save_mm = &maxmem
+  set maxmem=100
+  noswapfile new
+  call setline(1, map(range(1, 20000), '"line " . v:val'))
+  let info = getbufinfo('%')[0].memfile
+  call assert_true(info.compressed_pages > 0)
+  call assert_true(info.compressed_bytes < info.compressed_pages * 4096)
+
+  " the text is still there after decompressing
+  call assert_equal('line 1', getline(1))
+  call assert_equal('line 12345', getline(12345))
+  1,10000d
+  call assert_equal(['line 10001', 'line 20000'], [getline(1), getline('$')])
+  call assert_true(getbufinfo('%')[0].memfile.decompressions > 0)
+
+  " all blocks are decompressed when creating a swap file
+  setlocal swapfile
+  call assert_equal(0, getbufinfo('%')[0].memfile.compressed_pages)
+  call assert_equal('line 15000', getline(5000))
+
+  bwipe!
+  let &maxmem = save_mm
+endfunc
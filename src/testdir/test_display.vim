@@ -4,6 +4,7 @@ if !has('gui_running') && has('unix')
 endif
 
 source view_util.vim
+source screendump.vim
 
 func Test_display_foldcolumn()
   if !has("folding")
@@ -67,3 +68,185 @@ func Test_display_foldtext_mbyte()
   set foldtext& fillchars& foldmethod& fdc&
   bw!
 endfunc
+
+" Unchanged text is skipped when updating the screen, check that changed
+" double-width characters after it are still drawn properly.
+func Test_display_unchanged_wide_chars()
+  if !CanRunVimInTerminal()
+    return
+  endif
+  call writefile([
+	\ 'set encoding=utf-8',
+	\ 'call setline(1, repeat("x", 30) . repeat("\u65e5", 5) . "end")',
+	\ ], 'XTest_wide_chars')
+  let buf = RunVimInTerminal('-S XTest_wide_chars', {'rows': 6})
+  call WaitForAssert({-> assert_equal(repeat('x', 30) . repeat("\u65e5", 5)
+	\ . 'end', term_getline(buf, 1))})
+
+  " Shift the double-width characters by one cell.
+  call term_sendkeys(buf, ":call setline(1, repeat('x', 31) . repeat(\"\\u65e5\", 4) . 'ab')\<CR>")
+  call WaitForAssert({-> assert_equal(repeat('x', 31) . repeat("\u65e5", 4)
+	\ . 'ab', term_getline(buf, 1))})
+
+  " Replace a double-width character in the middle with single-width ones.
+  call term_sendkeys(buf, ":call setline(1, repeat('x', 31) . \"\\u65e5\\u65e5yz\\u65e5ab\")\<CR>")
+  call WaitForAssert({-> assert_equal(repeat('x', 31) . "\u65e5\u65e5yz\u65e5ab",
+	\ term_getline(buf, 1))})
+
+  call StopVimInTerminal(buf)
+  call delete('XTest_wide_chars')
+endfunc
+
+" With 't_BS' and 't_ES' set a screen update is sent as a synchronized update.
+func Test_display_synchronized_update()
+  if !has('unix')
+    return
+  endif
+  let after = [
+	\ "let &t_BS = '<bs>'",
+	\ "let &t_ES = '<es>'",
+	\ 'call setline(1, range(1, 100))',
+	\ 'redraw',
+	\ 'normal! 50Gzt',
+	\ 'redraw',
+	\ 'redraw',
+	\ 'qa!',
+	\ ]
+  if !RunVim([], after, '> Xsync_out')
+    return
+  endif
+  let out = join(readfile('Xsync_out', 'b'), "\n")
+  " A redraw without changes doesn't output anything.
+  call assert_equal(['<bs>', '<es>', '<bs>', '<es>'],
+	\ split(substitute(out, '.\{-}\(<bs>\|<es>\|$\)', '\1 ', 'g')))
+  call assert_match('<bs>.*50.*<es>', out)
+  call delete('Xsync_out')
+endfunc
+
+func s:WindowCells()
+  let cells = []
+  for row in range(1, winheight(0))
+    call add(cells, map(range(1, winwidth(0)),
+	  \ {i, col -> [screenchar(row, col), screenattr(row, col)]}))
+  endfor
+  return cells
+endfunc
+
+" Run the commands for Test_display_line_cache() and return the window cells
+" after each of them.  With "clear" set the screen is cleared before getting
+" the cells, thus every line is drawn again.
+func s:LineCacheCells(clear)
+  call cursor(20, 8)
+  normal! zt
+  redraw!
+  let result = []
+  for cmd in ["5\<C-E>", "5\<C-Y>", "3\<C-Y>", 'j', "\<C-D>", "\<C-U>",
+	\ 'sign', '5l', 'zl', 'zh', "\<C-E>", "4\<C-Y>", 'nohls', 'G', 'gg']
+    if cmd == 'sign'
+      if !has('signs')
+	continue
+      endif
+      " Place a sign in a line that was displayed before and scroll to it.
+      exe 'sign place 2 line=30 name=LineCache buffer=' . bufnr('')
+      exe "normal! 5\<C-E>"
+    elseif cmd == 'nohls'
+      nohlsearch
+    else
+      exe 'normal! ' . cmd
+    endif
+    if a:clear
+      redraw!
+    else
+      redraw
+    endif
+    call add(result, [cmd, s:WindowCells()])
+  endfor
+  if has('signs')
+    sign unplace 2
+  endif
+  set hlsearch
+  return result
+endfunc
+
+" Lines put back from the line cache, e.g. after scrolling, must look the same
+" as when they are drawn again.
+func Test_display_line_cache()
+  new
+  vsplit
+  call setline(1, map(range(1, 300), {i, v -> 'line ' . v . ' ' . repeat('ab ', v % 13)}))
+  call matchadd('ErrorMsg', 'line 1\d ')
+  setlocal number nowrap
+  set hlsearch
+  let @/ = 'ab ab'
+  if has('signs')
+    sign define LineCache text=>> texthl=Search
+    exe 'sign place 1 line=290 name=LineCache buffer=' . bufnr('')
+  endif
+
+  call assert_equal(s:LineCacheCells(1), s:LineCacheCells(0))
+  setlocal relativenumber
+  call assert_equal(s:LineCacheCells(1), s:LineCacheCells(0))
+
+  if has('signs')
+    sign unplace 1
+    sign undefine LineCache
+  endif
+  call clearmatches()
+  set hlsearch&
+  bwipe!
+endfunc
+
+func Test_rendertime()
+  if !has('profile')
+    return
+  endif
+  let parts = ['fold_line', 'get_syntax_attr', 'next_search_hl',
+	\ 'out_flush', 'update_screen', 'win_line', 'win_update']
+
+  rendertime clear
+  call assert_equal(parts, sort(keys(rendertime_info())))
+  call assert_equal(0, rendertime_info().win_line.count)
+
+  new
+  call setline(1, range(1, 20))
+  syn match Number /\d\+/
+  call matchadd('Search', '1')
+  3,4fold
+  let winid = win_getid()
+  rendertime on
+  redraw!
+  rendertime off
+  let all = rendertime_info()
+  let win = rendertime_info(winid)
+  call assert_equal(parts, sort(keys(win)))
+  call assert_equal(1, all.update_screen.count)
+  call assert_inrange(1, all.update_screen.total, all.update_screen.total)
+  for part in ['win_update', 'win_line', 'get_syntax_attr', 'next_search_hl',
+	\ 'fold_line']
+    call assert_inrange(1, all[part].count, win[part].count, part)
+  endfor
+  call assert_equal(0, win.update_screen.count)
+  call assert_equal(0, win.out_flush.count)
+  call assert_equal(1, win.fold_line.count)
+  call assert_inrange(win.win_line.total, all.win_update.total,
+	\ all.win_line.total)
+  call assert_equal({}, rendertime_info(9999))
+
+  " nothing is counted when switched off
+  redraw!
+  call assert_equal(all, rendertime_info())
+
+  let a = execute('rendertime report')
+  call assert_match('^  TOTAL *COUNT *AVERAGE *PART\n', a)
+  call assert_match('\n *\d\+\.\d\+ \+1 .* update_screen\n', a)
+
+  rendertime clear
+  call assert_equal(0, rendertime_info().win_line.count)
+  call assert_equal(0, rendertime_info(winid).win_line.count)
+  call assert_fails('rendertime abc', 'E475')
+  call assert_equal(['clear', 'off', 'on', 'report'],
+	\ sort(getcompletion('', 'rendertime')))
+
+  call clearmatches()
+  bwipe!
+endfunc
@@ -144,3 +144,84 @@ func Test_file_changed_dialog()
   bwipe!
   call delete('Xchanged_d')
 endfunc
+
+" A file replaced by renaming another file over it must be noticed, also when
+" only one of several buffers changed.
+func Test_FileChangedShell_rename()
+  if !has('unix')
+    return
+  endif
+  call writefile(['one'], 'Xchanged_one')
+  call writefile(['two'], 'Xchanged_two')
+  au FileChangedShell * call add(g:changed, expand('<afile>')) | let v:fcs_choice = 'reload'
+  let g:changed = []
+  edit Xchanged_one
+  split Xchanged_two
+  checktime
+  call assert_equal([], g:changed)
+
+  sleep 2
+  call writefile(['new two'], 'Xchanged_new')
+  call rename('Xchanged_new', 'Xchanged_two')
+  checktime
+  call assert_equal(['Xchanged_two'], g:changed)
+  call assert_equal('new two', getline(1))
+
+  let g:changed = []
+  checktime
+  call assert_equal([], g:changed)
+
+  au! FileChangedShell
+  unlet g:changed
+  bwipe!
+  bwipe!
+  call delete('Xchanged_one')
+  call delete('Xchanged_two')
+endfunc
+
+" A file in a directory that was renamed must be noticed, also when it is not
+" the directory of the file.
+func Test_FileChangedShell_rename_dir()
+  if !has('unix')
+    return
+  endif
+  call mkdir('Xchangeddir/sub/deeper', 'p')
+  call writefile(['one'], 'Xchangeddir/sub/file')
+  call writefile(['one'], 'Xchangeddir/sub/deeper/file')
+  au FileChangedShell * call add(g:changed, expand('<afile>:t')) | let v:fcs_choice = 'reload'
+  let g:changed = []
+  edit Xchangeddir/sub/deeper/file
+  split Xchangeddir/sub/file
+  checktime
+  call assert_equal([], g:changed)
+
+  " Rename a directory two levels up and put another file in its place.
+  call rename('Xchangeddir', 'Xchangeddir_old')
+  call mkdir('Xchangeddir/sub/deeper', 'p')
+  call writefile(['new one'], 'Xchangeddir/sub/file')
+  call writefile(['new one'], 'Xchangeddir/sub/deeper/file')
+  checktime
+  call assert_equal(['file', 'file'], g:changed)
+  call assert_equal('new one', getline(1))
+  wincmd w
+  call assert_equal('new one', getline(1))
+
+  " The new directories are watched.
+  let g:changed = []
+  checktime
+  call assert_equal([], g:changed)
+  call delete('Xchangeddir/sub/deeper/file')
+  call rename('Xchangeddir/sub/deeper', 'Xchangeddir/sub/other')
+  call mkdir('Xchangeddir/sub/deeper')
+  call writefile(['other one'], 'Xchangeddir/sub/deeper/file')
+  checktime
+  call assert_equal(['file'], g:changed)
+  call assert_equal('other one', getline(1))
+
+  au! FileChangedShell
+  unlet g:changed
+  bwipe!
+  bwipe!
+  call delete('Xchangeddir', 'rf')
+  call delete('Xchangeddir_old', 'rf')
+endfunc
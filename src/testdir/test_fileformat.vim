@@ -31,3 +31,39 @@ func Test_fileformat_autocommand()
   au! BufReadPre Xfile
   bw!
 endfunc
+
+" Test reading a file that is large enough to be read in several parts.
+func Test_fileformat_large_file()
+  let line = repeat('x', 99) . 'é'
+  let lines = repeat([line . "\r"], 20000)
+  let lines[-1] = 'last'
+  call writefile(lines, 'Xfile', 'b')
+  set ffs=unix,dos
+  new Xfile
+  call assert_equal('dos', &ff)
+  call assert_equal('utf-8', &fenc)
+  call assert_equal(0, &eol)
+  call assert_equal(20000, line('$'))
+  call assert_equal(line, getline(1))
+  call assert_equal(line, getline(19999))
+  call assert_equal('last', getline('$'))
+  bwipe!
+
+  " A line without a CR at the end of the file switches to unix.
+  call writefile(lines + [''], 'Xfile', 'b')
+  new Xfile
+  call assert_equal('unix', &ff)
+  call assert_equal(line . "\r", getline(1))
+  call assert_equal('last', getline('$'))
+  bwipe!
+
+  " An incomplete character at the end of the file is replaced.
+  call writefile(lines + ["\xc3"], 'Xfile', 'b')
+  new Xfile
+  call assert_equal(20001, line('$'))
+  call assert_equal("?", getline("$"))
+  bwipe!
+
+  call delete('Xfile')
+  set ffs&
+endfunc
@@ -2458,6 +2458,127 @@ func Test_vimgrep_incsearch()
   set noincsearch
 endfunc
 
+" Test for 'vimgrepjobs': files without the literal text of the pattern are
+" skipped, the result must be the same.
+func Test_vimgrep_jobs()
+  call writefile(['one', 'two needle', 'three'], 'Xvgj1')
+  call writefile(['nothing here'], 'Xvgj2')
+  call writefile(['NEEDLE', 'x needle'], 'Xvgj3')
+  " UTF-16 with a BOM, converted when read
+  call writefile(0zFFFE6E006500650064006C0065000A00, 'Xvgj4')
+  " Text changed by an autocommand
+  call writefile(['empty'], 'Xvgj5')
+  autocmd BufReadPost Xvgj5 call setline(1, 'needle')
+
+  let save_fencs = &fileencodings
+  set fileencodings=ucs-bom,utf-8,latin1
+  call assert_fails('set vimgrepjobs=-1', 'E487:')
+  let results = []
+  for jobs in [0, 2]
+    let &vimgrepjobs = jobs
+    let r = []
+    for pat in ['needle', '\cneedle', 'ee[d]le', 'x', 'n.*e']
+      exe 'vimgrep /' . pat . '/j Xvgj*'
+      call add(r, map(getqflist(), {i, v -> bufname(v.bufnr) . ':' . v.lnum}))
+    endfor
+    1vimgrep /needle/j Xvgj*
+    call add(r, map(getqflist(), {i, v -> bufname(v.bufnr) . ':' . v.lnum}))
+    call add(results, r)
+  endfor
+  call assert_equal(['Xvgj1:2', 'Xvgj3:2', 'Xvgj4:1', 'Xvgj5:1'], results[0][0])
+  call assert_equal(results[0], results[1])
+
+  " Files without the text are not loaded.
+  set vimgrepjobs=2
+  call assert_match('Skipped 1 of 5 files without loading',
+	\ execute('verbose vimgrep /needle/j Xvgj*'))
+  call assert_match('Skipped 2 of 5 files without loading',
+	\ execute('verbose vimgrep /three/j Xvgj*'))
+  call assert_notmatch('Skipped', execute('vimgrep /three/j Xvgj*'))
+
+  set vimgrepjobs&
+  let &fileencodings = save_fencs
+  au! BufReadPost Xvgj5
+  for i in range(1, 5)
+    call delete('Xvgj' . i)
+  endfor
+  %bwipe!
+endfunc
+
+" Files that are not loaded may be searched without a buffer, the result must
+" be the same as when searching the loaded buffers.
+func Test_vimgrep_unloaded()
+  call writefile(['foo bar', 'baz foo foo', '', 'end'], 'Xvgr1')
+  call writefile([], 'Xvgr2')
+  call writefile(['foo', ''], 'Xvgr3')
+  call writefile(0z666F6F0D0A6261720D0A, 'Xvgr4')
+  call writefile(0z636166E920666F6F0A, 'Xvgr5')
+  call writefile(0zEFBBBF666F6F0A, 'Xvgr6')
+  call writefile(0z61006261720A666F6F0A, 'Xvgr7')
+
+  let save_fencs = &fileencodings
+  set fileencodings=ucs-bom,utf-8,latin1
+  let pats = ['foo', 'foo$', '^$', '\<foo\>', 'caf.', 'o\_s', '\nbar',
+	\ '\%^foo', '\v%2lbar', 'a\@<=r', '\cFOO']
+  let results = []
+  for loaded in [0, 1]
+    if loaded
+      set hidden
+      for f in glob('Xvgr*', 0, 1)
+	exe 'edit ' . f
+      endfor
+      enew
+    endif
+    let r = []
+    for pat in pats
+      for flags in ['j', 'jg']
+	exe 'vimgrep /' . pat . '/' . flags . ' Xvgr*'
+	call add(r, map(getqflist(),
+	      \ {i, v -> [bufname(v.bufnr), v.lnum, v.col, v.text]}))
+      endfor
+    endfor
+    call add(results, r)
+  endfor
+  call assert_equal([['Xvgr1', 1, 1, 'foo bar'], ['Xvgr1', 2, 5, 'baz foo foo'],
+	\ ['Xvgr3', 1, 1, 'foo'], ['Xvgr4', 1, 1, 'foo'],
+	\ ['Xvgr5', 1, 7, "caf\u00e9 foo"], ['Xvgr6', 1, 1, 'foo'],
+	\ ['Xvgr7', 2, 1, 'foo']], results[0][0])
+  call assert_equal(results[1], results[0])
+
+  set hidden&
+  let &fileencodings = save_fencs
+  for i in range(1, 7)
+    call delete('Xvgr' . i)
+  endfor
+  %bwipe!
+endfunc
+
+" "\%v" uses 'tabstop' of the current buffer, also when the file is loaded.
+func Test_vimgrep_virtcol()
+  call writefile(["\tx", "\t\tx"], 'Xvgrts')
+  let results = []
+  for loaded in [0, 1]
+    if loaded
+      set hidden
+      edit Xvgrts
+      enew
+    endif
+    setlocal tabstop=4
+    let r = []
+    for pat in ['\%5vx', '\%<6vx', '\%>6vx']
+      exe 'vimgrep /' . pat . '/j Xvgrts'
+      call add(r, map(getqflist(), {i, v -> [v.lnum, v.col]}))
+    endfor
+    call add(results, r)
+  endfor
+  call assert_equal([[[1, 2]], [[1, 2]], [[2, 3]]], results[0])
+  call assert_equal(results[0], results[1])
+
+  set hidden&
+  call delete('Xvgrts')
+  %bwipe!
+endfunc
+
 func XfreeTests(cchar)
   call s:setup_commands(a:cchar)
 
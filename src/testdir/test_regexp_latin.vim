@@ -93,7 +93,9 @@ endfunc
 
 func Test_out_of_memory()
   new
-  s/^/,n
+  " The line must contain a match, otherwise the DFA finds out quickly there
+  " is none and the NFA isn't used.
+  s/^/,n;
   " This will be slow...
   call assert_fails('call search("\\v((n||<)+);")', 'E363:')
 endfunc
@@ -141,3 +143,56 @@ func Test_pattern_compile_speed()
   call assert_inrange(0.01, 10.0, reltimefloat(reltime(start)))
   set spc=
 endfunc
+
+func Test_regexp_cache()
+  let hits = regexpcacheinfo().hits
+  for i in range(5)
+    call assert_equal(1, match('xabcx', 'ab\d*c'))
+  endfor
+  call assert_inrange(hits + 4, hits + 100, regexpcacheinfo().hits)
+
+  " A program that is being executed is not used for the inner call.
+  call assert_equal('bbb', substitute('aaa', 'a',
+	\ '\=substitute(submatch(0), "a", "b", "")', 'g'))
+
+  " [:keyword:] depends on 'iskeyword' with the backtracking engine.
+  set re=1
+  setlocal isk=@
+  call assert_equal(-1, match('-', '[[:keyword:]]'))
+  setlocal isk+=-
+  call assert_equal(0, match('-', '[[:keyword:]]'))
+  setlocal isk&
+
+  " And [:print:] depends on 'isprint'.
+  call assert_equal(-1, match("x\x01", '[[:print:]]\{2}'))
+  set isprint=1-255
+  call assert_equal(0, match("x\x01", '[[:print:]]\{2}'))
+  set isprint&
+  set re=0
+
+  " "~" is the last substitute string.
+  new
+  call setline(1, 'one')
+  s/one/two/
+  call assert_equal(0, match('two', '^~$'))
+  s/two/three/
+  call assert_equal(0, match('three', '^~$'))
+  bwipe!
+endfunc
+
+func Test_nested_multi_backtracking()
+  " Used to loop forever or give E363.
+  call assert_equal(2, match('acb', '\%#=1\(a*\)*b'))
+  call assert_equal(['b', ''], matchlist('cb', '\%#=1\(a*\)*b')[:1])
+
+  " This used to take exponential time.
+  let start = reltime()
+  call assert_equal(201, match(repeat('a', 200) . 'cb', '\%#=1\(a*\)*b'))
+  call assert_equal(-1,
+	\ match(repeat('ab', 100) . 'c', '\%#=1^\(a\|ab\|b\)*$'))
+  call assert_inrange(0.0, 5.0, reltimefloat(reltime(start)))
+
+  " Back references still work.
+  call assert_equal(['aabaab', 'aa'],
+	\ matchlist('xaabaabz', '\%#=1\(a*\)b\1b')[:1])
+endfunc
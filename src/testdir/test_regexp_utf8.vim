@@ -206,3 +206,89 @@ func Test_large_class()
   call assert_equal(1, "\u3042" =~# '[\u3000-\u4000]')
   set re=0
 endfunc
+
+" The NFA engine uses a DFA to check for a match first, the result must be the
+" same as with the backtracking engine.
+func Test_dfa_same_as_backtracking()
+  let lines = ['foo bar', 'xfoo', 'foo_bar', 'Foo-Bar', 'αβγ foo', 'fooλ',
+	\ 'λfoo', "e\u0301foo", '', '   ', 'bar foo bar foobar']
+  let pats = ['foo', '\<foo\>', '\<foo', 'foo\>', '^foo', 'bar$', '^$',
+	\ '\cfoo', 'f\(o\+\)', '[fb]a\=r', '[^a-z ]', '\k\+', '\s*$',
+	\ 'o\zsb\?a', '\vfoo|bar', '\<λ', '\a\>', '\%(foo\|bar\)\+',
+	\ '[[:digit:]x]', '\u\l', 'foo\ze ']
+  for ic in [0, 1]
+    let &ignorecase = ic
+    for line in lines
+      for pat in pats
+	for start in [0, 2]
+	  call assert_equal(matchstrpos(line, '\%#=1' . pat, start),
+		\ matchstrpos(line, '\%#=2' . pat, start),
+		\ pat . ' on "' . line . '" from ' . start . ' ic ' . ic)
+	endfor
+      endfor
+    endfor
+  endfor
+  set ignorecase&
+endfunc
+
+" Both engines look for a literal string that a match must contain before
+" trying to match.  Check cases where that literal must not be used or where
+" it must be found carefully.
+func Test_required_literal()
+  let tests = [
+	\ ['foobar', 'OBA', 1, ['oba', 2, 5]],
+	\ ['FOOBAR', 'oba', 1, ['OBA', 2, 5]],
+	\ ['FOOBAR', '\coba', 0, ['OBA', 2, 5]],
+	\ ['FOOBAR', '\Coba', 1, ['', -1, -1]],
+	\ ['xxÉTÉyy', 'été', 1, ['ÉTÉ', 2, 7]],
+	\ ['xxÉTÉyy', '\cété', 0, ['ÉTÉ', 2, 7]],
+	\ ['xxαβγyy', 'αβγ', 0, ['αβγ', 2, 8]],
+	\ ['xxαβγyy', 'β\+γy', 0, ['βγy', 4, 9]],
+	\ ['xxΑΒΓyy', 'αβγ', 1, ['ΑΒΓ', 2, 8]],
+	\ ['xxαβδyy', 'αβγ', 0, ['', -1, -1]],
+	\ ['xfoobar', 'foo\zsbar', 0, ['bar', 4, 7]],
+	\ ['xfoobar', 'fo\zso\+bar', 0, ['obar', 3, 7]],
+	\ ['foobar', '\(foo\)\@<=bar', 0, ['bar', 3, 6]],
+	\ ['xbar', '\(foo\)\@<=bar', 0, ['', -1, -1]],
+	\ ['foobar xbar', '\(foo\)\@<!bar', 0, ['bar', 8, 11]],
+	\ ['foobar', '\(foo\)\@=foob', 0, ['foob', 0, 4]],
+	\ ['bar', 'foo\|bar', 0, ['bar', 0, 3]],
+	\ ['abdef', 'ab\(c\|d\)ef', 0, ['abdef', 0, 5]],
+	\ ['xy', 'x\(abc\)\=y', 0, ['xy', 0, 2]],
+	\ ['xy', 'x\%[abc]y', 0, ['xy', 0, 2]],
+	\ ['xabcabcy', 'x\(abc\)*y', 0, ['xabcabcy', 0, 8]],
+	\ ['xbcd', '\(a\|x\)bcd', 0, ['xbcd', 0, 4]],
+	\ ['abc', 'a\nbc', 0, ['', -1, -1]],
+	\ [repeat('a', 13) . 'xyz', 'xyz', 0, ['xyz', 13, 16]],
+	\ [repeat('a', 15) . 'x', 'xy', 0, ['', -1, -1]],
+	\ [repeat('a', 15) . 'xy', 'xy', 0, ['xy', 15, 17]],
+	\ [repeat('a', 29) . 'xyz', 'xyz', 0, ['xyz', 29, 32]],
+	\ [repeat('a', 30) . 'xz', 'xyz', 0, ['', -1, -1]],
+	\ [repeat('a', 31) . 'Z', 'z', 1, ['Z', 31, 32]],
+	\ [repeat('a', 62) . 'xyz', '.xyz', 0, ['axyz', 61, 65]],
+	\ [repeat('a', 190) . 'xyz', '.xyz', 0, ['axyz', 189, 193]],
+	\ [repeat('a', 191) . 'xy', '.xyz', 0, ['', -1, -1]],
+	\ ]
+  for [line, pat, ic, expected] in tests
+    let &ignorecase = ic
+    for re in [1, 2]
+      call assert_equal(expected, matchstrpos(line, '\%#=' . re . pat),
+	    \ pat . ' on "' . line . '" re ' . re . ' ic ' . ic)
+    endfor
+  endfor
+  set ignorecase&
+
+  " Starting halfway the line, the literal before the start doesn't count.
+  for re in [1, 2]
+    call assert_equal(['foo', 9, 12],
+	  \ matchstrpos('foo bar  foo', '\%#=' . re . 'foo', 3))
+    call assert_equal(['', -1, -1],
+	  \ matchstrpos(repeat('a', 14) . 'foo', '\%#=' . re . 'foo', 15))
+  endfor
+
+  " Every match in a long line.
+  for re in [1, 2]
+    call assert_equal(repeat('xb', 1000),
+	  \ substitute(repeat('xa', 1000), '\%#=' . re . 'x\zsa', 'b', 'g'))
+  endfor
+endfunc
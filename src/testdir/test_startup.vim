@@ -449,6 +449,24 @@ func Test_startuptime()
   call delete('Xtestout')
 endfunc
 
+func Test_rendertime_arg()
+  if !has('profile')
+    return
+  endif
+  let after = ['redraw!', 'redraw!', 'qall']
+  if RunVim([], after, '--rendertime Xtestout')
+    let lines = readfile('Xtestout')
+    call assert_match('^ frame *clock *update_screen *win_update *win_line',
+	  \ lines[-3])
+    " a line for each update, with a count and time for each part
+    call assert_match('^ *1 *\d\+\.\d\+\( \+\d\+ \+\d\+\.\d\+\)\{7}$',
+	  \ lines[-2])
+    call assert_match('^ *2 .*$', lines[-1])
+    call assert_equal('1', split(lines[-1])[2])
+  endif
+  call delete('Xtestout')
+endfunc
+
 func Test_read_stdin()
   let after = [
 	\ 'write Xtestout',
@@ -1,5 +1,7 @@
 " Tests for the swap feature
 
+source shared.vim
+
 func s:swapname()
   return trim(execute('swapname'))
 endfunc
@@ -164,3 +166,22 @@ func Test_swapname()
   call delete('Xtest2')
   call delete('Xtest3')
 endfunc
+
+" Flushing the swap file in the background while waiting for a key, then
+" writing with 'fsync' and quitting.
+func Test_swap_fsync_idle()
+  if !has('timers')
+    return
+  endif
+  let after = [
+	\ 'set fsync swapsync=fsync updatetime=1',
+	\ 'call setline(1, range(1, 10000))',
+	\ 'call timer_start(300, {-> execute("wq")})',
+	\ ]
+  if RunVim([], after, 'Xswapfsync')
+    call assert_equal(range(1, 10000),
+	  \ map(readfile('Xswapfsync'), 'str2nr(v:val)'))
+    call assert_false(filereadable('.Xswapfsync.swp'))
+  endif
+  call delete('Xswapfsync')
+endfunc
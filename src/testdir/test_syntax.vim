@@ -119,6 +119,40 @@ func Test_syntime()
   bd
 endfunc
 
+func Test_syntime_list()
+  if !has('profile')
+    return
+  endif
+
+  new
+  call setline(1, ['short foo', repeat('x', 100) . 'foo', 'bar'])
+  syn match Foo /foo/
+  syn match Bar /bar/
+  call assert_equal([], syntime_list())
+  syntime on
+  redraw!
+  syntime off
+  let l = syntime_list()
+  call assert_equal(2, len(l))
+  let foo = filter(copy(l), 'v:val.name == "Foo"')[0]
+  call assert_equal('foo', foo.pattern)
+  call assert_equal(2, foo.match)
+  call assert_equal(2, foo.count)
+  call assert_inrange(1, foo.total, foo.max)
+  call assert_inrange(0, foo.p99, foo.p50)
+  call assert_inrange(0, foo.max, foo.p99)
+  call assert_equal(9, len(foo.linelen))
+  call assert_equal([0, 32, 64, 128], map(foo.linelen[:3], 'v:val.minlen'))
+  call assert_equal(foo.count, foo.linelen[0].count + foo.linelen[2].count)
+  call assert_equal(1, foo.linelen[2].count)
+  call assert_equal(foo.total, foo.linelen[0].total + foo.linelen[2].total)
+  call assert_equal(l, json_decode(json_encode(l)))
+
+  syntime clear
+  call assert_equal([], syntime_list())
+  bwipe!
+endfunc
+
 func Test_syntime_completion()
   if !has('profile')
     return
@@ -583,3 +617,182 @@ func Test_syn_wrong_z_one()
   call test_override("ALL", 0)
   bwipe!
 endfunc
+
+" The compiled pattern is kept, the DFA must notice 'iskeyword' changes.
+func Test_syn_match_iskeyword_change()
+  new
+  call setline(1, ['a-foo', 'a-foo'])
+  syn match Foo /\%#=2\<foo\>/
+  call assert_equal('Foo', synIDattr(synID(1, 3, 1), 'name'))
+  setlocal iskeyword+=-
+  call setline(2, 'a-foo')
+  call assert_equal('', synIDattr(synID(2, 3, 1), 'name'))
+  setlocal iskeyword-=-
+  call setline(2, 'b-foo')
+  call assert_equal('Foo', synIDattr(synID(2, 3, 1), 'name'))
+  syn clear
+  bwipe!
+endfunc
+
+" Patterns whose literal is not in the line are skipped, this must not change
+" what matches.
+func Test_syn_match_literal_prefilter()
+  new
+  call setline(1, ['xx Foo yy bar', 'FOO Bar', 'abc #x', 'qq foo', 'foo'])
+  let Name = {lnum, col -> synIDattr(synID(lnum, col, 1), 'name')}
+  for engine in [1, 2]
+    exe 'syn match Foo /\%#=' . engine . 'foo/'
+    exe 'syn match Bar /\%#=' . engine . '\cbar/'
+    exe 'syn match Sharp /\%#=' . engine . '#/'
+    exe 'syn match Zzz /\%#=' . engine . 'zzz/'
+    exe 'syn region Quote start=/\%#=' . engine . 'qq/ end=/$/'
+    call assert_equal('', Name(1, 4))
+    call assert_equal('Bar', Name(1, 11))
+    call assert_equal('Bar', Name(2, 5))
+    call assert_equal('Sharp', Name(3, 5))
+    call assert_equal('Quote', Name(4, 5))
+
+    syn case ignore
+    exe 'syn match Foo2 /\%#=' . engine . 'foo/'
+    call assert_equal('Foo2', Name(1, 4))
+    call assert_equal('Foo2', Name(2, 1))
+
+    " After removing a pattern the others still work.
+    syn clear Foo2
+    call assert_equal('', Name(1, 4))
+    call assert_equal('Bar', Name(1, 11))
+    call assert_equal('Foo', Name(5, 1))
+    syn case match
+    syn clear
+  endfor
+  bwipe!
+endfunc
+
+" Test for 'synidlemem': syntax is parsed below the window while waiting for a
+" character, jumping to the end later only parses from a nearby state.
+func Test_syn_idle_parse()
+  if !has('profile')
+    return
+  endif
+  new
+  call setline(1, repeat(['"', 'x'], 3000))
+  syn region Str start=/"/ end=/"/
+  syn sync fromstart
+  redraw
+  let Count = {-> split(split(execute('syntime report'), "\n")[-1])[1] + 0}
+  let Name = {-> synIDattr(synID(line('$'), 1, 0), 'name')}
+
+  call assert_fails('set synidlemem=-1', 'E487:')
+  set synidlemem=1000
+  " Parse like it is done while waiting for a character.
+  call test_syn_idle_parse()
+  syntime on
+  call assert_equal('', Name())
+  call assert_inrange(0, 300, Count())
+  syntime off
+  syntime clear
+
+  " After a change parsing continues from there.
+  1delete
+  redraw
+  call test_syn_idle_parse()
+  syntime on
+  call assert_equal('Str', Name())
+  call assert_inrange(0, 300, Count())
+  syntime off
+  syntime clear
+
+  " Without 'synidlemem' everything is parsed when jumping to the end.
+  call setline(1, '"')
+  set synidlemem=0
+  redraw
+  call test_syn_idle_parse()
+  syntime on
+  call assert_equal('Str', synIDattr(synID(line('$') - 1, 1, 0), 'name'))
+  call assert_inrange(3000, 20000, Count())
+  syntime off
+  syntime clear
+
+  set synidlemem&
+  bwipe!
+endfunc
+
+" Test for 'syncache': the syntax items are copied to another buffer when
+" nothing they depend on changed.
+func Test_syn_cache()
+  call mkdir('Xsyncache')
+  let lines = [
+	\ "call writefile(['loaded'], 'Xsyncache/log', 'a')",
+	\ 'syn keyword XcKey foo bar',
+	\ 'syn match XcNum /\d\+/ contained',
+	\ 'syn region XcStr start=/"/ end=/"/ contains=XcNum',
+	\ "let b:current_syntax = 'xcache'",
+	\ ]
+  call writefile(lines, 'Xsyncache/xcache.vim')
+  augroup SynCache
+    au Syntax xcache source Xsyncache/xcache.vim
+    au Syntax c runtime! syntax/c.vim
+  augroup END
+  let Loaded = {-> len(readfile('Xsyncache/log'))}
+  set syncache
+
+  new
+  set syntax=xcache
+  call assert_equal(1, Loaded())
+  let items = execute('syntax list')
+  bwipe!
+
+  new
+  call setline(1, 'foo "12" bar')
+  set syntax=xcache
+  call assert_equal(1, Loaded())
+  call assert_equal(items, execute('syntax list'))
+  call assert_equal('xcache', b:current_syntax)
+  call assert_equal('XcKey', synIDattr(synID(1, 1, 0), 'name'))
+  call assert_equal('XcNum', synIDattr(synID(1, 6, 0), 'name'))
+  call assert_equal('XcKey', synIDattr(synID(1, 10, 0), 'name'))
+  bwipe!
+
+  " A changed variable may matter to the syntax file.
+  let g:xcache_var = 1
+  new
+  set syntax=xcache
+  call assert_equal(2, Loaded())
+  bwipe!
+  new
+  set syntax=xcache
+  call assert_equal(2, Loaded())
+  bwipe!
+
+  " A changed syntax file is sourced again.
+  call writefile(lines + ['syn keyword XcKey baz'], 'Xsyncache/xcache.vim')
+  new
+  set syntax=xcache
+  call assert_equal(3, Loaded())
+  bwipe!
+
+  " Resetting the option forgets the items.
+  set nosyncache
+  set syncache
+  new
+  set syntax=xcache
+  call assert_equal(4, Loaded())
+  bwipe!
+
+  " A real syntax file gives the same items, keywords may be listed in
+  " another order.
+  new
+  set syntax=c
+  let items = sort(split(execute('syntax list')))
+  bwipe!
+  new
+  set syntax=c
+  call assert_equal(items, sort(split(execute('syntax list'))))
+  call assert_equal('c', b:current_syntax)
+  bwipe!
+
+  set syncache&
+  au! SynCache
+  augroup! SynCache
+  call delete('Xsyncache', 'rf')
+endfunc
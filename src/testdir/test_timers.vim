@@ -310,4 +310,28 @@ func Test_restore_count()
   call delete('Xtrctext')
 endfunc
 
+" With 'redrawrate' set a redraw after a timer callback is postponed when the
+" previous one was less than a frame ago.
+func Test_redrawrate()
+  if !CanRunVimInTerminal()
+    return
+  endif
+  call writefile([
+	\ 'set redrawrate=1',
+	\ 'func Update(text, timer)',
+	\ '  call setline(1, a:text)',
+	\ 'endfunc',
+	\ ], 'Xredrawrate')
+  let buf = RunVimInTerminal('-S Xredrawrate', {'rows': 6})
+
+  call term_sendkeys(buf, ":call timer_start(10, function('Update', ['first'])) | call timer_start(100, function('Update', ['second']))\<CR>")
+  call WaitForAssert({-> assert_equal('first', term_getline(buf, 1))})
+  " The second change is not displayed until a second after the first one.
+  call term_wait(buf, 200)
+  call assert_equal('first', term_getline(buf, 1))
+  call WaitForAssert({-> assert_equal('second', term_getline(buf, 1))}, 3000)
+
+  call StopVimInTerminal(buf)
+  call delete('Xredrawrate')
+endfunc
 " vim: shiftwidth=2 sts=2 expandtab
@@ -1,5 +1,7 @@
 " Tests for the writefile() function.
 
+source shared.vim
+
 func Test_writefile()
   let f = tempname()
   call writefile(["over","written"], f, "b")
@@ -150,3 +152,102 @@ func Test_writefile_autowrite_nowrite()
   bwipe!
   set noautowrite
 endfunc
+
+" Writing a buffer uses the text in the memline blocks directly when no
+" conversion is done, check NULs, CRs and the fileformats.
+func Test_write_buffer_text()
+  new
+  call setline(1, map(range(1, 20000), '"line " . v:val'))
+  call setline(2, ["a\nb\n", "c\rd", '', "\n"])
+  " change a line without flushing it to the block
+  call setline(10000, 'changed')
+
+  let expected = getline(1, '$')
+  let expected[1] = "a\nb\n"
+  let expected[3] = ''
+  let expected[4] = "\n"
+
+  set fileformat=unix
+  write! Xwrite
+  call assert_equal(expected, readfile('Xwrite', 'b')[:-2])
+  call assert_equal(getfsize('Xwrite'), line2byte('$') + len(getline('$')))
+
+  set fileformat=dos
+  write! Xwrite
+  let lines = readfile('Xwrite', 'b')
+  call assert_equal(20001, len(lines))
+  call assert_equal("line 1\r", lines[0])
+  call assert_equal("c\rd\r", lines[2])
+  call assert_equal("changed\r", lines[9999])
+
+  set fileformat=mac
+  write! Xwrite
+  call assert_equal("line 1\ra\nb\n\rc", readfile('Xwrite', 'b')[0])
+  call assert_equal(getfsize('Xwrite'), line2byte('$') + len(getline('$')))
+
+  " no end-of-line for the last line
+  set fileformat=unix noeol nofixeol
+  write! Xwrite
+  call assert_equal(getfsize('Xwrite'), line2byte('$') + len(getline('$')) - 1)
+  call assert_equal('line 20000', readfile('Xwrite', 'b')[-1])
+
+  " write a range of lines
+  2,3write! Xwrite
+  call assert_equal(["a\nb\n", "c\rd", ''], readfile('Xwrite', 'b'))
+
+  call delete('Xwrite')
+  set fileformat& eol& fixeol&
+  bwipe!
+endfunc
+
+func Test_write_async()
+  if !has('unix') || !(has('channel') || has('clientserver'))
+    return
+  endif
+  new
+  call setline(1, ['one', 'two', 'three'])
+  let g:synced = []
+  au BufWriteSynced * call add(g:synced, [expand('<afile>'), expand('<abuf>')])
+  au BufWritePre * let g:cmdarg = v:cmdarg
+  set writebackup nobackup
+
+  write ++async Xasync
+  call assert_equal(' ++async', g:cmdarg)
+  " the text is written right away
+  call assert_equal(['one', 'two', 'three'], readfile('Xasync'))
+  call WaitForAssert({-> assert_equal([['Xasync', string(bufnr('%'))]],
+	\ g:synced)})
+
+  " writing again waits for the previous write, the backup is deleted
+  let g:synced = []
+  edit Xasync
+  call setline(1, 'changed')
+  write ++async
+  call assert_false(&modified)
+  write ++async
+  call WaitForAssert({-> assert_equal(2, len(g:synced))})
+  call assert_equal(['changed', 'two', 'three'], readfile('Xasync'))
+  call assert_false(filereadable('Xasync~'))
+
+  " without ++async the event is not triggered
+  let g:synced = []
+  write
+  sleep 50m
+  call assert_equal([], g:synced)
+
+  " only for commands that write the buffer
+  call assert_fails('edit ++async Xasync', 'E474:')
+  call assert_fails('read ++async Xasync', 'E474:')
+  call assert_fails('wq ++async', 'E474:')
+  let g:synced = []
+  call setline(1, 'updated')
+  update ++async
+  call WaitForAssert({-> assert_equal(1, len(g:synced))})
+
+  au! BufWriteSynced
+  au! BufWritePre
+  unlet g:synced g:cmdarg
+  set writebackup&
+  bwipe!
+  call delete('Xasync')
+endfunc
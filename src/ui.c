@@ -352,6 +352,12 @@ inchar_loop(
 		// flush all the swap files to disk.  Also done when
 		// interrupted by SIGWINCH.
 		before_blocking();
+#ifdef FEAT_SYN_HL
+		// Parse syntax ahead in chunks until a character is available.
+		while (syn_idle_parse() && !wait_func(0L, &interrupted, FALSE)
+					    && !typebuf_changed(tb_change_cnt))
+		    ;
+#endif
 		continue;
 	    }
 	}
@@ -370,6 +376,11 @@ inchar_loop(
 		wait_time = 10L;
 	}
 #endif
+#ifdef USE_ASYNC_WRITE
+	// Finishing ":write ++async" also requires polling.
+	if ((wait_time < 0 || wait_time > 100L) && async_write_pending())
+	    wait_time = 100L;
+#endif
 #ifdef FEAT_BEVAL_GUI
 	if (p_beval && wait_time > 100L)
 	    // The 'balloonexpr' may indirectly invoke a callback while waiting
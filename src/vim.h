@@ -774,6 +774,7 @@ extern int (*dyn_libintl_putenv)(const char *envstring);
 #define EXPAND_MESSAGES		46
 #define EXPAND_MAPCLEAR		47
 #define EXPAND_ARGLIST		48
+#define EXPAND_RENDERTIME	49
 
 /* Values for exmode_active (0 is no exmode) */
 #define EXMODE_NORMAL		1
@@ -855,6 +856,7 @@ extern int (*dyn_libintl_putenv)(const char *envstring);
 # define SST_MAX_ENTRIES 1000	/* maximal size for state stack array */
 # define SST_FIX_STATES	 7	/* size of sst_stack[]. */
 # define SST_DIST	 16	/* normal distance between entries */
+# define SST_IDLE_MAX_KB 200000L /* maximal 'synidlemem' used */
 # define SST_INVALID	(synstate_T *)-1	/* invalid syn_state pointer */
 
 # define HL_CONTAINED	0x01	/* not used on toplevel */
@@ -1263,6 +1265,7 @@ enum auto_event
     EVENT_BUFWRITECMD,		// write buffer using command
     EVENT_BUFWRITEPOST,		// after writing a buffer
     EVENT_BUFWRITEPRE,		// before writing a buffer
+    EVENT_BUFWRITESYNCED,	// after ":write ++async" is done
     EVENT_CMDLINECHANGED,	// command line was modified
     EVENT_CMDLINEENTER,		// after entering the command line
     EVENT_CMDLINELEAVE,		// before leaving the command line
@@ -4858,7 +4858,10 @@ win_free_lsize(win_T *wp)
 {
     /* TODO: why would wp be NULL here? */
     if (wp != NULL)
+    {
 	VIM_CLEAR(wp->w_lines);
+	line_cache_free(wp);
+    }
 }
 
 /*